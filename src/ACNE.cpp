@@ -218,6 +218,7 @@ struct ACNE : BidooModule {
 };
 
 void ACNE::process(const ProcessArgs &args) {
+	ProfileScope profile(this, args);
 
 	bool save = saveTrigger.process(params[SAVE_PARAM].getValue());
 	lights[SAVE_LIGHT].setBrightness(lights[SAVE_LIGHT].getBrightness()-0.0001f*lights[SAVE_LIGHT].getBrightness());
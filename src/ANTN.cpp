@@ -291,6 +291,7 @@ void ANTN::onSampleRateChange() {
 }
 
 void ANTN::process(const ProcessArgs &args) {
+	ProfileScope profile(this, args);
 	if (trigTrigger.process(params[TRIG_PARAM].value)) {
     if (read) {
       tDc.store(false);
@@ -1,33 +1,12 @@
 #include "plugin.hpp"
 #include "BidooComponents.hpp"
 #include "dsp/resampler.hpp"
+#include "dep/filters/svf.hpp"
+#include "dep/fastmath.hpp"
 
 using namespace std;
 
-#define pi 3.14159265359
-
-struct MultiFilter {
-	float q;
-	float freq;
-	float smpRate;
-	float hp = 0.0f, bp = 0.0f, lp = 0.0f, mem1 = 0.0f, mem2 = 0.0f;
-
-	void setParams(float freq, float q, float smpRate) {
-		this->freq = freq;
-		this->q = q;
-		this->smpRate = smpRate;
-	}
-
-	void calcOutput(float sample) {
-		float g = tan(pi * freq / smpRate);
-		float R = 1.0f / (2.0f*q);
-		hp = (sample - (2.0f*R + g)*mem1 - mem2) / (1.0f + 2.0f * R * g + g * g);
-		bp = g * hp + mem1;
-		lp = g * bp + mem2;
-		mem1 = g * hp + bp;
-		mem2 = g * bp + lp;
-	}
-};
+using simd::float_4;
 
 struct BAFIS : BidooModule {
 	enum ParamIds {
@@ -57,7 +36,91 @@ struct BAFIS : BidooModule {
 		NUM_LIGHTS
 	};
 
-	MultiFilter filter0, filter1,filter2, filter3, filter4, filter5;
+	enum ShapeBits {
+		SHAPE_TANH = 1,
+		SHAPE_SIN = 2,
+		SHAPE_CLIP = 4
+	};
+
+	// Drive and distortion of four lanes, refreshed at control rate. PRE lanes
+	// distort the band input, POST lanes distort the band output.
+	struct Shaper {
+		float_4 gain = 0.f;
+		float_4 isTanh = 0.f;
+		float_4 isSin = 0.f;
+		float_4 isPost = 0.f;
+		int shapeBits = SHAPE_TANH;
+		int postBits = 0;
+
+		void clear() {
+			shapeBits = 0;
+			postBits = 0;
+		}
+
+		void set(int l, float drive, int shape, bool post) {
+			gain[l] = drive;
+			isTanh[l] = (shape == SHAPE_TANH) ? 1.f : 0.f;
+			isSin[l] = (shape == SHAPE_SIN) ? 1.f : 0.f;
+			isPost[l] = post ? 1.f : 0.f;
+			shapeBits |= shape;
+			postBits |= post ? (1 << l) : 0;
+		}
+
+		// turn the 0/1 lanes into masks
+		void finish() {
+			isTanh = isTanh > 0.f;
+			isSin = isSin > 0.f;
+			isPost = isPost > 0.f;
+		}
+
+		float_4 shape(float_4 x) {
+			x *= gain;
+			switch (shapeBits) {
+				case SHAPE_TANH: return fastmath::tanh(x);
+				case SHAPE_SIN: return simd::sin(x);
+				case SHAPE_CLIP: return simd::clamp(x, -1.f, 1.f);
+				default: {
+					float_4 y = simd::clamp(x, -1.f, 1.f);
+					if (shapeBits & SHAPE_SIN) y = simd::ifelse(isSin, simd::sin(x), y);
+					if (shapeBits & SHAPE_TANH) y = simd::ifelse(isTanh, fastmath::tanh(x), y);
+					return y;
+				}
+			}
+		}
+
+		float_4 input(float_4 x) {
+			if (postBits == 0xF) return x;
+			float_4 y = shape(x);
+			return postBits ? simd::ifelse(isPost, x, y) : y;
+		}
+
+		float_4 output(float_4 x) {
+			if (postBits == 0) return x;
+			float_4 y = shape(x);
+			return (postBits == 0xF) ? y : simd::ifelse(isPost, y, x);
+		}
+	};
+
+	int oversample = 1;
+	int filterOversample = 0;
+	bool monoParams = true;
+	// six filters per group of four channels, bands are 0, 1-2, 3-4 and 5
+	svf::MultiFilter4 filters[6][4];
+	dsp::Upsampler<2, 8> upsamplers2[16];
+	dsp::Upsampler<4, 8> upsamplers4[16];
+	dsp::Decimator<2, 8, float_4> decimators2[4];
+	dsp::Decimator<4, 8, float_4> decimators4[4];
+	dsp::ClockDivider paramDivider;
+	// per band and group
+	Shaper shapers[4][4];
+	float_4 volume[4][4];
+	// A mono input runs the bands side by side in the lanes: filters 0, 1, 3
+	// and 5 first, then 2 and 4 on the high passes of 1 and 3.
+	svf::MultiFilter4 monoFilters[2];
+	Shaper monoShaper;
+	float_4 monoVolume = 0.f;
+	dsp::Decimator<2, 8> monoDecimator2;
+	dsp::Decimator<4, 8> monoDecimator4;
 
 	///Tooltip
 	struct tpType : ParamQuantity {
@@ -94,155 +157,184 @@ struct BAFIS : BidooModule {
       configParam<tpPrePost>(PREPOST_PARAM+i, 0.f, 1.f, 0.f, "Pre/Post");
       configParam(VOLUME_PARAM+i, 0.f, 1.f, 0.5f, "Volume", "%", 0.f, 100.f);
     }
+
+		paramDivider.setDivision(16);
+		for (int b=0; b<4; b++) {
+			for (int g=0; g<4; g++) {
+				volume[b][g] = 0.f;
+			}
+		}
 	}
 
-	void process(const ProcessArgs &args) override {
-    float in = inputs[IN].getVoltage() * 0.2f; //normalise to -1/+1 we consider VCV Rack standard is #+5/-5V on VCO1
-    float out = 0.f;
-		float c0freq = std::pow(2.0f, rescale(clamp(params[FREQ_PARAM].getValue() + inputs[FREQ_INPUT].getVoltage() * 0.2f, 0.0f, 1.0f), 0.0f, 1.0f, 4.5f, 14.0f));
-		float c1freq = std::pow(2.0f, rescale(clamp(params[FREQ_PARAM+1].getValue() + inputs[FREQ_INPUT+1].getVoltage() * 0.2f, 0.0f, 1.0f), 0.0f, 1.0f, 4.5f, 14.0f));
-		float c2freq = std::pow(2.0f, rescale(clamp(params[FREQ_PARAM+2].getValue() + inputs[FREQ_INPUT+2].getVoltage() * 0.2f, 0.0f, 1.0f), 0.0f, 1.0f, 4.5f, 14.0f));
-
-    float q0 = 10.0f * clamp(params[Q_PARAM].getValue() + inputs[Q_INPUT].getVoltage() / 10.f, 0.1f, 1.0f);
-    float q1 = 10.0f * clamp(params[Q_PARAM+1].getValue() + inputs[Q_INPUT+1].getVoltage() / 10.f, 0.1f, 1.0f);
-    float q2 = 10.0f * clamp(params[Q_PARAM+2].getValue() + inputs[Q_INPUT+2].getVoltage() / 10.f, 0.1f, 1.0f);
-    float q3 = 10.0f * clamp(params[Q_PARAM+3].getValue() + inputs[Q_INPUT+3].getVoltage() / 10.f, 0.1f, 1.0f);
-
-    float g0 = clamp(params[GAIN_PARAM].getValue() + inputs[GAIN_INPUT].getVoltage(), 1.f, 10.0f);
-    float g1 = clamp(params[GAIN_PARAM+1].getValue() + inputs[GAIN_INPUT+1].getVoltage(), 1.f, 10.0f);
-    float g2 = clamp(params[GAIN_PARAM+2].getValue() + inputs[GAIN_INPUT+2].getVoltage(), 1.f, 10.0f);
-    float g3 = clamp(params[GAIN_PARAM+3].getValue() + inputs[GAIN_INPUT+3].getVoltage(), 1.f, 10.0f);
-
-		float v0 = clamp(params[VOLUME_PARAM].getValue() + inputs[VOLUME_INPUT].getVoltage() * 0.1f, 0.f, 1.0f);
-    float v1 = clamp(params[VOLUME_PARAM+1].getValue() + inputs[VOLUME_INPUT+1].getVoltage() * 0.1f, 0.f, 1.0f);
-    float v2 = clamp(params[VOLUME_PARAM+2].getValue() + inputs[VOLUME_INPUT+2].getVoltage() * 0.1f, 0.f, 1.0f);
-    float v3 = clamp(params[VOLUME_PARAM+3].getValue() + inputs[VOLUME_INPUT+3].getVoltage() * 0.1f, 0.f, 1.0f);
-
-    if ((params[PREPOST_PARAM].getValue() == 0.f) || (inputs[PREPOST_INPUT].isConnected() && (inputs[PREPOST_INPUT].getVoltage()<1.f))) {
-      float dIn = 0.f;
-      if ((params[TYPE_PARAM].getValue() == 0.f) || (inputs[TYPE_INPUT].isConnected() && (inputs[TYPE_INPUT].getVoltage() == 0.f))) {
-        dIn = tanh(g0*in);
-      }
-      else if ((params[TYPE_PARAM].getValue() == 1.f) || (inputs[TYPE_INPUT].isConnected() && (inputs[TYPE_INPUT].getVoltage() == 1.f))) {
-        dIn = sin(g0*in);
-      }
-      else {
-        dIn = clamp(g0*in,-1.0f,1.0f);
-      }
-      filter0.setParams(c0freq, q0, args.sampleRate);
-    	filter0.calcOutput(dIn);
-  		out = filter0.lp * v0 * 30517578125e-15f;
-    }
-    else {
-      filter0.setParams(c0freq, q0, args.sampleRate);
-    	filter0.calcOutput(in);
-      if ((params[TYPE_PARAM].getValue() == 0.f) || (inputs[TYPE_INPUT].isConnected() && (inputs[TYPE_INPUT].getVoltage() == 0.f))) {
-        out = tanh(g0*filter0.lp) * v0 * 30517578125e-15f;
-      }
-      else if ((params[TYPE_PARAM].getValue() == 1.f) || (inputs[TYPE_INPUT].isConnected() && (inputs[TYPE_INPUT].getVoltage() == 1.f))) {
-        out = sin(g0*filter0.lp) * v0 * 30517578125e-15f;
-      }
-      else {
-        out = clamp(g0*filter0.lp,-1.f,1.f) * v0 * 30517578125e-15f;
-      }
-    }
+	json_t *dataToJson() override {
+		json_t *rootJ = BidooModule::dataToJson();
+		json_object_set_new(rootJ, "oversample", json_integer(oversample));
+		return rootJ;
+	}
 
-    if ((params[PREPOST_PARAM+1].getValue() == 0.f) || (inputs[PREPOST_INPUT+1].isConnected() && (inputs[PREPOST_INPUT+1].getVoltage()<1.f))) {
-      float dIn = 0.f;
-      if ((params[TYPE_PARAM+1].getValue() == 0.f) || (inputs[TYPE_INPUT+1].isConnected() && (inputs[TYPE_INPUT+1].getVoltage() == 0.f))) {
-        dIn = tanh(g1*in);
-      }
-      else if ((params[TYPE_PARAM+1].getValue() == 1.f) || (inputs[TYPE_INPUT+1].isConnected() && (inputs[TYPE_INPUT+1].getVoltage() == 1.f))) {
-        dIn = sin(g1*in);
-      }
-      else {
-        dIn = clamp(g1*in,-1.0f,1.0f);
-      }
-      filter1.setParams(c0freq, q1, args.sampleRate);
-    	filter1.calcOutput(dIn);
-      filter2.setParams(c1freq, q1, args.sampleRate);
-    	filter2.calcOutput(filter1.hp);
-      out += filter2.lp * v1 * 30517578125e-15f;
-    }
-    else {
-      filter1.setParams(c0freq, q1, args.sampleRate);
-    	filter1.calcOutput(in);
-      filter2.setParams(c1freq, q1, args.sampleRate);
-    	filter2.calcOutput(filter1.hp);
-      if ((params[TYPE_PARAM+1].getValue() == 0.f) || (inputs[TYPE_INPUT+1].isConnected() && (inputs[TYPE_INPUT+1].getVoltage() == 0.f))) {
-        out += tanh(g1*filter2.lp) * v1 * 30517578125e-15f;
-      }
-      else if ((params[TYPE_PARAM+1].getValue() == 1.f) || (inputs[TYPE_INPUT+1].isConnected() && (inputs[TYPE_INPUT+1].getVoltage() == 1.f))) {
-        out += sin(g1*filter2.lp) * v1 * 30517578125e-15f;
-      }
-      else {
-        out += clamp(g1*filter2.lp,-1.f,1.f) * v1 * 30517578125e-15f;
-      }
-    }
+	void dataFromJson(json_t *rootJ) override {
+		BidooModule::dataFromJson(rootJ);
+		json_t *oversampleJ = json_object_get(rootJ, "oversample");
+		if (oversampleJ) {
+			int value = json_integer_value(oversampleJ);
+			oversample = ((value == 2) || (value == 4)) ? value : 1;
+		}
+	}
 
-    if ((params[PREPOST_PARAM+2].getValue() == 0.f) || (inputs[PREPOST_INPUT+2].isConnected() && (inputs[PREPOST_INPUT+2].getVoltage()<1.f))) {
-      float dIn = 0.f;
-      if ((params[TYPE_PARAM+2].getValue() == 0.f) || (inputs[TYPE_INPUT+2].isConnected() && (inputs[TYPE_INPUT+2].getVoltage() == 0.f))) {
-        dIn = tanh(g2*in);
-      }
-      else if ((params[TYPE_PARAM+2].getValue() == 1.f) || (inputs[TYPE_INPUT+2].isConnected() && (inputs[TYPE_INPUT+2].getVoltage() == 1.f))) {
-        dIn = sin(g2*in);
-      }
-      else {
-        dIn = clamp(g2*in,-1.0f,1.0f);
-      }
-      filter3.setParams(c1freq, q2, args.sampleRate);
-    	filter3.calcOutput(dIn);
-      filter4.setParams(c2freq, q2, args.sampleRate);
-    	filter4.calcOutput(filter3.hp);
-      out += filter4.lp * v2 * 30517578125e-15f;
-    }
-    else {
-      filter3.setParams(c1freq, q2, args.sampleRate);
-    	filter3.calcOutput(in);
-      filter4.setParams(c2freq, q2, args.sampleRate);
-    	filter4.calcOutput(filter1.hp);
-      if ((params[TYPE_PARAM+2].getValue() == 0.f) || (inputs[TYPE_INPUT+2].isConnected() && (inputs[TYPE_INPUT+2].getVoltage() == 0.f))) {
-        out += tanh(g2*filter4.lp) * v2 * 30517578125e-15f;
-      }
-      else if ((params[TYPE_PARAM+2].getValue() == 1.f) || (inputs[TYPE_INPUT+2].isConnected() && (inputs[TYPE_INPUT+2].getVoltage() == 1.f))) {
-        out += sin(g2*filter4.lp) * v2 * 30517578125e-15f;
-      }
-      else {
-        out += clamp(g2*filter4.lp,-1.f,1.f) * v2 * 30517578125e-15f;
-      }
-    }
+	float cutoff(int i, int c) {
+		return std::pow(2.0f, rescale(clamp(params[FREQ_PARAM+i].getValue() + inputs[FREQ_INPUT+i].getPolyVoltage(c) * 0.2f, 0.0f, 1.0f), 0.0f, 1.0f, 4.5f, 14.0f));
+	}
 
-    if ((params[PREPOST_PARAM+3].getValue() == 0.f) || (inputs[PREPOST_INPUT+3].isConnected() && (inputs[PREPOST_INPUT+3].getVoltage()<1.f))) {
-      float dIn = 0.f;
-      if ((params[TYPE_PARAM+3].getValue() == 0.f) || (inputs[TYPE_INPUT+3].isConnected() && (inputs[TYPE_INPUT+3].getVoltage() == 0.f))) {
-        dIn = tanh(g3*in);
-      }
-      else if ((params[TYPE_PARAM+3].getValue() == 1.f) || (inputs[TYPE_INPUT+3].isConnected() && (inputs[TYPE_INPUT+3].getVoltage() == 1.f))) {
-        dIn = sin(g3*in);
-      }
-      else {
-        dIn = clamp(g3*in,-1.0f,1.0f);
-      }
-      filter5.setParams(c2freq, q3, args.sampleRate);
-    	filter5.calcOutput(dIn);
-      out += filter5.hp * v3 * 30517578125e-15f;
-    }
-    else {
-      filter5.setParams(c2freq, q3, args.sampleRate);
-    	filter5.calcOutput(in);
-      if ((params[TYPE_PARAM+3].getValue() == 0.f) || (inputs[TYPE_INPUT+3].isConnected() && (inputs[TYPE_INPUT+3].getVoltage() == 0.f))) {
-        out += tanh(g3*filter5.hp) * v3 * 30517578125e-15f;
-      }
-      else if ((params[TYPE_PARAM+3].getValue() == 1.f) || (inputs[TYPE_INPUT+3].isConnected() && (inputs[TYPE_INPUT+3].getVoltage() == 1.f))) {
-        out += sin(g3*filter5.hp) * v3 * 30517578125e-15f;
-      }
-      else {
-        out += clamp(g3*filter5.hp,-1.f,1.f) * v3 * 30517578125e-15f;
-      }
-    }
+	float bandQ(int b, int c) {
+		return 10.0f * clamp(params[Q_PARAM+b].getValue() + inputs[Q_INPUT+b].getPolyVoltage(c) / 10.f, 0.1f, 1.0f);
+	}
+
+	float bandVolume(int b, int c) {
+		return clamp(params[VOLUME_PARAM+b].getValue() + inputs[VOLUME_INPUT+b].getPolyVoltage(c) * 0.1f, 0.f, 1.0f);
+	}
+
+	// Sets lane l of the shaper to band b of channel c.
+	void setShaper(Shaper &shaper, int l, int b, int c) {
+		float drive = clamp(params[GAIN_PARAM+b].getValue() + inputs[GAIN_INPUT+b].getPolyVoltage(c), 1.f, 10.0f);
+		float type = inputs[TYPE_INPUT+b].getPolyVoltage(c);
+		bool typeConnected = inputs[TYPE_INPUT+b].isConnected();
+		int shape = SHAPE_CLIP;
+		if ((params[TYPE_PARAM+b].getValue() == 0.f) || (typeConnected && (type == 0.f))) shape = SHAPE_TANH;
+		else if ((params[TYPE_PARAM+b].getValue() == 1.f) || (typeConnected && (type == 1.f))) shape = SHAPE_SIN;
+		bool pre = (params[PREPOST_PARAM+b].getValue() == 0.f) || (inputs[PREPOST_INPUT+b].isConnected() && (inputs[PREPOST_INPUT+b].getPolyVoltage(c)<1.f));
+		shaper.set(l, drive, shape, !pre);
+	}
+
+	// Filter coefficients only move when their lane settings change, see svf::MultiFilter4.
+	void updateParams(float sampleRate, int channels) {
+		float rate = sampleRate * oversample;
+		if (channels == 1) {
+			float c0 = cutoff(0, 0);
+			float c1 = cutoff(1, 0);
+			float c2 = cutoff(2, 0);
+			float q[4];
+			monoShaper.clear();
+			for (int b=0; b<4; b++) {
+				q[b] = bandQ(b, 0);
+				monoVolume[b] = bandVolume(b, 0);
+				setShaper(monoShaper, b, b, 0);
+			}
+			monoShaper.finish();
+			monoFilters[0].setParams(0, c0, q[0], rate);
+			monoFilters[0].setParams(1, c0, q[1], rate);
+			monoFilters[0].setParams(2, c1, q[2], rate);
+			monoFilters[0].setParams(3, c2, q[3], rate);
+			monoFilters[1].setParams(0, c1, q[1], rate);
+			monoFilters[1].setParams(1, c2, q[2], rate);
+		}
+		for (int c=0; (c<channels) && (channels>1); c+=4) {
+			int g = c/4;
+			for (int b=0; b<4; b++) {
+				shapers[b][g].clear();
+			}
+			for (int l=0; l<4; l++) {
+				// lanes past the last channel mirror the first channel of the group
+				int ch = (c+l < channels) ? c+l : c;
+				float c0 = cutoff(0, ch);
+				float c1 = cutoff(1, ch);
+				float c2 = cutoff(2, ch);
+				float q[4];
+				for (int b=0; b<4; b++) {
+					q[b] = bandQ(b, ch);
+					volume[b][g][l] = bandVolume(b, ch);
+					setShaper(shapers[b][g], l, b, ch);
+				}
+				filters[0][g].setParams(l, c0, q[0], rate);
+				filters[1][g].setParams(l, c0, q[1], rate);
+				filters[2][g].setParams(l, c1, q[1], rate);
+				filters[3][g].setParams(l, c1, q[2], rate);
+				filters[4][g].setParams(l, c2, q[2], rate);
+				filters[5][g].setParams(l, c2, q[3], rate);
+			}
+			for (int b=0; b<4; b++) {
+				shapers[b][g].finish();
+			}
+		}
+		filterOversample = oversample;
+		monoParams = (channels == 1);
+	}
 
-    outputs[OUT].setVoltage(out * 32768.0f * 5.0f);
+	float_4 processBands(int g, float_4 in) {
+		filters[0][g].calcOutput(shapers[0][g].input(in));
+		float_4 out = shapers[0][g].output(filters[0][g].lp) * volume[0][g];
+
+		filters[1][g].calcOutput(shapers[1][g].input(in));
+		filters[2][g].calcOutput(filters[1][g].hp);
+		out += shapers[1][g].output(filters[2][g].lp) * volume[1][g];
+
+		filters[3][g].calcOutput(shapers[2][g].input(in));
+		filters[4][g].calcOutput(filters[3][g].hp);
+		out += shapers[2][g].output(filters[4][g].lp) * volume[2][g];
+
+		filters[5][g].calcOutput(shapers[3][g].input(in));
+		out += shapers[3][g].output(filters[5][g].hp) * volume[3][g];
+		return out;
+	}
+
+	float processMono(float in) {
+		svf::MultiFilter4 &first = monoFilters[0];
+		svf::MultiFilter4 &second = monoFilters[1];
+		first.calcOutput(monoShaper.input(float_4(in)));
+		second.calcOutput(float_4(first.hp[1], first.hp[2], 0.f, 0.f));
+		float_4 bands = monoShaper.output(float_4(first.lp[0], second.lp[0], second.lp[1], first.hp[3])) * monoVolume;
+		return bands[0] + bands[1] + bands[2] + bands[3];
+	}
+
+	void process(const ProcessArgs &args) override {
+		ProfileScope profile(this, args);
+		int channels = std::max(inputs[IN].getChannels(), 1);
+		if (paramDivider.process() || (filterOversample != oversample) || (monoParams != (channels == 1))) {
+			updateParams(args.sampleRate, channels);
+		}
+
+		if (channels == 1) {
+			float in = inputs[IN].getVoltage() * 0.2f;
+			float out;
+			if (oversample > 1) {
+				float buffer[4];
+				if (oversample == 2) upsamplers2[0].process(in, buffer);
+				else upsamplers4[0].process(in, buffer);
+				for (int k=0; k<oversample; k++) {
+					buffer[k] = processMono(buffer[k]);
+				}
+				out = (oversample == 2) ? monoDecimator2.process(buffer) : monoDecimator4.process(buffer);
+			}
+			else {
+				out = processMono(in);
+			}
+			outputs[OUT].setVoltage(out * 5.0f);
+			outputs[OUT].setChannels(1);
+			return;
+		}
+
+		for (int c=0; c<channels; c+=4) {
+			int g = c/4;
+			float_4 in = inputs[IN].getVoltageSimd<float_4>(c) * 0.2f; //normalise to -1/+1 we consider VCV Rack standard is #+5/-5V on VCO1
+			float_4 out;
+			if (oversample > 1) {
+				float_4 buffer[4];
+				float up[4];
+				for (int l=0; l<4; l++) {
+					if (oversample == 2) upsamplers2[c+l].process(in[l], up);
+					else upsamplers4[c+l].process(in[l], up);
+					for (int k=0; k<oversample; k++) buffer[k][l] = up[k];
+				}
+				for (int k=0; k<oversample; k++) {
+					buffer[k] = processBands(g, buffer[k]);
+				}
+				out = (oversample == 2) ? decimators2[g].process(buffer) : decimators4[g].process(buffer);
+			}
+			else {
+				out = processBands(g, in);
+			}
+			outputs[OUT].setVoltageSimd(out * 5.0f, c);
+		}
+		outputs[OUT].setChannels(channels);
 	}
 
 };
@@ -281,6 +373,16 @@ struct BAFISWidget : BidooWidget {
 		addInput(createInput<PJ301MPort>(Vec(6.8f, 330), module, BAFIS::IN));
 		addOutput(createOutput<PJ301MPort>(Vec(118.4f, 330), module, BAFIS::OUT));
 	}
+
+	void appendContextMenu(Menu *menu) override {
+		BidooWidget::appendContextMenu(menu);
+		BAFIS *module = dynamic_cast<BAFIS*>(this->module);
+		assert(module);
+		menu->addChild(new MenuSeparator());
+		menu->addChild(createIndexSubmenuItem("Oversampling", {"1x", "2x", "4x"},
+			[=]() {return module->oversample == 4 ? 2 : module->oversample - 1;},
+			[=](int index) {module->oversample = 1 << index;}));
+	}
 };
 
 Model *modelBAFIS = createModel<BAFIS, BAFISWidget>("BAFIS");
@@ -94,6 +94,7 @@ struct BANCAU : BidooModule {
 	}
 
 	void process(const ProcessArgs &args) override {
+		ProfileScope profile(this, args);
 		pitch1 = dsp::FREQ_C4 * dsp::approxExp2_taylor5(inputs[VOCT1_INPUT].getVoltage() + 30) / 1073741824;
 
 		rise1CV = params[RISEEXP1_PARAM].getValue() == 0 ? (params[RISECV1_PARAM].getValue() * rescale(clamp(inputs[RISECV1_INPUT].getVoltage() + inputs[BOTHCV1_INPUT].getVoltage(),-10.0f,10.0f),-10.f,10.f,-1.f, 1.f))	: (params[RISECV1_PARAM].getValue() * out1/10.0f);
@@ -2,6 +2,7 @@
 #include "BidooComponents.hpp"
 #include "dsp/ringbuffer.hpp"
 #include "dsp/digital.hpp"
+#include "dep/fastmath.hpp"
 
 using namespace std;
 
@@ -78,6 +79,7 @@ struct BAR : BidooModule {
 };
 
 void BAR::process(const ProcessArgs &args) {
+	ProfileScope profile(this, args);
 	if (bypassTrigger.process(params[BYPASS_PARAM].getValue())) {
 		bypass = !bypass;
 	}
@@ -114,22 +116,22 @@ void BAR::process(const ProcessArgs &args) {
 	buffR[lookAheadWriteIndex]=inputs[IN_R_INPUT].getVoltage();
 
 	if (inputs[IN_L_INPUT].isConnected())
-		in_L_dBFS = max(20.0f*log10((abs(inputs[IN_L_INPUT].getVoltage())+1e-6f) * 0.2f), -96.3f);
+		in_L_dBFS = max(fastmath::ampToDb((abs(inputs[IN_L_INPUT].getVoltage())+1e-6f) * 0.2f), -96.3f);
 	else
 		in_L_dBFS = -96.3f;
 
 	if (inputs[SC_L_INPUT].isConnected())
-		SC_in_L_dBFS = max(20.0f*log10((abs(inputs[SC_L_INPUT].getVoltage())+1e-6f) * 0.2f), -96.3f);
+		SC_in_L_dBFS = max(fastmath::ampToDb((abs(inputs[SC_L_INPUT].getVoltage())+1e-6f) * 0.2f), -96.3f);
 	else
 		SC_in_L_dBFS = -96.3f;
 
 	if (inputs[IN_R_INPUT].isConnected())
-		in_R_dBFS = max(20.0f*log10((abs(inputs[IN_R_INPUT].getVoltage())+1e-6f) * 0.2f), -96.3f);
+		in_R_dBFS = max(fastmath::ampToDb((abs(inputs[IN_R_INPUT].getVoltage())+1e-6f) * 0.2f), -96.3f);
 	else
 		in_R_dBFS = -96.3f;
 
 	if (inputs[SC_R_INPUT].isConnected())
-		SC_in_R_dBFS = max(20.0f*log10((abs(inputs[SC_R_INPUT].getVoltage())+1e-6f) * 0.2f), -96.3f);
+		SC_in_R_dBFS = max(fastmath::ampToDb((abs(inputs[SC_R_INPUT].getVoltage())+1e-6f) * 0.2f), -96.3f);
 	else
 		SC_in_R_dBFS = -96.3f;
 
@@ -213,8 +215,8 @@ void BAR::process(const ProcessArgs &args) {
 
 	float preGain = gcurve - maxIn;
 	float postGain = 0.0f;
-	float cAtt = exp(-1.0f/(attackTime * args.sampleRate * 0.001f));
-	float cRel = exp(-1.0f/(releaseTime * args.sampleRate * 0.001f));
+	float cAtt = fastmath::exp(-1.0f/(attackTime * args.sampleRate * 0.001f));
+	float cRel = fastmath::exp(-1.0f/(releaseTime * args.sampleRate * 0.001f));
 
 	if (preGain<previousPostGain) {
 		postGain = cAtt * previousPostGain + (1.0f-cAtt) * preGain;
@@ -224,7 +226,7 @@ void BAR::process(const ProcessArgs &args) {
 
 	previousPostGain = postGain;
 	gaindB = makeup + postGain;
-	gain = pow(10.0f, gaindB/20.0f);
+	gain = fastmath::dbToAmp(gaindB);
 
 	mix = params[MIX_PARAM].getValue();
 	lookAhead = params[LOOKAHEAD_PARAM].getValue();
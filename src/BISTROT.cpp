@@ -45,6 +45,7 @@ struct BISTROT : BidooModule {
 
 
 void BISTROT::process(const ProcessArgs &args) {
+    ProfileScope profile(this, args);
     if ((!inputs[ADCCLOCK_INPUT].isConnected()) || (acdClockTrigger.process(inputs[ADCCLOCK_INPUT].getVoltage())))
     {
       in = roundf(clamp(clamp(inputs[INPUT].getVoltage(),-10.0f,10.0f) / 20.0f + 0.5f, 0.0f, 1.0f) * 255);
@@ -40,10 +40,10 @@ struct PatternExtended {
 	int currentStep = 0;
 	int currentPulse = 0;
 	bool forward = true;
-	std::vector<StepExtended> steps {16};
+	StepExtended steps[16];
 
 	void Update(int playMode, int countMode, int numberOfSteps, int numberOfStepsParam, int rootNote, int scale,
-		 float gateTime, float slideTime, float sensitivity, bool skips[8], bool slides[8],
+		 float gateTime, float slideTime, float sensitivity, const bool skips[8], const bool slides[8],
 		  Param *pulses, Param *pitches, Param *types, Param *probGates,
 			Param *rndPitches, Param *accents, Param *rndAccents)
 			{
@@ -124,22 +124,24 @@ struct PatternExtended {
 					currentPulse = 0;
 					return std::make_tuple(steps[currentStep%16].index,currentPulse);
 				} else if (playMode == 3) {
-					std::vector<StepExtended> tmp (steps.size());
-				  auto it = std::copy_if (steps.begin(), steps.end(), tmp.begin(), [](StepExtended i){return !(i.skip);} );
-				  tmp.resize(std::distance(tmp.begin(),it));  // shrink container to new size
-					StepExtended tmpStep = *select_randomly(tmp.begin(), tmp.end());
+					int played[16];
+					int count = 0;
+					for (int i = 0; i < 16; i++) {
+						if (!steps[i].skip) {
+							played[count++] = i;
+						}
+					}
 					currentPulse = 0;
-					currentStep = tmpStep.number;
+					if (count > 0) {
+						currentStep = steps[*select_randomly(played, played + count)].number;
+					}
 					return std::make_tuple(steps[currentStep%16].index,currentPulse);
 				} else if (playMode == 4) {
 					int next = GetNextStepForward(currentStep);
 					int prev = GetNextStepBackward(currentStep);
-					vector<StepExtended> subPattern;
-					subPattern.push_back(steps[prev]);
-					subPattern.push_back(steps[next]);
-					StepExtended choice = *select_randomly(subPattern.begin(), subPattern.end());
+					int neighbours[2] = {prev, next};
 					currentPulse = 0;
-					currentStep = choice.number;
+					currentStep = steps[*select_randomly(neighbours, neighbours + 2)].number;
 					return std::make_tuple(steps[currentStep%16].index,currentPulse);
 				} else {
 					return std::make_tuple(0,0);
@@ -294,6 +296,10 @@ struct BORDL : BidooModule {
 	};
 
 	quantizer::Quantizer quant;
+
+	static const int EDIT_STATE_SIZE = 82;
+	float editState[EDIT_STATE_SIZE];
+
 	bool running = true;
 	dsp::SchmittTrigger clockTrigger;
 	dsp::SchmittTrigger runningTrigger;
@@ -311,8 +317,8 @@ struct BORDL : BidooModule {
 	int curScaleVal = 0;
 	float pitch = 0.0f;
 	float previousPitch = 0.0f;
-	float tCurrent;
-	float tLastTrig;
+	float tCurrent = 0.0f;
+	float tLastTrig = 0.0f;
 	bool slideState[8] = {0};
 	bool skipState[8] = {0};
 	int playMode = 0; // 0 forward, 1 backward, 2 pingpong, 3 random, 4 brownian
@@ -337,6 +343,7 @@ struct BORDL : BidooModule {
 
 	BORDL() {
 		config(NUM_PARAMS, NUM_INPUTS, NUM_OUTPUTS, NUM_LIGHTS);
+		std::fill(editState, editState + EDIT_STATE_SIZE, NAN);
 
 		configParam(CLOCK_PARAM, -2.0f, 6.0f, 2.0f, "Clock");
 		configParam(RUN_PARAM, 0.0f, 1.0f, 0.0f, "Run");
@@ -391,6 +398,38 @@ struct BORDL : BidooModule {
 
 	void UpdatePattern();
 
+	// Everything UpdatePattern reads, compared with what it read last time.
+	bool editStateChanged() {
+		float state[EDIT_STATE_SIZE];
+		int n = 0;
+		state[n++] = selectedPattern;
+		state[n++] = playMode;
+		state[n++] = countMode;
+		state[n++] = numSteps;
+		state[n++] = params[STEPS_PARAM].getValue();
+		state[n++] = params[ROOT_NOTE_PARAM].getValue();
+		state[n++] = params[SCALE_PARAM].getValue();
+		state[n++] = params[GATE_TIME_PARAM].getValue();
+		state[n++] = params[SLIDE_TIME_PARAM].getValue();
+		state[n++] = params[SENSITIVITY_PARAM].getValue();
+		for (int i = 0; i < 8; i++) {
+			state[n++] = skipState[i];
+			state[n++] = slideState[i];
+			state[n++] = params[TRIG_COUNT_PARAM + i].getValue();
+			state[n++] = params[TRIG_PITCH_PARAM + i].getValue();
+			state[n++] = params[TRIG_TYPE_PARAM + i].getValue();
+			state[n++] = params[TRIG_GATEPROB_PARAM + i].getValue();
+			state[n++] = params[TRIG_PITCHRND_PARAM + i].getValue();
+			state[n++] = params[TRIG_ACCENT_PARAM + i].getValue();
+			state[n++] = params[TRIG_RNDACCENT_PARAM + i].getValue();
+		}
+		if (std::equal(state, state + n, editState)) {
+			return false;
+		}
+		std::copy(state, state + n, editState);
+		return true;
+	}
+
 	void process(const ProcessArgs &args) override;
 
 	json_t *dataToJson() override {
@@ -552,6 +591,7 @@ struct BORDL : BidooModule {
 		}
 		updateFlag = true;
 		loadedFromJson = true;
+		std::fill(editState, editState + EDIT_STATE_SIZE, NAN);
 	}
 
 	void onRandomize() override {
@@ -598,6 +638,7 @@ void BORDL::UpdatePattern() {
 }
 
 void BORDL::process(const ProcessArgs &args) {
+	ProfileScope profile(this, args);
 
 	float invESR = 1 / args.sampleRate;
 
@@ -823,7 +864,9 @@ void BORDL::process(const ProcessArgs &args) {
 		countMode = params[COUNT_MODE_PARAM].getValue();
 		// numSteps
 		numSteps = clamp(roundf(params[STEPS_PARAM].getValue() + inputs[STEPS_INPUT].getVoltage()), 1.0f, 16.0f);
-		UpdatePattern();
+		if (editStateChanged()) {
+			UpdatePattern();
+		}
 		if (!loadedFromJson) {
 			loadedFromJson = true;
 			updateFlag = true;
@@ -8,7 +8,12 @@
 #include <sstream>
 #include <algorithm>
 #include <mutex>
+#include <thread>
+#include <atomic>
 #include "dep/waves.hpp"
+#include "dep/onsets.hpp"
+#include "dep/recorder.hpp"
+#include <condition_variable>
 
 using namespace std;
 
@@ -54,11 +59,10 @@ struct CANARD : BidooModule {
 
 	bool play = false;
 	bool record = false;
-	bool save = false;
 	int channels = 2;
 	int sampleRate = 0;
   int totalSampleCount = 0;
-	vector<dsp::Frame<2>> playBuffer, recordBuffer;
+	vector<dsp::Frame<2>> playBuffer;
 	float samplePos = 0.0f, sampleStart = 0.0f, loopLength = 0.0f, fadeLenght = 0.0f, fadeCoeff = 1.0f, speedFactor = 1.0f;
 	size_t prevPlayedSlice = 0;
 	size_t playedSlice = 0;
@@ -84,6 +88,27 @@ struct CANARD : BidooModule {
 	dsp::SchmittTrigger clearTrigger;
 	dsp::PulseGenerator eocPulse;
 	std::mutex mylock;
+	int bufferVersion = 0;
+	std::thread detectThread;
+	std::atomic<bool> detecting {false};
+	std::atomic<bool> detectPending {false};
+	std::atomic<bool> cancelDetect {false};
+	std::atomic<bool> slicesReady {false};
+	std::vector<int> detectedSlices;
+	int detectedVersion = 0;
+	recorder::ChunkedRecorder recorder;
+	std::thread recordThread;
+	std::mutex recordMutex;
+	std::condition_variable recordCondition;
+	std::atomic<bool> stopRecordThread {false};
+	// 0 idle, 1 merged ready, 2 adopted, 3 stale
+	std::atomic<int> mergeState {0};
+	vector<dsp::Frame<2>> merged;
+	bool mergedAppend = false;
+	int mergedVersion = 0;
+	waves::WaveWriter writer;
+	int saveFormat = waves::WAVE_FLOAT32;
+	std::atomic<bool> saveFailed {false};
 	bool newStop = false;
 	bool first=true;
 
@@ -101,7 +126,16 @@ struct CANARD : BidooModule {
 		configSwitch(MODE_PARAM, 0, 1, 0, "Slice mode", {"Off", "On"});
 
 		playBuffer.resize(0);
-		recordBuffer.resize(0);
+		recorder.refill(8);
+		recordThread = std::thread(&CANARD::recordWorker, this);
+	}
+
+	~CANARD() {
+		cancelDetect = true;
+		if (detectThread.joinable()) detectThread.join();
+		stopRecordThread = true;
+		recordCondition.notify_one();
+		recordThread.join();
 	}
 
 	void process(const ProcessArgs &args) override;
@@ -111,6 +145,11 @@ struct CANARD : BidooModule {
 	void loadSample();
 	void saveSample();
 	void calcTransients();
+	void detectWorker();
+	void detectTransients(float threshold);
+	bool snapshotBuffer(vector<dsp::Frame<2>> &dst, int &version);
+	void recordWorker();
+	void adoptRecording();
 
 	json_t *dataToJson() override {
 		json_t *rootJ = BidooModule::dataToJson();
@@ -122,12 +161,15 @@ struct CANARD : BidooModule {
 			json_array_append_new(slicesJ, sliceJ);
 		}
 		json_object_set_new(rootJ, "slices", slicesJ);
+		json_object_set_new(rootJ, "saveFormat", json_integer(saveFormat));
 
 		return rootJ;
 	}
 
 	void dataFromJson(json_t *rootJ) override {
 		BidooModule::dataFromJson(rootJ);
+		json_t *saveFormatJ = json_object_get(rootJ, "saveFormat");
+		if (saveFormatJ) saveFormat = json_integer_value(saveFormatJ);
 		json_t *lastPathJ = json_object_get(rootJ, "lastPath");
 		if (lastPathJ) {
 			lastPath = json_string_value(lastPathJ);
@@ -153,54 +195,185 @@ struct CANARD : BidooModule {
 	}
 };
 
+// A request made while a detection runs is recorded, the worker runs again
+// with the threshold of the moment once it is done.
 void CANARD::calcTransients() {
-	slices.clear();
-	slices.push_back(0);
-	int i = 0;
-	int size = 256;
-	vector<dsp::Frame<2>>::const_iterator first;
-	vector<dsp::Frame<2>>::const_iterator last;
-	float prevNrgy = 0.0f;
-	while (i+size<totalSampleCount) {
-		first = playBuffer.begin() + i;
-		last = playBuffer.begin() + i + size;
-		vector<dsp::Frame<2>> newVec(first, last);
-		float nrgy = 0.0f;
-		float zcRate = 0.0f;
-		unsigned int zcIdx = 0;
-		bool first = true;
-		for (int k = 0; k < size; k++) {
-			nrgy += 100*newVec[k].samples[0]*newVec[k].samples[0]/size;
-			if (newVec[k].samples[0]==0.0f) {
-				zcRate += 1;
-				if (first) {
-					zcIdx = k;
-					first = false;
+	detectPending = true;
+	if (detecting.exchange(true)) return;
+	if (detectThread.joinable()) detectThread.join();
+	cancelDetect = false;
+	detectThread = std::thread(&CANARD::detectWorker, this);
+}
+
+void CANARD::detectWorker() {
+	do {
+		detectPending = false;
+		detectTransients(params[THRESHOLD_PARAM].getValue() * 0.05f);
+		detecting = false;
+	} while (detectPending && !cancelDetect && !detecting.exchange(true));
+}
+
+// Runs on detectThread. The buffer is read in blocks under mylock and mixed
+// to mono, the result is dropped if the buffer was edited meanwhile.
+void CANARD::detectTransients(float threshold) {
+	const int hop = 256;
+	const int block = 16 * hop;
+	const int minGap = 8;
+	onsets::SpectralFlux detector(4 * hop, hop);
+	std::vector<float> mono(block);
+	std::vector<float> flux;
+
+	mylock.lock();
+	int version = bufferVersion;
+	size_t size = playBuffer.size();
+	mylock.unlock();
+	flux.reserve(size / hop + 1);
+
+	for (size_t pos = 0; pos < size; pos += block) {
+		if (cancelDetect) return;
+		mylock.lock();
+		if (bufferVersion != version) {
+			mylock.unlock();
+			return;
+		}
+		for (int i = 0; i < block; i++) {
+			size_t idx = pos + i;
+			mono[i] = idx < size ? 0.5f * (playBuffer[idx].samples[0] + playBuffer[idx].samples[1]) : 0.0f;
+		}
+		mylock.unlock();
+		for (int i = 0; (i < block) && (pos + i < size); i += hop) {
+			flux.push_back(detector.process(&mono[i]));
+		}
+	}
+
+	std::vector<int> peaks = onsets::pickPeaks(flux, threshold, minGap);
+	std::vector<int> result;
+	result.push_back(0);
+
+	mylock.lock();
+	if ((bufferVersion == version) && !cancelDetect) {
+		for (int p : peaks) {
+			// flux frame p ends at (p+1)*hop, the attack lies in its last hop
+			if (p < minGap) continue;
+			int onset = p * hop;
+			for (int k = onset; k > std::max(onset - hop, 0); k--) {
+				float a = playBuffer[k-1].samples[0] + playBuffer[k-1].samples[1];
+				float b = playBuffer[k].samples[0] + playBuffer[k].samples[1];
+				if (a * b <= 0.0f) {
+					onset = k;
+					break;
 				}
 			}
+			if (onset > result.back()) result.push_back(onset);
+		}
+		detectedSlices.swap(result);
+		detectedVersion = version;
+		slicesReady = true;
+	}
+	mylock.unlock();
+}
+
+// Copies the buffer in blocks under mylock like the detector, so process()
+// never waits for a whole copy. False if the buffer was edited meanwhile.
+bool CANARD::snapshotBuffer(vector<dsp::Frame<2>> &dst, int &version) {
+	const size_t block = 4096;
+	mylock.lock();
+	version = bufferVersion;
+	size_t size = playBuffer.size();
+	mylock.unlock();
+	dst.resize(size);
+	for (size_t pos = 0; pos < size; pos += block) {
+		std::lock_guard<std::mutex> lock(mylock);
+		if (bufferVersion != version) return false;
+		std::copy(playBuffer.begin() + pos, playBuffer.begin() + std::min(pos + block, size), dst.begin() + pos);
+	}
+	return true;
+}
+
+// Runs on recordThread. Keeps the recorder supplied with blocks and turns each
+// finished take into a complete play buffer that process() swaps in. An
+// appended take whose snapshot was cut by an edit is retried on the next pass.
+void CANARD::recordWorker() {
+	recorder::Take take;
+	bool pending = false;
+	while (!stopRecordThread) {
+		recorder.refill(8);
+		if (mergeState == 2) {
+			vector<dsp::Frame<2>>().swap(merged);
+			recorder.recycle(take);
+			pending = false;
+			mergeState = 0;
+		}
+		if (mergeState == 3) {
+			merged.clear();
+			mergeState = 0;
+		}
+		if ((mergeState == 0) && (pending || recorder.next(take))) {
+			pending = true;
+			merged.clear();
+			if (!take.append || snapshotBuffer(merged, mergedVersion)) {
+				recorder.copy(take, merged);
+				mergedAppend = take.append;
+				mergeState = 1;
+			}
+		}
+		std::unique_lock<std::mutex> lock(recordMutex);
+		recordCondition.wait_for(lock, std::chrono::milliseconds(10));
+	}
+	recorder.recycle(take);
+}
+
+// An appended take is rebuilt if the buffer was edited since the worker copied it.
+void CANARD::adoptRecording() {
+	if ((mergeState != 1) || !mylock.try_lock()) return;
+	if (mergedAppend && (mergedVersion != bufferVersion)) {
+		mergeState = 3;
+	}
+	else {
+		if (mergedAppend) {
+			slices.push_back(totalSampleCount > 0 ? (totalSampleCount-1) : 0);
+		}
+		else {
+			slices.clear();
+			slices.push_back(0);
 		}
-		if ((nrgy > params[CANARD::THRESHOLD_PARAM].getValue()) && (nrgy > 10*prevNrgy))
-			slices.push_back(i+zcIdx);
-		i+=size;
-		prevNrgy = nrgy;
+		playBuffer.swap(merged);
+		bufferVersion++;
+		totalSampleCount = playBuffer.size();
+		mergeState = 2;
 	}
+	mylock.unlock();
+	recordCondition.notify_one();
 }
 
 void CANARD::loadSample() {
 	APP->engine->yieldWorkers();
 	mylock.lock();
+	bufferVersion++;
 	playBuffer = waves::getStereoWav(lastPath, APP->engine->getSampleRate(), waveFileName, waveExtension, channels, sampleRate, totalSampleCount);
 	mylock.unlock();
 	slices.clear();
 	loading = false;
 }
 
+// The writer copies the buffer a chunk at a time under mylock and gives up
+// if it gets edited before the file is complete.
 void CANARD::saveSample() {
-	APP->engine->yieldWorkers();
 	mylock.lock();
-	waves::saveWave(playBuffer, APP->engine->getSampleRate(), lastPath);
+	int version = bufferVersion;
+	size_t frameCount = playBuffer.size();
 	mylock.unlock();
-	save = false;
+	saveFailed = false;
+	writer.start(frameCount, APP->engine->getSampleRate(), lastPath, (waves::WaveFormat)saveFormat,
+		[this, version](size_t offset, size_t count, dsp::Frame<2> *dst) {
+			std::lock_guard<std::mutex> lock(mylock);
+			if ((bufferVersion != version) || (offset + count > playBuffer.size())) return false;
+			std::copy(playBuffer.begin() + offset, playBuffer.begin() + offset + count, dst);
+			return true;
+		},
+		[this](bool ok) {
+			saveFailed = !ok;
+		});
 }
 
 void CANARD::calcLoop() {
@@ -241,17 +414,23 @@ void CANARD::initPos() {
 }
 
 void CANARD::process(const ProcessArgs &args) {
+	ProfileScope profile(this, args);
 	if (loading) {
 		loadSample();
 	}
 
-	if (save) {
-		saveSample();
+	if (slicesReady && mylock.try_lock()) {
+		if (detectedVersion == bufferVersion) slices.swap(detectedSlices);
+		slicesReady = false;
+		mylock.unlock();
 	}
 
+	adoptRecording();
+
 	if (clearTrigger.process(inputs[CLEAR_INPUT].getVoltage() + params[CLEAR_PARAM].getValue()))
 	{
 		mylock.lock();
+		bufferVersion++;
 		playBuffer.clear();
 		totalSampleCount = 0;
 		slices.clear();
@@ -266,12 +445,14 @@ void CANARD::process(const ProcessArgs &args) {
 		if ((size_t)selected<(slices.size()-1)) {
 			nbSample = slices[selected + 1] - slices[selected] - 1;
 			mylock.lock();
+			bufferVersion++;
 			playBuffer.erase(playBuffer.begin() + slices[selected], playBuffer.begin() + slices[selected + 1]-1);
 			mylock.unlock();
 		}
 		else {
 			nbSample = totalSampleCount - slices[selected];
 			mylock.lock();
+			bufferVersion++;
 			playBuffer.erase(playBuffer.begin() + slices[selected], playBuffer.end());
 			mylock.unlock();
 		}
@@ -316,31 +497,14 @@ void CANARD::process(const ProcessArgs &args) {
 	if (recordTrigger.process(inputs[RECORD_INPUT].getVoltage() + params[RECORD_PARAM].getValue()))
 	{
 		if(record) {
-			if (floor(params[MODE_PARAM].getValue()) == 0) {
-				mylock.lock();
-				slices.clear();
-				slices.push_back(0);
-				playBuffer.resize(0);
-				for (int i = 0; i < (int)recordBuffer.size(); i++) {
-					dsp::Frame<2> frame = recordBuffer[i];
-					playBuffer.push_back(frame);
-				}
-				totalSampleCount = playBuffer.size();
-				mylock.unlock();
+			bool append = floor(params[MODE_PARAM].getValue()) != 0;
+			if (!append) {
 				lastPath = "";
 				waveFileName = "";
 				waveExtension = "";
 			}
-			else {
-				mylock.lock();
-				slices.push_back(totalSampleCount > 0 ? (totalSampleCount-1) : 0);
-				playBuffer.insert(playBuffer.end(), recordBuffer.begin(), recordBuffer.end());
-				totalSampleCount = playBuffer.size();
-				mylock.unlock();
-			}
-			mylock.lock();
-			recordBuffer.resize(0);
-			mylock.unlock();
+			recorder.finish(append);
+			recordCondition.notify_one();
 			lights[REC_LIGHT].setBrightness(0.0f);
 		}
 		record = !record;
@@ -348,12 +512,10 @@ void CANARD::process(const ProcessArgs &args) {
 
 	if (record) {
 		lights[REC_LIGHT].setBrightness(10.0f);
-		mylock.lock();
 		dsp::Frame<2> frame;
 		frame.samples[0] = inputs[INL_INPUT].getVoltage()/10.0f;
 		frame.samples[1] = inputs[INR_INPUT].getVoltage()/10.0f;
-		recordBuffer.push_back(frame);
-		mylock.unlock();
+		recorder.write(frame);
 	}
 
 	int trigMode = inputs[TRIG_INPUT].isConnected() ? 1 : (inputs[GATE_INPUT].isConnected() ? 2 : 0);
@@ -550,14 +712,17 @@ struct CANARDDisplay : OpaqueWidget {
 
 	void drawLayer(const DrawArgs& args, int layer) override {
 		if (layer == 1) {
-			if (module && (module->playBuffer.size()>0)) {
-				module->mylock.lock();
-				std::vector<float> vL;
-				std::vector<float> vR;
-				for (int i=0;i<module->totalSampleCount;i++) {
-					vL.push_back(module->playBuffer[i].samples[0]);
-					vR.push_back(module->playBuffer[i].samples[1]);
+			// skipped for a frame if the buffer is edited while it is copied
+			std::vector<dsp::Frame<2>> frames;
+			int version;
+			if (module && (module->playBuffer.size()>0) && module->snapshotBuffer(frames, version)) {
+				std::vector<float> vL(frames.size());
+				std::vector<float> vR(frames.size());
+				for (size_t i=0;i<frames.size();i++) {
+					vL[i] = frames[i].samples[0];
+					vR[i] = frames[i].samples[1];
 				}
+				module->mylock.lock();
 				std::vector<int> s(module->slices);
 				module->mylock.unlock();
 				size_t nbSample = vL.size();
@@ -795,7 +960,6 @@ struct CANARDWidget : BidooWidget {
 	struct CANARDTransientDetect : MenuItem {
 		CANARD *module;
 		void onAction(const event::Action &e) override {
-			APP->engine->yieldWorkers();
 			module->calcTransients();
 		}
 	};
@@ -828,7 +992,7 @@ struct CANARDWidget : BidooWidget {
 			char *path = osdialog_file(OSDIALOG_SAVE, dir.c_str(), fileName.c_str(), NULL);
 			if (path) {
 				module->lastPath = path;
-				if (!module->save) module->save = true;
+				module->saveSample();
 				free(path);
 			}
 		}
@@ -846,7 +1010,11 @@ struct CANARDWidget : BidooWidget {
 		menu->addChild(construct<CANARDAddSliceMarker>(&MenuItem::text, "Add slice marker", &CANARDAddSliceMarker::module, module));
 		menu->addChild(construct<CANARDTransientDetect>(&MenuItem::text, "Detect transients", &CANARDTransientDetect::module, module));
 		menu->addChild(construct<CANARDLoadSample>(&MenuItem::text, "Load sample", &CANARDLoadSample::module, module));
-		menu->addChild(construct<CANARDSaveSample>(&MenuItem::text, "Save sample", &CANARDSaveSample::module, module));
+		std::string saveState = module->writer.busy ? "Saving..." : (module->saveFailed ? "Failed" : "");
+		menu->addChild(construct<CANARDSaveSample>(&MenuItem::text, "Save sample", &MenuItem::rightText, saveState, &CANARDSaveSample::module, module));
+		menu->addChild(createIndexSubmenuItem("Save format", {"Float 32", "PCM 24"},
+			[=]() {return module->saveFormat;},
+			[=](int index) {module->saveFormat = index;}));
 	}
 };
 
@@ -55,6 +55,7 @@ struct CHUTE : BidooModule {
 
 
 void CHUTE::process(const ProcessArgs &args) {
+	ProfileScope profile(this, args);
 
 	// Running
 	if (playTrigger.process(params[RUN_PARAM].getValue() + inputs[TRIG_INPUT].getVoltage())) {
@@ -61,6 +61,7 @@ struct DFUZE : BidooModule {
 };
 
 void DFUZE::process(const ProcessArgs &args) {
+	ProfileScope profile(this, args);
 	gverb_set_roomsize(verb, clamp(params[SIZE_PARAM].value+rescale(inputs[SIZE_INPUT].value,0.0f,10.0f,0.0f,300.0f),0.0f,300.0f));
 	gverb_set_revtime(verb, clamp(params[REVTIME_PARAM].value+rescale(inputs[REVTIME_INPUT].value,0.0f,10.0f,0.0f,50.0f),0.0f,50.0f));
 	gverb_set_damping(verb, clamp(params[DAMP_PARAM].value+inputs[DAMP_INPUT].value,0.0f,0.9f));
@@ -45,11 +45,16 @@ struct DIKTAT : BidooModule {
 	int lRootNote[16] = {0};
 	int lScale[16] = {0};
 
+	int cachedRootNote[16] = {0};
+	int cachedScale[16] = {0};
+	float cachedNote[16];
+	float chordTones[7][16] = {{0.0f}};
+
 	quantizer::Quantizer quant;
-	quantizer::Chord chord;
 
 	DIKTAT() {
     config(NUM_PARAMS, NUM_INPUTS, NUM_OUTPUTS, NUM_LIGHTS);
+		for (int i=0; i<16; i++) cachedNote[i] = NAN;
 		configParam(CHANNEL_PARAM, 0.0f, 15.0f, 0.0f, "Channel","",0,1,1);
 		configParam(ROOT_NOTE_PARAM, -1.0f, quantizer::numNotes-2, 0.0f, "Root note","",0,1,1);
 		configParam(SCALE_PARAM, 0.0f, quantizer::numScales-1, 1.0f, "Scale","",0,1,1);
@@ -112,6 +117,7 @@ struct DIKTAT : BidooModule {
 };
 
 void DIKTAT::process(const ProcessArgs &args) {
+	ProfileScope profile(this, args);
 	if (currentChannel != params[CHANNEL_PARAM].getValue()) {
 		currentChannel = params[CHANNEL_PARAM].getValue();
 		params[ROOT_NOTE_PARAM].setValue(rootNote[currentChannel]);
@@ -133,34 +139,44 @@ void DIKTAT::process(const ProcessArgs &args) {
 	outputs[NOTE_ELEVENTH_OUTPUT].setChannels(c);
 	outputs[NOTE_THIRTEENTH_OUTPUT].setChannels(c);
 
-	for (int i=0;i<c;i++) {
+	for (int c4=0; c4<c; c4+=4) {
+		bool changed = false;
+		for (int i=c4; i<c4+4; i++) {
+			if (inputs[ROOT_NOTE_INPUT].isConnected()) {
+				lRootNote[i] = rescale(clamp(rootNote[globalMode ? 0 : i] + inputs[ROOT_NOTE_INPUT].getVoltage(globalMode ? 0 : i), 0.0f,10.0f),0.0f,10.0f,0.0f,quantizer::numNotes-1);
+			}
+			else {
+				lRootNote[i] = rootNote[globalMode ? 0 : i];
+			}
 
+			if (inputs[SCALE_INPUT].isConnected()) {
+				lScale[i] = rescale(clamp(scale[globalMode ? 0 : i] + inputs[SCALE_INPUT].getVoltage(globalMode ? 0 : i), 0.0f,10.0f),0.0f,10.0f,0.0f,quantizer::numScales-1);
+			}
+			else {
+				lScale[i] = scale[globalMode ? 0 : i];
+			}
 
-		if (inputs[ROOT_NOTE_INPUT].isConnected()) {
-			lRootNote[i] = rescale(clamp(rootNote[globalMode ? 0 : i] + inputs[ROOT_NOTE_INPUT].getVoltage(globalMode ? 0 : i), 0.0f,10.0f),0.0f,10.0f,0.0f,quantizer::numNotes-1);
-		}
-		else {
-			lRootNote[i] = rootNote[globalMode ? 0 : i];
-		}
+			inputNote[i] = inputs[NOTE_INPUT].getVoltage(i);
 
-		if (inputs[SCALE_INPUT].isConnected()) {
-			lScale[i] = rescale(clamp(scale[globalMode ? 0 : i] + inputs[SCALE_INPUT].getVoltage(globalMode ? 0 : i), 0.0f,10.0f),0.0f,10.0f,0.0f,quantizer::numScales-1);
-		}
-		else {
-			lScale[i] = scale[globalMode ? 0 : i];
+			if ((inputNote[i] != cachedNote[i]) || (lRootNote[i] != cachedRootNote[i]) || (lScale[i] != cachedScale[i])) {
+				cachedNote[i] = inputNote[i];
+				cachedRootNote[i] = lRootNote[i];
+				cachedScale[i] = lScale[i];
+				changed = true;
+			}
 		}
 
-		inputNote[i] = inputs[NOTE_INPUT].getVoltage(i);
-
-		chord = quant.closestChordInScale(inputNote[i], lRootNote[i], lScale[i]);
+		if (changed) {
+			simd::float_4 tones[7];
+			quant.closestChordInScale(simd::float_4::load(inputNote + c4), lRootNote + c4, lScale + c4, tones);
+			for (int k=0; k<7; k++) {
+				tones[k].store(chordTones[k] + c4);
+			}
+		}
 
-		outputs[NOTE_TONIC_OUTPUT].setVoltage(chord.tonic,i);
-		outputs[NOTE_THIRD_OUTPUT].setVoltage(chord.third,i);
-		outputs[NOTE_FIFTH_OUTPUT].setVoltage(chord.fifth,i);
-		outputs[NOTE_SEVENTH_OUTPUT].setVoltage(chord.seventh,i);
-		outputs[NOTE_NINTH_OUTPUT].setVoltage(chord.ninth,i);
-		outputs[NOTE_ELEVENTH_OUTPUT].setVoltage(chord.eleventh,i);
-		outputs[NOTE_THIRTEENTH_OUTPUT].setVoltage(chord.thirteenth,i);
+		for (int k=0; k<7; k++) {
+			outputs[NOTE_TONIC_OUTPUT + k].setVoltageSimd(simd::float_4::load(chordTones[k] + c4), c4);
+		}
 	}
 }
 
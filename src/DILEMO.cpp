@@ -51,6 +51,7 @@ struct DILEMO : BidooModule {
 
 
 void DILEMO::process(const ProcessArgs &args) {
+  ProfileScope profile(this, args);
   in1AND = inputs[IN1_AND].getVoltage()>params[THRESHOLD_PARAM].getValue() ? true : false;
 	in2AND = inputs[IN2_AND].getVoltage()>params[THRESHOLD_PARAM].getValue() ? true : false;
 	in1OR = inputs[IN1_OR].getVoltage()>params[THRESHOLD_PARAM].getValue() ? true : false;
@@ -36,9 +36,9 @@ struct Pattern {
 	int currentStep = 0;
 	int currentPulse = 0;
 	bool forward = true;
-	std::vector<Step> steps {16};
+	Step steps[16];
 
-	void Update(int playMode, int countMode, int numberOfSteps, int numberOfStepsParam, int rootNote, int scale, float gateTime, float slideTime, float sensitivity, vector<char> skips, vector<char> slides, Param *pulses, Param *pitches, Param *types) {
+	void Update(int playMode, int countMode, int numberOfSteps, int numberOfStepsParam, int rootNote, int scale, float gateTime, float slideTime, float sensitivity, const char skips[8], const char slides[8], Param *pulses, Param *pitches, Param *types) {
 		this->playMode = playMode;
 		this->countMode = countMode;
 		this->numberOfSteps = numberOfSteps;
@@ -112,22 +112,24 @@ struct Pattern {
 					currentPulse = 0;
 					return std::make_tuple(steps[currentStep%16].index,currentPulse);
 				} else if (playMode == 3) {
-					std::vector<Step> tmp (steps.size());
-				  auto it = std::copy_if (steps.begin(), steps.end(), tmp.begin(), [](Step i){return !(i.skip);} );
-				  tmp.resize(std::distance(tmp.begin(),it));  // shrink container to new size
-					Step tmpStep = *select_randomly(tmp.begin(), tmp.end());
+					int played[16];
+					int count = 0;
+					for (int i = 0; i < 16; i++) {
+						if (!steps[i].skip) {
+							played[count++] = i;
+						}
+					}
 					currentPulse = 0;
-					currentStep = tmpStep.number;
+					if (count > 0) {
+						currentStep = steps[*select_randomly(played, played + count)].number;
+					}
 					return std::make_tuple(steps[currentStep%16].index,currentPulse);
 				} else if (playMode == 4) {
 					int next = GetNextStepForward(currentStep);
 					int prev = GetNextStepBackward(currentStep);
-					vector<Step> subPattern;
-					subPattern.push_back(steps[prev]);
-					subPattern.push_back(steps[next]);
-					Step choice = *select_randomly(subPattern.begin(), subPattern.end());
+					int neighbours[2] = {prev, next};
 					currentPulse = 0;
-					currentStep = choice.number;
+					currentStep = steps[*select_randomly(neighbours, neighbours + 2)].number;
 					return std::make_tuple(steps[currentStep%16].index,currentPulse);
 				} else {
 					return std::make_tuple(0,0);
@@ -277,8 +279,8 @@ struct DTROY : BidooModule {
 	float previousPitch = 0.0f;
 	float tCurrent = 0.0f;
 	float tLastTrig = 0.0f;
-	std::vector<char> slideState = {'f','f','f','f','f','f','f','f'};
-	std::vector<char> skipState = {'f','f','f','f','f','f','f','f'};
+	char slideState[8] = {'f','f','f','f','f','f','f','f'};
+	char skipState[8] = {'f','f','f','f','f','f','f','f'};
 	int playMode = 0; // 0 forward, 1 backward, 2 pingpong, 3 random, 4 brownian
 	int countMode = 0; // 0 steps, 1 pulses
 	int numSteps = 8;
@@ -298,8 +300,12 @@ struct DTROY : BidooModule {
 
 	quantizer::Quantizer quant;
 
+	static const int EDIT_STATE_SIZE = 50;
+	float editState[EDIT_STATE_SIZE];
+
 	DTROY() {
     config(NUM_PARAMS, NUM_INPUTS, NUM_OUTPUTS, NUM_LIGHTS);
+		std::fill(editState, editState + EDIT_STATE_SIZE, NAN);
 		configParam(CLOCK_PARAM, -2.0f, 6.0f, 2.0f, "Clock");
 		configParam(RUN_PARAM, 0.0f, 1.0f, 0.0f, "Run");
 		configParam(RESET_PARAM, 0.0f, 1.0f, 0.0f, "Reset");
@@ -348,6 +354,34 @@ struct DTROY : BidooModule {
 
 	void UpdatePattern();
 
+	// Everything UpdatePattern reads, compared with what it read last time.
+	bool editStateChanged() {
+		float state[EDIT_STATE_SIZE];
+		int n = 0;
+		state[n++] = selectedPattern;
+		state[n++] = playMode;
+		state[n++] = countMode;
+		state[n++] = numSteps;
+		state[n++] = params[STEPS_PARAM].getValue();
+		state[n++] = params[ROOT_NOTE_PARAM].getValue();
+		state[n++] = params[SCALE_PARAM].getValue();
+		state[n++] = params[GATE_TIME_PARAM].getValue();
+		state[n++] = params[SLIDE_TIME_PARAM].getValue();
+		state[n++] = params[SENSITIVITY_PARAM].getValue();
+		for (int i = 0; i < 8; i++) {
+			state[n++] = skipState[i];
+			state[n++] = slideState[i];
+			state[n++] = params[TRIG_COUNT_PARAM + i].getValue();
+			state[n++] = params[TRIG_PITCH_PARAM + i].getValue();
+			state[n++] = params[TRIG_TYPE_PARAM + i].getValue();
+		}
+		if (std::equal(state, state + n, editState)) {
+			return false;
+		}
+		std::copy(state, state + n, editState);
+		return true;
+	}
+
 	void process(const ProcessArgs &args) override;
 
 	// persistence, random & init
@@ -495,6 +529,7 @@ struct DTROY : BidooModule {
 		}
 		updateFlag = true;
 		loadedFromJson = true;
+		std::fill(editState, editState + EDIT_STATE_SIZE, NAN);
 	}
 
 	void onRandomize() override {
@@ -539,6 +574,7 @@ void DTROY::UpdatePattern() {
 }
 
 void DTROY::process(const ProcessArgs &args) {
+	ProfileScope profile(this, args);
 	// Run
 	if (runningTrigger.process(params[RUN_PARAM].getValue())) {
 		running = !running;
@@ -722,7 +758,9 @@ void DTROY::process(const ProcessArgs &args) {
 		// numSteps
 		numSteps = clamp((int)(params[STEPS_PARAM].getValue() + inputs[STEPS_INPUT].getVoltage()), 1, 16);
 
-		UpdatePattern();
+		if (editStateChanged()) {
+			UpdatePattern();
+		}
 		if (!loadedFromJson) {
 			loadedFromJson = true;
 			updateFlag = true;
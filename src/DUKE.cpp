@@ -47,6 +47,7 @@ struct DUKE : BidooModule {
 
 
 void DUKE::process(const ProcessArgs &args) {
+	ProfileScope profile(this, args);
 	if (aDonfTrigger.process(params[ADONF_PARAM].value)) {
 		for (int i = 0; i < 4; i ++) {
 				params[SLIDER_PARAM + i].setValue(10.f);
@@ -96,7 +96,7 @@ struct EDSAROS : BidooModule {
 	std::string lastPath;
 	std::string waveFileName;
 	std::string waveExtension;
-	vector<dsp::Frame<1>> loadingBuffer;
+	waves::MonoSample loadingBuffer;
 	int channels=0;
   int sampleRate=0;
   int totalSampleCount=0;
@@ -295,7 +295,7 @@ struct EDSAROS : BidooModule {
 void EDSAROS::loadSample() {
 	APP->engine->yieldWorkers();
 	mylock.lock();
-	loadingBuffer = waves::getMonoWav(lastPath, APP->engine->getSampleRate(), waveFileName, waveExtension, channels, sampleRate, totalSampleCount);
+	loadingBuffer = waves::acquireMonoWav(lastPath, APP->engine->getSampleRate(), waveFileName, waveExtension, channels, sampleRate, totalSampleCount);
 	if (loadingBuffer.size()>0) {
 		sample = new float[2*totalSampleCount];
 		rev_sample = new float[2*totalSampleCount];
@@ -345,6 +345,7 @@ void EDSAROS::loadSample() {
 }
 
 void EDSAROS::process(const ProcessArgs &args) {
+	ProfileScope profile(this, args);
 	if (loading) {
 		loadSample();
 	}
@@ -164,6 +164,7 @@ void EMILE::loadSample(std::string path) {
 }
 
 void EMILE::process(const ProcessArgs &args) {
+  ProfileScope profile(this, args);
   if (rTrigger.process(params[R_PARAM].getValue()+inputs[R_INPUT].getVoltage())) {
     r=!r;
   }
@@ -154,6 +154,7 @@ struct ENCOREExpander : BidooModule {
 	}
 
 	void process(const ProcessArgs &args) override {
+		ProfileScope profile(this, args);
 		if (leftExpander.module && (leftExpander.module->model == modelENCORE)) {
 			float *messagesFromZou = (float*)leftExpander.consumerMessage;
 			if (messagesFromZou[0] != currentPattern) {
@@ -100,6 +100,7 @@ struct FLAME : BidooModule {
 };
 
 void FLAME::process(const ProcessArgs &args) {
+	ProfileScope profile(this, args);
 	if (minTrigger.process(params[MIN_PARAM].getValue())) {
 		N = 512;
 		N2 = N/2;
@@ -2,6 +2,7 @@
 #include "BidooComponents.hpp"
 
 using namespace std;
+using simd::float_4;
 
 //Approximates cos(pi*x) for x in [-1,1].
 inline float fast_cos(const float x)
@@ -73,6 +74,50 @@ float porteuse(const float h,const float p)
   return Porteuse0+hf*(Porteuse1-Porteuse0);
 }
 
+// float_4 versions of the above, one voice per lane.
+// Table reads are gathered lane by lane.
+inline float_4 fast_cos(const float_4 x)
+{
+  float_4 x2=x*x;
+  return 1.0f+x2*(-4.0f+2.0f*x2);
+}
+
+inline float_4 formant(float_4 p,float_4 i)
+{
+  i=simd::clamp(i,0.0f,float(I_MAX-2));
+  float_4 P=(L_TABLE-1)*(p+1.0f)*0.5f;
+  float_4 P0=simd::floor(P);
+  float_4 fP=P-P0;
+  float_4 I0=simd::floor(i);
+  float_4 fI=i-I0;
+  float_4 t00,t01,t10,t11;
+  for(int l=0;l<4;l++)
+  {
+    int i00=int(P0[l])+L_TABLE*int(I0[l]);
+    t00[l]=TF[i00];
+    t01[l]=TF[i00+1];
+    t10[l]=TF[i00+L_TABLE];
+    t11[l]=TF[i00+L_TABLE+1];
+  }
+  return (1.0f-fI)*(t00+fP*(t01-t00))+fI*(t10+fP*(t11-t10));
+}
+
+// fmodf(x+1+1000,2.0f)-1.0f for the positive arguments used by porteuse.
+inline float_4 wrap_phase(float_4 x)
+{
+  x+=1001.0f;
+  return x-2.0f*simd::floor(x*0.5f)-1.0f;
+}
+
+inline float_4 porteuse(const float_4 h,const float_4 p)
+{
+  float_4 h0=simd::floor(h);
+  float_4 hf=h-h0;
+  float_4 Porteuse0=fast_cos(wrap_phase(p*h0));
+  float_4 Porteuse1=fast_cos(wrap_phase(p*(h0+1.0f)));
+  return Porteuse0+hf*(Porteuse1-Porteuse0);
+}
+
 struct FORK : BidooModule {
 	enum ParamIds {
 		FORMANT_TYPE_PARAM,
@@ -105,10 +150,21 @@ struct FORK : BidooModule {
 	float A3[9]={ 0.3f,0.15f, 0.2f, 0.4f, 0.1f, 0.3f, 0.7f, 0.2f, 0.2f};
 	float F4[9]={ 3400.0f, 4700.0f, 3000.0f, 3300.0f, 3400.0f, 3700.0f, 3200.0f, 3000.0f, 3000.0f};
 	float A4[9]={ 0.2f, 0.1f, 0.2f, 0.3f, 0.1f, 0.1f, 0.3f, 0.2f, 0.3f};
+	const float FMIN[4]={ 190.0f, 800.0f, 1500.0f, 3000.0f};
+	const float FMAX[4]={ 730.0f, 2100.0f, 3100.0f, 4700.0f};
+	const float AMAX[4]={ 1.0f, 2.0f, 0.7f, 0.3f};
+	const float WIDTH[4]={ 100.0f, 120.0f, 150.0f, 300.0f};
+	const float GAIN[4]={ 1.0f, 0.7f, 1.0f, 1.0f};
 	int preset=0;
-	float f0,dp0,p0=0.0f;
-	float f1,f2,f3,f4,a1,a2,a3,a4;
+	float_4 p0[4]={};
+	// smoothed formant frequencies and amplitudes, per voice
+	float_4 f[4][4];
+	float_4 a[4][4];
+	// their targets, read from the knobs and inputs every 16 samples
+	float_4 ft[4][4];
+	float_4 at[4][4];
   dsp::SchmittTrigger presets;
+  dsp::ClockDivider smoothDivider;
 
 	FORK() {
     config(NUM_PARAMS, NUM_INPUTS, NUM_OUTPUTS, NUM_LIGHTS);
@@ -123,8 +179,16 @@ struct FORK : BidooModule {
     configParam(F_PARAM + 3, 3000.0f, 4700.0f, 3400.0f);
     configParam(A_PARAM + 3, 0.0f, 0.3f, 0.2f);
 
-		init_formant();
-		f1=f2=f3=f4=100.0f;a1=a2=a3=a4=0.0f;
+		// the table is shared by every instance, fill it once
+		static const bool formantReady=(init_formant(),true);
+		(void)formantReady;
+		for(int k=0;k<4;k++)
+			for(int c=0;c<4;c++)
+			{
+				f[k][c]=100.0f;
+				a[k][c]=0.0f;
+			}
+		smoothDivider.setDivision(16);
 	}
 
 	void process(const ProcessArgs &args) override;
@@ -132,6 +196,7 @@ struct FORK : BidooModule {
 
 
 void FORK::process(const ProcessArgs &args) {
+  ProfileScope profile(this, args);
   if (presets.process(params[PRESET_PARAM].getValue())) {
     preset = (preset + 1)%8;
     params[F_PARAM].setValue(F1[preset]);
@@ -144,28 +209,36 @@ void FORK::process(const ProcessArgs &args) {
     params[A_PARAM+3].setValue(A4[preset]);
   }
 
-	f0=261.626f * powf(2.0f, clamp(params[PITCH_PARAM].getValue() + 12.0f * inputs[PITCH_INPUT].getVoltage(),-54.0f,54.0f) / 12.0f);
-	dp0=f0*(2/args.sampleRate);
-	float un_f0=1.0f/f0;
-	p0+=dp0;
-	p0-=2.0f*(p0>1.0f);
-	{
-		float r=0.001f;
-		f1+=r*(clamp(params[F_PARAM].getValue() + rescale(inputs[F_INPUT].getVoltage(),0.0f,10.0f,190.0f,730.0f),190.0f,730.0f)-f1);
-		f2+=r*(clamp(params[F_PARAM+1].getValue() + rescale(inputs[F_INPUT+1].getVoltage(),0.0f,10.0f,800.0f,2100.0f),800.0f,2100.0f)-f2);
-		f3+=r*(clamp(params[F_PARAM+2].getValue() + rescale(inputs[F_INPUT+2].getVoltage(),0.0f,10.0f,1500.0f,3100.0f),1500.0f,3100.0f)-f3);
-		f4+=r*(clamp(params[F_PARAM+3].getValue() + rescale(inputs[F_INPUT+3].getVoltage(),0.0f,10.0f,3000.0f,4700.0f),3000.0f,4700.0f)-f4);
-		a1+=r*(clamp(params[A_PARAM].getValue() + rescale(inputs[A_INPUT].getVoltage(),0.0f,10.0f,0.0f,1.0f),0.0f,1.0f)-a1);
-		a2+=r*(clamp(params[A_PARAM+1].getValue() + rescale(inputs[A_INPUT+1].getVoltage(),0.0f,10.0f,0.0f,2.0f),0.0f,2.0f)-a2);
-		a3+=r*(clamp(params[A_PARAM+2].getValue() + rescale(inputs[A_INPUT+2].getVoltage(),0.0f,10.0f,0.0f,0.7f),0.0f,0.7f)-a3);
-		a4+=r*(clamp(params[A_PARAM+3].getValue() + rescale(inputs[A_INPUT+3].getVoltage(),0.0f,10.0f,0.0f,0.3f),0.0f,0.3f)-a4);
+	int channels=std::max(inputs[PITCH_INPUT].getChannels(),1);
+
+	// first sample included, so the smoothing starts right away
+	if (smoothDivider.getClock()==0) {
+		for (int c=0; c<channels; c+=4) {
+			for (int k=0; k<4; k++) {
+				ft[k][c/4]=simd::clamp(params[F_PARAM+k].getValue() + simd::rescale(inputs[F_INPUT+k].getPolyVoltageSimd<float_4>(c),0.0f,10.0f,FMIN[k],FMAX[k]),FMIN[k],FMAX[k]);
+				at[k][c/4]=simd::clamp(params[A_PARAM+k].getValue() + simd::rescale(inputs[A_INPUT+k].getPolyVoltageSimd<float_4>(c),0.0f,10.0f,0.0f,AMAX[k]),0.0f,AMAX[k]);
+			}
+		}
 	}
+	smoothDivider.process();
 
-	float out= a1*(f0/f1)*formant(p0,100.0f*un_f0)*porteuse(f1*un_f0,p0)
-	 + 0.7f*a2*(f0/f2)*formant(p0,120.0f*un_f0)*porteuse(f2*un_f0,p0)
-	 +     a3*(f0/f3)*formant(p0,150.0f*un_f0)*porteuse(f3*un_f0,p0)
-	 +     a4*(f0/f4)*formant(p0,300.0f*un_f0)*porteuse(f4*un_f0,p0);
-	outputs[SIGNAL_OUTPUT].setVoltage(5.0f*out);
+	for (int c=0; c<channels; c+=4) {
+		int v=c/4;
+		float_4 pitch=simd::clamp(params[PITCH_PARAM].getValue() + 12.0f * inputs[PITCH_INPUT].getVoltageSimd<float_4>(c),-54.0f,54.0f);
+		float_4 f0=261.626f * simd::pow(2.0f, pitch/12.0f);
+		float_4 un_f0=1.0f/f0;
+		p0[v]+=f0*(2.0f*args.sampleTime);
+		p0[v]-=simd::ifelse(p0[v]>1.0f,float_4(2.0f),float_4(0.0f));
+
+		float_4 out=0.0f;
+		for (int k=0; k<4; k++) {
+			f[k][v]+=0.001f*(ft[k][v]-f[k][v]);
+			a[k][v]+=0.001f*(at[k][v]-a[k][v]);
+			out+=GAIN[k]*a[k][v]*(f0/f[k][v])*formant(p0[v],WIDTH[k]*un_f0)*porteuse(f[k][v]*un_f0,p0[v]);
+		}
+		outputs[SIGNAL_OUTPUT].setVoltageSimd(5.0f*out,c);
+	}
+	outputs[SIGNAL_OUTPUT].setChannels(channels);
 }
 
 struct FORKWidget : BidooWidget {
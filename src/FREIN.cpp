@@ -47,6 +47,7 @@ struct FREIN : BidooModule {
 	}
 
 	void process(const ProcessArgs &args) override {
+		ProfileScope profile(this, args);
 
 		if (trigTrigger.process(params[TRIG_PARAM].getValue() + inputs[TRIG_INPUT].getVoltage())) {
 			breakOn = true;
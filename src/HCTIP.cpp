@@ -42,6 +42,7 @@ struct HCTIP : BidooModule {
 	}
 
 	void process(const ProcessArgs &args) override {
+		ProfileScope profile(this, args);
 		in_Buffer.push(inputs[INPUT].getVoltage() / 10.0f);
 
 		if (in_Buffer.full()) {
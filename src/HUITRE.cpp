@@ -69,6 +69,7 @@ struct HUITRE : BidooModule {
 };
 
 void HUITRE::process(const ProcessArgs &args) {
+	ProfileScope profile(this, args);
 	for (int i = 0; i < 8; i++) {
 		if (patTriggers[i].process(params[TRIG_PARAM+i].getValue())) {
 			nextPattern = i;
@@ -30,6 +30,7 @@ struct LAMBDA : BidooModule {
 	LAMBDA() { config(NUM_PARAMS, NUM_INPUTS, NUM_OUTPUTS, NUM_LIGHTS); }
 
 	void process(const ProcessArgs &args) override {
+		ProfileScope profile(this, args);
 		if (sampleTrigger.process(inputs[CLOCK_INPUT].getVoltage())) {
 			outputs[SIX_OUTPUT].setVoltage(outputs[FIVE_OUTPUT].getVoltage());
 			outputs[FIVE_OUTPUT].setVoltage(outputs[FOUR_OUTPUT].getVoltage());
@@ -42,6 +42,7 @@ struct LATE : BidooModule {
 	}
 
 	void process(const ProcessArgs &args) override {
+		ProfileScope profile(this, args);
 		outputs[CLOCK_OUTPUT].setVoltage(0.f);
 		clock_t now = clock();
 
@@ -3,6 +3,7 @@
 #include "plugin.hpp"
 #include "BidooComponents.hpp"
 #include "dsp/resampler.hpp"
+#include "dep/fastmath.hpp"
 
 using namespace std;
 
@@ -12,15 +13,15 @@ struct FilterStage {
 	float mem = 0.0;
 
 	float Filter(float sample, float freq, float smpRate, float gain, int mode) {
-		float g = std::tan(pi*freq / smpRate);
+		float g = fastmath::tan((float)pi * freq / smpRate);
 		float G = g / (1.0 + g);
 		float out;
 		if (mode == 0) {
 			out = (sample - mem) * G + mem;
 		} else {
-			out = (std::tanh(sample*gain) / std::tanh(gain) - mem) * G + mem;
+			out = (fastmath::tanh(sample*gain) / fastmath::tanh(gain) - mem) * G + mem;
 		}
-		mem = out + (sample - mem) * G;
+		mem = fastmath::flushDenormal(out + (sample - mem) * G);
 		return out;
 	}
 };
@@ -45,7 +46,7 @@ struct LadderFilter {
 	}
 
 	float calcOutput(float sample) {
-		float g = std::tan(pi*freq / smpRate);
+		float g = fastmath::tan((float)pi * freq / smpRate);
 		float G = g / (1.0f + g);
 		G = G*G*G*G;
 		float S1 = stage1.mem / (1.0f + g);
@@ -108,6 +109,7 @@ struct LIMBO : BidooModule {
 	}
 
 	void process(const ProcessArgs &args) override {
+		ProfileScope profile(this, args);
 		float cfreq = std::pow(2.0f, rescale(clamp(params[CUTOFF_PARAM].getValue() + params[CMOD_PARAM].getValue() * inputs[CUTOFF_INPUT].getVoltage() * 0.2f, 0.0f, 1.0f), 0.0f, 1.0f, 4.5f, 14.0f));
 		float q = 3.5f * clamp(params[Q_PARAM].getValue() + inputs[Q_INPUT].getVoltage() * 0.2f, 0.0f, 1.0f);
 		float g = pow(2.0f, rescale(clamp(params[MUG_PARAM].getValue() + inputs[MUG_INPUT].getVoltage() * 0.2f, 0.0f, 1.0f), 0.0f, 1.0f, 0.0f, 3.0f));
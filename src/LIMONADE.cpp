@@ -2,6 +2,12 @@
 #include "dsp/digital.hpp"
 #include "BidooComponents.hpp"
 #include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <chrono>
 #include "dsp/resampler.hpp"
 #include "dsp/fir.hpp"
 #include "osdialog.h"
@@ -18,11 +24,6 @@ using namespace std;
 static const char WAV_FILTERS[] = "wav:wav";
 static const char PNG_FILTERS[] = "png:png";
 
-void tUpdateWaveTable(wtTable &table, float index) {
-	size_t i = index*(table.nFrames-1);
-	table.frames[i].calcWav();
-}
-
 void tSaveWaveTableAsWave(wtTable &table, int sampleRate, std::string path) {
 	drwav_data_format format;
 	format.container = drwav_container_riff;
@@ -310,6 +311,207 @@ void tDeleteMorphing(wtTable &table) {
 	table.deleteMorphing();
 }
 
+// Edit posted by the audio thread, a plain descriptor so posting never locks
+// or allocates.
+struct wtJob {
+	enum Type {
+		MORPH_WT,
+		MORPH_SPECTRUM,
+		MORPH_SPECTRUM_CONSTANT_PHASE,
+		DELETE_MORPHING,
+		NORMALIZE_WT,
+		NORMALIZE_FRAME,
+		NORMALIZE_ALL_FRAMES,
+		REMOVE_DC,
+		WINDOW_WT,
+		WINDOW_FRAME,
+		SMOOTH_WT,
+		SMOOTH_FRAME,
+		ADD_FRAME,
+		REMOVE_FRAME,
+		LOAD_ISAMPLE,
+		LOAD_IFRAME
+	};
+
+	Type type;
+	float index;
+	// recorded take of the LOAD_ jobs, pending is cleared once it is loaded
+	float *rec;
+	size_t len;
+	std::atomic<bool> *pending;
+
+	wtJob(Type type = MORPH_WT, float index = 0.f, float *rec = nullptr, size_t len = 0, std::atomic<bool> *pending = nullptr)
+		: type(type), index(index), rec(rec), len(len), pending(pending) {}
+};
+
+void tApply(wtTable &table, const wtJob &job) {
+	switch (job.type) {
+		case wtJob::MORPH_WT: tMorphWaveTable(table); break;
+		case wtJob::MORPH_SPECTRUM: tMorphSpectrum(table); break;
+		case wtJob::MORPH_SPECTRUM_CONSTANT_PHASE: tMorphSpectrumConstantPhase(table); break;
+		case wtJob::DELETE_MORPHING: tDeleteMorphing(table); break;
+		case wtJob::NORMALIZE_WT: tNormalizeWt(table); break;
+		case wtJob::NORMALIZE_FRAME: tNormalizeFrame(table, job.index); break;
+		case wtJob::NORMALIZE_ALL_FRAMES: tNormalizeAllFrames(table); break;
+		case wtJob::REMOVE_DC: tRemoveDCOffset(table); break;
+		case wtJob::WINDOW_WT: tWindowWt(table); break;
+		case wtJob::WINDOW_FRAME: tWindowFrame(table, job.index); break;
+		case wtJob::SMOOTH_WT: tSmoothWt(table); break;
+		case wtJob::SMOOTH_FRAME: tSmoothFrame(table, job.index); break;
+		case wtJob::ADD_FRAME: tAddFrame(table, job.index); break;
+		case wtJob::REMOVE_FRAME: tRemoveFrame(table, job.index); break;
+		case wtJob::LOAD_ISAMPLE: tLoadISample(table, job.rec, job.len*NF, job.len, true); break;
+		case wtJob::LOAD_IFRAME: tLoadIFrame(table, job.rec, job.index, job.len, true); break;
+	}
+}
+
+// Copy on write wavetable. Edits are queued and applied by a single worker on a
+// private copy which is then published, so the oscillators never see a table
+// being modified. A replaced table is freed by the worker once the audio
+// thread has moved to a newer one. The UI posts std::function jobs under a
+// lock, the audio thread pushes wtJob descriptors to a lock free ring and
+// raises posted. The worker sleeps until there is work, and only polls while
+// a replaced table is still playing.
+struct wtTableHolder {
+	typedef std::function<void(wtTable&)> Job;
+
+	std::shared_ptr<wtTable> current;
+	std::atomic<wtTable*> live;
+	std::atomic<wtTable*> playing;
+	std::vector<std::shared_ptr<wtTable>> retired;
+	std::deque<Job> jobs;
+	std::mutex jobsMutex;
+	dsp::RingBuffer<wtJob, 64> audioJobs;
+	std::atomic<bool> posted {false};
+	std::mutex editMutex;
+	std::condition_variable jobsCv;
+	bool running = true;
+	std::thread worker;
+
+	wtTableHolder() {
+		current = std::make_shared<wtTable>();
+		live.store(current.get());
+		playing.store(nullptr);
+		worker = std::thread(&wtTableHolder::run, this);
+	}
+
+	~wtTableHolder() {
+		stop();
+	}
+
+	// Drops pending jobs and waits for the one running.
+	void stop() {
+		{
+			std::lock_guard<std::mutex> lock(jobsMutex);
+			running = false;
+		}
+		jobsCv.notify_one();
+		if (worker.joinable()) worker.join();
+	}
+
+	// Snapshot for the UI, valid as long as the pointer is held.
+	std::shared_ptr<wtTable> get() {
+		return std::atomic_load(&current);
+	}
+
+	// Audio thread only, the table stays valid until the next call.
+	wtTable* acquire() {
+		wtTable *t;
+		do {
+			t = live.load();
+			playing.store(t);
+		} while (live.load() != t);
+		return t;
+	}
+
+	// Audio thread only, dropped if the ring is full.
+	bool push(const wtJob &job) {
+		if (audioJobs.full()) return false;
+		audioJobs.push(job);
+		posted.store(true);
+		jobsCv.notify_one();
+		return true;
+	}
+
+	// Audio thread, once per frame. The notify in push() is made without the
+	// lock and can land before the worker waits, so it is repeated until the
+	// worker has taken the jobs. Without waiters notify_one stays in user space.
+	void signal() {
+		if (posted.load(std::memory_order_relaxed)) jobsCv.notify_one();
+	}
+
+	// Queues an edit for the worker, never from the audio thread.
+	void post(Job job) {
+		{
+			std::lock_guard<std::mutex> lock(jobsMutex);
+			jobs.push_back(job);
+		}
+		jobsCv.notify_one();
+	}
+
+	// Applies the jobs to a copy of the current table and publishes it, true
+	// while a replaced table is still held. Never call it from the audio thread.
+	bool edit(const std::vector<Job> &batch, const std::vector<wtJob> &audioBatch = std::vector<wtJob>()) {
+		std::lock_guard<std::mutex> lock(editMutex);
+		std::shared_ptr<wtTable> next = std::make_shared<wtTable>(*current);
+		for (const Job &job : batch) {
+			job(*next);
+		}
+		for (const wtJob &job : audioBatch) {
+			tApply(*next, job);
+			if (job.pending) job.pending->store(false);
+		}
+		retired.push_back(current);
+		std::atomic_store(&current, next);
+		live.store(next.get());
+		return reclaim();
+	}
+
+	// From the UI, the worker is woken to reclaim the replaced table.
+	void edit(Job job) {
+		if (edit(std::vector<Job>(1, job))) jobsCv.notify_one();
+	}
+
+	// editMutex held, true while a replaced table is still held.
+	bool reclaim() {
+		wtTable *p = playing.load();
+		retired.erase(std::remove_if(retired.begin(), retired.end(), [=](const std::shared_ptr<wtTable> &t) {return t.get() != p;}), retired.end());
+		return !retired.empty();
+	}
+
+	void run() {
+		std::unique_lock<std::mutex> lock(jobsMutex);
+		std::vector<wtJob> audioBatch;
+		bool retiring = false;
+		while (running) {
+			if (jobs.empty() && !posted.load()) {
+				if (retiring) jobsCv.wait_for(lock, std::chrono::milliseconds(20));
+				else jobsCv.wait(lock);
+			}
+			posted.store(false);
+			audioBatch.clear();
+			while (!audioJobs.empty()) {
+				audioBatch.push_back(audioJobs.shift());
+			}
+			if (jobs.empty() && audioBatch.empty()) {
+				lock.unlock();
+				{
+					std::lock_guard<std::mutex> editLock(editMutex);
+					retiring = reclaim();
+				}
+				lock.lock();
+				continue;
+			}
+			// everything queued so far goes into a single copy
+			std::vector<Job> batch(jobs.begin(), jobs.end());
+			jobs.clear();
+			lock.unlock();
+			retiring = edit(batch, audioBatch);
+			lock.lock();
+		}
+	}
+};
+
 struct LIMONADE : BidooModule {
 	enum ParamIds {
 		RESET_PARAM,
@@ -371,7 +573,10 @@ struct LIMONADE : BidooModule {
 	int morphType = -1;
 	bool recWt = false;
 	bool recFrame = false;
-	float *iRec;
+	float *iRec[2];
+	// set while a take waits for the worker, the buffer can't be recorded over
+	std::atomic<bool> recPending[2];
+	int recBuffer = 0;
 	dsp::SchmittTrigger recTrigger, displayModeTrigger, loadSampleTrigger, loadPngTrigger, loadFrameTrigger, morphWtTrigger, morphSpectrumTrigger, morphSpectrumPhaseConstantTrigger,
 	removeMorphingTrigger, normalizeWtTrigger, normalizeFrameTrigger, normalizeAllFramesTrigger, removeDCTrigger, windowWtTrigger, windowFrameTrigger, smoothWtTrigger, smoothFrameTrigger,
 	addFrameTrigger, removeFrameTrigger, displayEditedFrameTrigger, displayPlayedFrameTrigger;
@@ -382,7 +587,7 @@ struct LIMONADE : BidooModule {
 	size_t index = 0;
 	bool dirty = true;
 
-	wtTable table;
+	wtTableHolder table;
 	wtOscillator<16, 16, float_4> oscillators[4];
 	wtOscillator<16, 16, float_4> oscillatorsUp[4];
 	wtOscillator<16, 16, float_4> oscillatorsDown[4];
@@ -426,16 +631,17 @@ struct LIMONADE : BidooModule {
 		configParam(ADDFRAME_PARAM, 0.0f, 1.0f, 0.0f, "Add frame");
 		configParam(REMOVEFRAME_PARAM, 0.0f, 1.0f, 0.0f, "Remove frame");
 
-		for(size_t i=0; i<4; i++) {
-			oscillators[i].table = &table;
-			oscillatorsUp[i].table = &table;
-			oscillatorsDown[i].table = &table;
-		}
-		iRec=(float*)calloc(4*NF*FS,sizeof(float));
+		// two record buffers so a new take can start while the last one is loaded
+		iRec[0]=(float*)calloc(4*NF*FS,sizeof(float));
+		iRec[1]=(float*)calloc(4*NF*FS,sizeof(float));
+		recPending[0] = false;
+		recPending[1] = false;
 	}
 
   ~LIMONADE() {
-		free(iRec);
+		table.stop();
+		free(iRec[0]);
+		free(iRec[1]);
 	}
 
 	void process(const ProcessArgs &args) override;
@@ -453,7 +659,7 @@ struct LIMONADE : BidooModule {
 	void morphSpectrum();
 	void morphSpectrumConstantPhase();
 	void removeMorphing();
-	void updateWaveTable();
+	void editBin(size_t frame, int bin, bool phase, bool reset, float delta);
 	void addFrame();
 	void removeFrame();
 	void resetWaveTable();
@@ -464,12 +670,13 @@ struct LIMONADE : BidooModule {
 	json_t *dataToJson() override {
 		json_t *rootJ = BidooModule::dataToJson();
 		json_t *framesJ = json_array();
+		std::shared_ptr<wtTable> t = table.get();
 		size_t nFrames = 0;
-		for (size_t i=0; i<table.nFrames; i++) {
-			if (!table.frames[i].morphed) {
+		for (size_t i=0; i<t->nFrames; i++) {
+			if (!t->frames[i].morphed) {
 				json_t *frameI = json_array();
 				for (size_t j=0; j<FS; j++) {
-					json_t *frameJ = json_real(table.frames[i].sample[j]);
+					json_t *frameJ = json_real(t->frames[i].sample[j]);
 					json_array_append_new(frameI, frameJ);
 				}
 				json_array_append_new(framesJ, frameI);
@@ -507,9 +714,10 @@ struct LIMONADE : BidooModule {
 		json_t *frameSizeJ = json_object_get(rootJ, "frameSize");
 		if (frameSizeJ)	frameSize = json_integer_value(frameSizeJ);
 
+		float *wav = NULL;
 		if (nFrames>0)
 		{
-			float *wav = (float*)calloc(nFrames*FS, sizeof(float));
+			wav = (float*)calloc(nFrames*FS, sizeof(float));
 			json_t *framesJ = json_object_get(rootJ, "frames");
 			for (size_t i = 0; i < nFrames; i++) {
 				json_t *frameJ = json_array_get(framesJ, i);
@@ -517,19 +725,24 @@ struct LIMONADE : BidooModule {
 					wav[i*FS+j] = json_number_value(json_array_get(frameJ, j));
 				}
 			}
-			table.loadSample(nFrames*FS, FS, false, wav);
-			if (morphType==0) {
-				morphWavetable();
-			}
-			else if (morphType==1) {
-				morphSpectrum();
-			}
-			else if (morphType==2) {
-				morphSpectrumConstantPhase();
-			}
-			free(wav);
 		}
-		table.calcFFT();
+		int type = morphType;
+		table.edit([&](wtTable &t) {
+			if (nFrames>0) {
+				t.loadSample(nFrames*FS, FS, false, wav);
+				if (type==0) {
+					t.morphFrames();
+				}
+				else if (type==1) {
+					t.morphSpectrum();
+				}
+				else if (type==2) {
+					t.morphSpectrumConstantPhase();
+				}
+			}
+			t.calcFFT();
+		});
+		free(wav);
 		dirty = true;
 	}
 
@@ -538,55 +751,71 @@ struct LIMONADE : BidooModule {
 	}
 
 	void onReset() override {
-		table.reset();
+		table.edit(tResetWaveTable);
 		lastPath = "";
 		dirty = true;
 	}
 };
 
-inline void LIMONADE::updateWaveTable() {
-	tUpdateWaveTable(table, params[INDEX_PARAM].getValue());
+void LIMONADE::editBin(size_t frame, int bin, bool phase, bool reset, float delta) {
+	table.post([=](wtTable &t) {
+		if ((frame>=t.nFrames) || (bin<0) || (bin>=FS2)) return;
+		wtFrame &f = t.frames[frame];
+		float oldMagnitude = f.magnitude[bin];
+		float oldPhase = f.phase[bin];
+		if (phase) {
+			f.phase[bin] = reset ? 0.0f : clamp(f.phase[bin] - delta, -1.0f*M_PI, M_PI);
+		}
+		else {
+			f.magnitude[bin] = reset ? 0.0f : clamp(f.magnitude[bin] - delta, 0.0f, 1.0f);
+		}
+		f.morphed = false;
+		f.updateBin(bin, oldMagnitude, oldPhase);
+	});
 }
 
 inline void LIMONADE::fftSample() {
-	tFFTSample(table, params[INDEX_PARAM].getValue());
+	float index = params[INDEX_PARAM].getValue();
+	table.post([=](wtTable &t) {tFFTSample(t, index);});
 }
 
 inline void LIMONADE::ifftSample() {
-	tIFFTSample(table, params[INDEX_PARAM].getValue());
+	float index = params[INDEX_PARAM].getValue();
+	table.post([=](wtTable &t) {tIFFTSample(t, index);});
 }
 
 inline void LIMONADE::morphWavetable() {
 	morphType = 0;
-	tMorphWaveTable(table);
+	table.push({wtJob::MORPH_WT});
 }
 
 inline void LIMONADE::morphSpectrum() {
 	morphType = 1;
-	tMorphSpectrum(table);
+	table.push({wtJob::MORPH_SPECTRUM});
 }
 
 inline void LIMONADE::morphSpectrumConstantPhase() {
 	morphType = 2;
-	tMorphSpectrumConstantPhase(table);
+	table.push({wtJob::MORPH_SPECTRUM_CONSTANT_PHASE});
 }
 
 inline void LIMONADE::removeMorphing() {
 	morphType = -1;
-	tDeleteMorphing(table);
+	table.push({wtJob::DELETE_MORPHING});
 }
 
 void LIMONADE::addFrame() {
-	thread t = thread(tAddFrame, std::ref(table), params[INDEX_PARAM].getValue());
-	t.detach();
+	float index = params[INDEX_PARAM].getValue();
+	table.push({wtJob::ADD_FRAME, index});
 }
 
 void LIMONADE::removeFrame() {
-	tRemoveFrame(table, params[INDEX_PARAM].getValue());
+	float index = params[INDEX_PARAM].getValue();
+	table.push({wtJob::REMOVE_FRAME, index});
 }
 
 void LIMONADE::resetWaveTable() {
-	tResetWaveTable(table);
+	table.post(tResetWaveTable);
 }
 
 void LIMONADE::loadSample() {
@@ -594,7 +823,9 @@ void LIMONADE::loadSample() {
 	char *path = osdialog_file(OSDIALOG_OPEN, "", NULL, filters);
 	if (path) {
 		lastPath=path;
-		tLoadSample(table, path, frameSize, true);
+		std::string p = path;
+		size_t len = frameSize;
+		table.post([=](wtTable &t) {tLoadSample(t, p, len, true);});
 		free(path);
 		morphType = -1;
 	}
@@ -606,7 +837,9 @@ void LIMONADE::loadFrame() {
 	char *path = osdialog_file(OSDIALOG_OPEN, "", NULL, filters);
 	if (path) {
 		lastPath=path;
-		tLoadFrame(table, path, params[INDEX_PARAM].getValue(), true);
+		std::string p = path;
+		float index = params[INDEX_PARAM].getValue();
+		table.post([=](wtTable &t) {tLoadFrame(t, p, index, true);});
 		free(path);
 	}
 	osdialog_filters_free(filters);
@@ -617,46 +850,58 @@ void LIMONADE::loadPNG() {
 	char *path = osdialog_file(OSDIALOG_OPEN, "", NULL, filters);
 	if (path) {
 		lastPath=path;
-		tLoadPNG(table, path);
+		std::string p = path;
+		table.post([=](wtTable &t) {tLoadPNG(t, p);});
 		free(path);
 	}
 	osdialog_filters_free(filters);
 }
 
 void LIMONADE::windowWt() {
-	tWindowWt(table);
+	table.push({wtJob::WINDOW_WT});
 }
 
 void LIMONADE::smoothWt() {
-	tSmoothWt(table);
+	table.push({wtJob::SMOOTH_WT});
 }
 
 void LIMONADE::windowFrame() {
-	tWindowFrame(table, params[INDEX_PARAM].getValue());
+	float index = params[INDEX_PARAM].getValue();
+	table.push({wtJob::WINDOW_FRAME, index});
 }
 
 void LIMONADE::smoothFrame() {
-	tSmoothFrame(table, params[INDEX_PARAM].getValue());
+	float index = params[INDEX_PARAM].getValue();
+	table.push({wtJob::SMOOTH_FRAME, index});
 }
 
 void LIMONADE::removeDCOffset() {
-	tRemoveDCOffset(table);
+	table.push({wtJob::REMOVE_DC});
 }
 
 
 void LIMONADE::normalizeFrame() {
-	tNormalizeFrame(table, params[INDEX_PARAM].getValue());
+	float index = params[INDEX_PARAM].getValue();
+	table.push({wtJob::NORMALIZE_FRAME, index});
 }
 
 void LIMONADE::normalizeWt() {
-	tNormalizeWt(table);
+	table.push({wtJob::NORMALIZE_WT});
 }
 
 void LIMONADE::normalizeAllFrames() {
-	tNormalizeAllFrames(table);
+	table.push({wtJob::NORMALIZE_ALL_FRAMES});
 }
 
 void LIMONADE::process(const ProcessArgs &args) {
+	ProfileScope profile(this, args);
+	table.signal();
+	wtTable *playing = table.acquire();
+	for (size_t i=0; i<4; i++) {
+		oscillators[i].table = playing;
+		oscillatorsUp[i].table = playing;
+		oscillatorsDown[i].table = playing;
+	}
 
 	if (displayModeTrigger.process(params[DISPLAYMODE_PARAM].getValue())) {
 		displayMode = (displayMode == 0) ? 1 : 0;
@@ -726,32 +971,35 @@ void LIMONADE::process(const ProcessArgs &args) {
 		removeFrame();
 	}
 
-	if (recTrigger.process(params[RECWT_PARAM].getValue()) && !recWt && !recFrame) {
+	if (recTrigger.process(params[RECWT_PARAM].getValue()) && !recWt && !recFrame && !recPending[recBuffer]) {
 		recWt = true;
 		recIndex=0;
 		lights[RECWT_LIGHT].setBrightness(1.0f);
 	}
 
-	if (recTrigger.process(params[RECFRAME_PARAM].getValue()) && !recWt && !recFrame) {
+	if (recTrigger.process(params[RECFRAME_PARAM].getValue()) && !recWt && !recFrame && !recPending[recBuffer]) {
 		recFrame = true;
 		recIndex=0;
 		lights[RECFRAME_LIGHT].setBrightness(1.0f);
 	}
 
 	if (recWt || recFrame) {
-		iRec[recIndex]=inputs[IN].getVoltage()*0.1f;
+		float *rec = iRec[recBuffer];
+		rec[recIndex]=inputs[IN].getVoltage()*0.1f;
 		recIndex++;
 
 		if (recWt && (recIndex==frameSize*NF)) {
-			thread t = thread(tLoadISample, std::ref(table), std::ref(iRec), frameSize*NF, frameSize, true);
-			t.detach();
+			recPending[recBuffer] = true;
+			if (!table.push({wtJob::LOAD_ISAMPLE, 0.0f, rec, frameSize, &recPending[recBuffer]})) recPending[recBuffer] = false;
+			recBuffer = 1 - recBuffer;
 			recWt = false;
 			recIndex = 0;
 			lights[RECWT_LIGHT].setBrightness(0.0f);
 		}
 		else if (recFrame && (recIndex==frameSize)) {
-			thread t = thread(tLoadIFrame, std::ref(table), std::ref(iRec), params[INDEX_PARAM].getValue(), frameSize, true);
-			t.detach();
+			recPending[recBuffer] = true;
+			if (!table.push({wtJob::LOAD_IFRAME, params[INDEX_PARAM].getValue(), rec, frameSize, &recPending[recBuffer]})) recPending[recBuffer] = false;
+			recBuffer = 1 - recBuffer;
 			recFrame = false;
 			recIndex = 0;
 			lights[RECFRAME_LIGHT].setBrightness(0.0f);
@@ -763,7 +1011,7 @@ void LIMONADE::process(const ProcessArgs &args) {
 	float fmParam = dsp::quadraticBipolar(params[FM_PARAM].getValue());
 
 	int channels = std::max(inputs[PITCH_INPUT].getChannels(), 1);
-	index = clamp(params[WTINDEX_PARAM].getValue() + inputs[WTINDEX_INPUT].getVoltage() * 0.1f * params[WTINDEXATT_PARAM].getValue(),0.0f,1.0f)*(float)(table.nFrames == 0 ? 0 : table.nFrames - 1);
+	index = clamp(params[WTINDEX_PARAM].getValue() + inputs[WTINDEX_INPUT].getVoltage() * 0.1f * params[WTINDEXATT_PARAM].getValue(),0.0f,1.0f)*(float)(playing->nFrames == 0 ? 0 : playing->nFrames - 1);
 	float ur = clamp(params[UNISSONRANGE_PARAM].getValue() + rescale(inputs[UNISSONRANGE_INPUT].getVoltage(),0.0f,10.0f,0.0f,0.02f),0.0f,0.02f);
 
 	for (int c = 0; c < channels; c += 4) {
@@ -894,28 +1142,17 @@ struct LIMONADEBinsDisplay : OpaqueWidget {
 	}
 
 	void onDragMove(const event::DragMove &e) override {
-		if ((!scroll) && (module->table.nFrames>0)) {
-			size_t i = module->params[LIMONADE::INDEX_PARAM].getValue()*(module->table.nFrames-1);
+		size_t nFrames = module->table.get()->nFrames;
+		if ((!scroll) && (nFrames>0)) {
+			size_t i = module->params[LIMONADE::INDEX_PARAM].getValue()*(nFrames-1);
+			bool reset = (APP->window->getMods() & RACK_MOD_MASK) == (GLFW_MOD_CONTROL);
+			float delta = e.mouseDelta.y/(250/APP->scene->rackScroll->zoomWidget->zoom);
 			if (refY<=heightMagn) {
-				if ((APP->window->getMods() & RACK_MOD_MASK) == (GLFW_MOD_CONTROL)) {
-					module->table.frames[i].magnitude[refIdx] = 0.0f;
-				}
-				else {
-					module->table.frames[i].magnitude[refIdx] -= e.mouseDelta.y/(250/APP->scene->rackScroll->zoomWidget->zoom);
-					module->table.frames[i].magnitude[refIdx] = clamp(module->table.frames[i].magnitude[refIdx],0.0f, 1.0f);
-				}
+				module->editBin(i, refIdx, false, reset, delta);
 			}
 			else if (refY>=heightMagn+graphGap) {
-				if ((APP->window->getMods() & RACK_MOD_MASK) == (GLFW_MOD_CONTROL)) {
-					module->table.frames[i].phase[refIdx] = 0.0f;
-				}
-				else {
-					module->table.frames[i].phase[refIdx] -= e.mouseDelta.y / (250 / APP->scene->rackScroll->zoomWidget->zoom);
-					module->table.frames[i].phase[refIdx] = clamp(module->table.frames[i].phase[refIdx],-1.0f*M_PI, M_PI);
-				}
+				module->editBin(i, refIdx, true, reset, delta);
 			}
-			module->table.frames[i].morphed = false;
-			module->updateWaveTable();
 		}
 		else {
 				scrollLeftAnchor = clamp(scrollLeftAnchor + e.mouseDelta.x / APP->scene->rackScroll->zoomWidget->zoom, 0.0f,width-20.0f);
@@ -935,12 +1172,13 @@ struct LIMONADEBinsDisplay : OpaqueWidget {
 				nvgSave(args.vg);
 				wtFrame frame, playedFrame;
 				size_t tag=1;
+				std::shared_ptr<wtTable> table = module->table.get();
 
-				if (module->table.nFrames>0) {
-					frame.magnitude = module->table.frames[(size_t)(module->params[LIMONADE::INDEX_PARAM].getValue()*(module->table.nFrames - 1))].magnitude;
-					frame.phase = module->table.frames[(size_t)(module->params[LIMONADE::INDEX_PARAM].getValue()*(module->table.nFrames - 1))].phase;
-					frame.sample = module->table.frames[(size_t)(module->params[LIMONADE::INDEX_PARAM].getValue()*(module->table.nFrames - 1))].sample;
-					playedFrame.sample = module->table.frames[module->index].sample;
+				if (table->nFrames>0) {
+					frame.magnitude = table->frames[(size_t)(module->params[LIMONADE::INDEX_PARAM].getValue()*(table->nFrames - 1))].magnitude;
+					frame.phase = table->frames[(size_t)(module->params[LIMONADE::INDEX_PARAM].getValue()*(table->nFrames - 1))].phase;
+					frame.sample = table->frames[(size_t)(module->params[LIMONADE::INDEX_PARAM].getValue()*(table->nFrames - 1))].sample;
+					playedFrame.sample = table->frames[module->index].sample;
 				}
 
 				Rect b = Rect(Vec(zoomLeftAnchor, 0), Vec(zoomWidth, heightMagn + graphGap + heightPhas));
@@ -961,8 +1199,8 @@ struct LIMONADEBinsDisplay : OpaqueWidget {
 
 				nvgText(args.vg, 130.0f, heightMagn + graphGap * 0.5f + 4, "▲ Magnitude ▼ Phase", NULL);
 
-				if (module->table.nFrames>0) {
-					nvgText(args.vg, 0.0f, heightMagn + graphGap * 0.5f + 4, ("Frame " + to_string((int)(module->params[LIMONADE::INDEX_PARAM].getValue()*(module->table.nFrames-1) + 1)) + " / " + to_string(module->table.nFrames)).c_str(), NULL);
+				if (table->nFrames>0) {
+					nvgText(args.vg, 0.0f, heightMagn + graphGap * 0.5f + 4, ("Frame " + to_string((int)(module->params[LIMONADE::INDEX_PARAM].getValue()*(table->nFrames-1) + 1)) + " / " + to_string(table->nFrames)).c_str(), NULL);
 					for (size_t i = 0; i < FS2/2; i++) {
 						float x, y;
 						x = (float)i * IFS2;
@@ -1102,7 +1340,8 @@ struct LIMONADEWavDisplay : OpaqueWidget {
 	void drawLayer(const DrawArgs& args, int layer) override {
 		if (layer == 1) {
 			if (module && (module->displayMode == 0)) {
-				size_t fs = module->table.nFrames;
+				std::shared_ptr<wtTable> table = module->table.get();
+				size_t fs = table->nFrames;
 				size_t idx = 0;
 				size_t wtidx = 0;
 				if (fs>0) {
@@ -1124,7 +1363,7 @@ struct LIMONADEWavDisplay : OpaqueWidget {
 					nvgBeginPath(args.vg);
 					for (size_t i=0; i<FS2; i+=2) {
 						x3D = 20.0f * i * IFS -5.0f;
-						z3D = (-1.f)*module->table.frames[fid].sample[2*i];
+						z3D = (-1.f)*table->frames[fid].sample[2*i];
 						y2D = z3D*ca1-(ca2*y3D-sa2*x3D)*sa1+5.0f;
 						x2D = ca2*x3D+sa2*y3D+7.5f;
 						if (i == 0) {
@@ -1135,7 +1374,7 @@ struct LIMONADEWavDisplay : OpaqueWidget {
 						}
 					}
 
-					nvgStrokeColor(args.vg, nvgRGBA(255, 233, 0, module->table.frames[fid].morphed ? 15 : 50));
+					nvgStrokeColor(args.vg, nvgRGBA(255, 233, 0, table->frames[fid].morphed ? 15 : 50));
 					nvgStroke(args.vg);
 				}
 
@@ -1144,7 +1383,7 @@ struct LIMONADEWavDisplay : OpaqueWidget {
 					y3D = 10.0f * idx/fs -5.0f;
 					for (size_t i=0; i<FS; i++) {
 						x3D = 10.0f * i * IFS -5.0f;
-						z3D = (-1.f)*module->table.frames[idx].sample[i];
+						z3D = (-1.f)*table->frames[idx].sample[i];
 						y2D = z3D*ca1-(ca2*y3D-sa2*x3D)*sa1+5.0f;
 						x2D = ca2*x3D+sa2*y3D+7.5f;
 						if (i == 0) {
@@ -1161,7 +1400,7 @@ struct LIMONADEWavDisplay : OpaqueWidget {
 					y3D = 10.0f * wtidx/fs -5.0f;
 					for (size_t i=0; i<FS; i++) {
 						x3D = 10.0f * i * IFS -5.0f;
-						z3D = (-1.f)*module->table.frames[wtidx].sample[i];
+						z3D = (-1.f)*table->frames[wtidx].sample[i];
 						y2D = z3D*ca1-(ca2*y3D-sa2*x3D)*sa1+5.0f;
 						x2D = ca2*x3D+sa2*y3D+7.5f;
 						if (i == 0) {
@@ -1243,7 +1482,7 @@ struct moduleSaveWavetableAsWavItem : MenuItem {
 		osdialog_filters* filters = osdialog_filters_parse(WAV_FILTERS);
 		char *path = osdialog_file(OSDIALOG_SAVE, dir.c_str(), "Untitled", filters);
 		if (path) {
-			tSaveWaveTableAsWave(module->table, APP->engine->getSampleRate(), path);
+			tSaveWaveTableAsWave(*module->table.get(), APP->engine->getSampleRate(), path);
 			free(path);
 		}
 		osdialog_filters_free(filters);
@@ -1257,7 +1496,8 @@ struct moduleSaveFrameAsWavItem : MenuItem {
 		osdialog_filters* filters = osdialog_filters_parse(WAV_FILTERS);
 		char *path = osdialog_file(OSDIALOG_SAVE, dir.c_str(), "Untitled", filters);
 		if (path) {
-			tSaveFrameAsWave(module->table, APP->engine->getSampleRate(), path, (size_t)(module->params[LIMONADE::INDEX_PARAM].getValue()*(module->table.nFrames - 1)));
+			std::shared_ptr<wtTable> table = module->table.get();
+			tSaveFrameAsWave(*table, APP->engine->getSampleRate(), path, (size_t)(module->params[LIMONADE::INDEX_PARAM].getValue()*(table->nFrames - 1)));
 			free(path);
 		}
 		osdialog_filters_free(filters);
@@ -1271,7 +1511,7 @@ struct moduleSaveWavetableAsPngItem : MenuItem {
 		osdialog_filters* filters = osdialog_filters_parse(PNG_FILTERS);
 		char *path = osdialog_file(OSDIALOG_SAVE, dir.c_str(), "Untitled", filters);
 		if (path) {
-			tSaveWaveTableAsPng(module->table, APP->engine->getSampleRate(), path);
+			tSaveWaveTableAsPng(*module->table.get(), APP->engine->getSampleRate(), path);
 			free(path);
 		}
 		osdialog_filters_free(filters);
@@ -1486,7 +1726,9 @@ struct LIMONADEWidget : BidooWidget {
 		Widget::onPathDrop(e);
 		LIMONADE *module = dynamic_cast<LIMONADE*>(this->module);
 		module->lastPath=e.paths[0];
-		tLoadSample(module->table, e.paths[0], module->frameSize, true);
+		std::string path = e.paths[0];
+		size_t len = module->frameSize;
+		module->table.post([=](wtTable &t) {tLoadSample(t, path, len, true);});
 		module->morphType = -1;
 	}
 };
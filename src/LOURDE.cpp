@@ -44,6 +44,7 @@ struct LOURDE : BidooModule {
 
 
 void LOURDE::process(const ProcessArgs &args) {
+  ProfileScope profile(this, args);
   float sum = clamp(params[WEIGHT1].getValue()+inputs[INWEIGHT1].getVoltage(),-5.0f,5.0f)*inputs[IN1].getVoltage() + clamp(params[WEIGHT2].getValue()+inputs[INWEIGHT2].getVoltage(),-5.0f,5.0f)*inputs[IN2].getVoltage()
 	+ clamp(params[WEIGHT3].getValue()+inputs[INWEIGHT3].getVoltage(),-5.0f,5.0f)*inputs[IN3].getVoltage();
 	outputs[OUT].setVoltage(sum >= clamp(params[OUTFLOOR].getValue()+inputs[INFLOOR].getVoltage(),-10.0f,10.0f) ? 10.0f : 0.0f);
@@ -2,6 +2,7 @@
 #include "BidooComponents.hpp"
 #include "dsp/ringbuffer.hpp"
 #include "dsp/digital.hpp"
+#include "dep/fastmath.hpp"
 
 using namespace std;
 
@@ -69,6 +70,7 @@ struct MINIBAR : BidooModule {
 };
 
 void MINIBAR::process(const ProcessArgs &args) {
+	ProfileScope profile(this, args);
 	if (bypassTrigger.process(params[BYPASS_PARAM].getValue())) {
 		bypass = !bypass;
 	}
@@ -96,12 +98,12 @@ void MINIBAR::process(const ProcessArgs &args) {
 	buffL[lookAheadWriteIndex]=inputs[IN_L_INPUT].getVoltage();
 
 	if (inputs[IN_L_INPUT].isConnected())
-		in_L_dBFS = max(20.0f*log10((abs(inputs[IN_L_INPUT].getVoltage())+1e-6f) * 0.2f), -96.3f);
+		in_L_dBFS = max(fastmath::ampToDb((abs(inputs[IN_L_INPUT].getVoltage())+1e-6f) * 0.2f), -96.3f);
 	else
 		in_L_dBFS = -96.3f;
 
 	if (inputs[SC_L_INPUT].isConnected())
-		SC_in_L_dBFS = max(20.0f*log10((abs(inputs[SC_L_INPUT].getVoltage())+1e-6f) * 0.2f), -96.3f);
+		SC_in_L_dBFS = max(fastmath::ampToDb((abs(inputs[SC_L_INPUT].getVoltage())+1e-6f) * 0.2f), -96.3f);
 	else
 		SC_in_L_dBFS = -96.3f;
 
@@ -159,8 +161,8 @@ void MINIBAR::process(const ProcessArgs &args) {
 
 	float preGain = gcurve - maxIn;
 	float postGain = 0.0f;
-	float cAtt = exp(-1.0f/(attackTime * args.sampleRate * 0.001f));
-	float cRel = exp(-1.0f/(releaseTime * args.sampleRate * 0.001f));
+	float cAtt = fastmath::exp(-1.0f/(attackTime * args.sampleRate * 0.001f));
+	float cRel = fastmath::exp(-1.0f/(releaseTime * args.sampleRate * 0.001f));
 
 	if (preGain<previousPostGain) {
 		postGain = cAtt * previousPostGain + (1.0f-cAtt) * preGain;
@@ -170,7 +172,7 @@ void MINIBAR::process(const ProcessArgs &args) {
 
 	previousPostGain = postGain;
 	gaindB = makeup + postGain;
-	gain = pow(10.0f, gaindB/20.0f);
+	gain = fastmath::dbToAmp(gaindB);
 
 	mix = params[MIX_PARAM].getValue();
 	mixDisplay = mix*100.f;
@@ -139,6 +139,7 @@ struct MOIRE : BidooModule {
 };
 
 void MOIRE::process(const ProcessArgs &args) {
+	ProfileScope profile(this, args);
 	targetScene = clamp(floor(inputs[TARGETSCENE_INPUT].getVoltage() * 1.5f) + params[TARGETSCENE_PARAM].getValue() , 0.0f, 15.0f);
 	currentScene = clamp(floor(inputs[CURRENTSCENE_INPUT].getVoltage() * 1.5f) + params[CURRENTSCENE_PARAM].getValue() , 0.0f, 15.0f);
 
@@ -28,6 +28,7 @@ struct MS : BidooModule {
 	MS() { config(NUM_PARAMS, NUM_INPUTS, NUM_OUTPUTS, NUM_LIGHTS); }
 
 	void process(const ProcessArgs &args) override {
+		ProfileScope profile(this, args);
 		outputs[S_OUTPUT].setVoltage(0.5f * (inputs[L_INPUT].getVoltage() - inputs[R_INPUT].getVoltage()));
 		outputs[M_OUTPUT].setVoltage(0.5f * (inputs[L_INPUT].getVoltage() + inputs[R_INPUT].getVoltage()));
 		outputs[L_OUTPUT].setVoltage(inputs[M_INPUT].getVoltage() + inputs[S_INPUT].getVoltage());
@@ -107,6 +107,7 @@ struct MU : BidooModule {
 };
 
 void MU::process(const ProcessArgs &args) {
+	ProfileScope profile(this, args);
 	const float invLightLambda = 13.333333333333333333333f;
 	float invESR = 1 / args.sampleRate;
 
@@ -4,35 +4,11 @@
 #include <iomanip>
 #include "osdialog.h"
 #include "dep/waves.hpp"
+#include "dep/filters/svf.hpp"
 #include <mutex>
 
 using namespace std;
 
-#define pi 3.14159265359
-
-struct MultiFilter {
-	float q;
-	float freq;
-	float smpRate;
-	float hp = 0.0f, bp = 0.0f, lp = 0.0f, mem1 = 0.0f, mem2 = 0.0f;
-
-	void setParams(float freq, float q, float smpRate) {
-		this->freq = freq;
-		this->q = q;
-		this->smpRate = smpRate;
-	}
-
-	void calcOutput(float sample) {
-		float g = tan(pi*freq / smpRate);
-		float R = 1.0f / (2.0f*q);
-		hp = (sample - (2.0f*R + g)*mem1 - mem2) / (1.0f + 2.0f * R * g + g * g);
-		bp = g * hp + mem1;
-		lp = g * bp + mem2;
-		mem1 = g * hp + bp;
-		mem2 = g * bp + lp;
-	}
-};
-
 struct channel {
 	float start=0.0f;
 	float len=1.0f;
@@ -43,14 +19,13 @@ struct channel {
 	int filterType=0;
 	float q=0.1f;
 	float freq=1.0f;
-	MultiFilter filter;
 	std::string lastPath;
 	std::string waveFileName;
 	std::string waveExtension;
 	int sampleChannels;
 	int sampleRate;
 	int totalSampleCount;
-	vector<dsp::Frame<1>> playBuffer;
+	waves::MonoSample playBuffer;
 	bool active=false;
 	int kill=-1;
 
@@ -118,7 +93,13 @@ struct OAI : BidooModule {
 	channel channels[16];
 	int currentChannel=0;
 	dsp::SchmittTrigger triggers[16];
+	svf::MultiFilter4 filters[4];
+	float filterFreq[16];
+	float filterCutoff[16];
 	bool loading=false;
+	bool reloading=false;
+	int storage = waves::STORAGE_FLOAT;
+	bool keepSource = true;
 	bool play = false;
 	std::mutex mylock;
 
@@ -136,7 +117,9 @@ struct OAI : BidooModule {
 		configParam(KILL_PARAM, -1.0f, 15.0f, -1.0f);
 
 		for (int i=0; i<16; i++) {
-			channels[i].playBuffer.resize(0);
+			channels[i].playBuffer.clear();
+			filterFreq[i] = -1.0f;
+			filterCutoff[i] = 0.0f;
 		}
 	}
 
@@ -178,6 +161,8 @@ struct OAI : BidooModule {
 	json_t *dataToJson() override {
 		json_t *rootJ = BidooModule::dataToJson();
 		json_object_set_new(rootJ, "currentChannel", json_integer(currentChannel));
+		json_object_set_new(rootJ, "storage", json_integer(storage));
+		json_object_set_new(rootJ, "keepSource", json_boolean(keepSource));
 		for (size_t i = 0; i<16 ; i++) {
 			json_t *channelJ = json_object();
 			json_object_set_new(channelJ, "lastPath", json_string(channels[i].lastPath.c_str()));
@@ -204,6 +189,10 @@ struct OAI : BidooModule {
 
 	void dataFromJson(json_t *rootJ) override {
 		BidooModule::dataFromJson(rootJ);
+		json_t *storageJ = json_object_get(rootJ, "storage");
+		if (storageJ) storage = json_integer_value(storageJ);
+		json_t *keepSourceJ = json_object_get(rootJ, "keepSource");
+		keepSource = keepSourceJ ? json_is_true(keepSourceJ) : storage == waves::STORAGE_FLOAT;
 		for (size_t i = 0; i<16 ; i++) {
 			json_t *channelJ = json_object_get(rootJ, ("channel" + to_string(i)).c_str());
 			if (channelJ){
@@ -272,28 +261,37 @@ struct OAI : BidooModule {
 		params[KILL_PARAM].setValue(channels[currentChannel].kill);
 	}
 
-	void onSampleRateChange() override {
+	void reloadSamples() {
 		int tmpChannel=currentChannel;
 		for (size_t i = 0; i<16 ; i++) {
 			currentChannel = i;
 			if (!channels[i].lastPath.empty()) loadSample();
 		}
 		currentChannel=tmpChannel;
+		reloading = false;
+	}
+
+	void onSampleRateChange() override {
+		reloadSamples();
 	}
 };
 
 void OAI::loadSample() {
 	APP->engine->yieldWorkers();
-	channels[currentChannel].playBuffer = waves::getMonoWav(channels[currentChannel].lastPath, APP->engine->getSampleRate(), channels[currentChannel].waveFileName, channels[currentChannel].waveExtension,
-	 channels[currentChannel].sampleChannels, channels[currentChannel].sampleRate, channels[currentChannel].totalSampleCount);
+	channels[currentChannel].playBuffer = waves::acquireMonoWav(channels[currentChannel].lastPath, APP->engine->getSampleRate(), channels[currentChannel].waveFileName, channels[currentChannel].waveExtension,
+	 channels[currentChannel].sampleChannels, channels[currentChannel].sampleRate, channels[currentChannel].totalSampleCount, storage, keepSource);
 	loading = false;
 }
 
 void OAI::process(const ProcessArgs &args) {
+	ProfileScope profile(this, args);
 	mylock.lock();
 	if (loading) {
 		loadSample();
 	}
+	if (reloading) {
+		reloadSamples();
+	}
 	mylock.unlock();
 	if (channels[currentChannel].playBuffer.size()==0) {
 		lights[SAMPLE_LIGHT].setBrightness(1.0f);
@@ -333,8 +331,21 @@ void OAI::process(const ProcessArgs &args) {
 
 	outputs[POLY_OUTPUT].setChannels(c);
 
+	float voiceActive[16] = {0.0f};
+	float voiceHead[16] = {0.0f};
+	float voiceSpeed[16] = {0.0f};
+	float voiceStart[16] = {0.0f};
+	float voiceEnd[16] = {0.0f};
+	float voiceLast[16] = {0.0f};
+	float voiceRewind[16] = {0.0f};
+	float voiceFilterType[16] = {0.0f};
+	float voiceX0[16] = {0.0f};
+	float voiceX1[16] = {0.0f};
+	float voiceXf[16] = {0.0f};
+
 	for (int i=0;i<c;i++) {
-		if (channels[i].playBuffer.size()>0) {
+		int size = channels[i].playBuffer.size();
+		if (size>0) {
 			float start = clamp(channels[i].start + (inputs[START_INPUT].isConnected() ? rescale(inputs[START_INPUT].getVoltage(i),0.0f,10.0f,0.0f,1.0f) : 0.0f), 0.0f, 1.0f);
 			float len = clamp(channels[i].len + (inputs[LEN_INPUT].isConnected() ? rescale(inputs[LEN_INPUT].getVoltage(i),0.0f,10.0f,0.0f,1.0f) : 0.0f), 0.0f, 1.0f);
 			float speed = clamp(channels[i].speed + (inputs[SPEED_INPUT].isConnected() ? rescale(inputs[SPEED_INPUT].getVoltage(i),0.0f,10.0f,0.0f,1.0f) : 0.0f), 0.0f, 10.0f);
@@ -342,7 +353,13 @@ void OAI::process(const ProcessArgs &args) {
 			int gate = inputs[GATE_INPUT].isConnected() ? rescale(inputs[GATE_INPUT].getVoltage(i),0.0f,10.0f,0.0f,1.0f) : channels[i].gate;
 			int filterType = inputs[FILTERTYPE_INPUT].isConnected() ? rescale(inputs[FILTERTYPE_INPUT].getVoltage(i),0.0f,10.0f,0.0f,3.0f) : channels[i].filterType;
 			float q = 10.0f *clamp(channels[i].q + (inputs[Q_INPUT].isConnected() ? rescale(inputs[Q_INPUT].getVoltage(i),0.0f,10.0f,0.1f,1.0f) : 0.0f), 0.1f, 1.0f);
-			float freq = std::pow(2.0f, rescale(clamp(channels[i].freq + (inputs[FREQ_INPUT].isConnected() ? rescale(inputs[FREQ_INPUT].getVoltage(i),0.0f,10.0f,0.0f,1.0f) : 0.0f), 0.0f, 1.0f), 0.0f, 1.0f, 4.5f, 14.0f));
+			float freq = clamp(channels[i].freq + (inputs[FREQ_INPUT].isConnected() ? rescale(inputs[FREQ_INPUT].getVoltage(i),0.0f,10.0f,0.0f,1.0f) : 0.0f), 0.0f, 1.0f);
+
+			if (freq != filterFreq[i]) {
+				filterFreq[i] = freq;
+				filterCutoff[i] = std::pow(2.0f, rescale(freq, 0.0f, 1.0f, 4.5f, 14.0f));
+			}
+			filters[i/4].setParams(i%4, filterCutoff[i], q, args.sampleRate);
 
 			if ((!channels[i].active || (gate==1.0f)) && (triggers[i].process(inputs[TRIG_INPUT].getVoltage(i)))) {
 				channels[i].active = true;
@@ -361,37 +378,47 @@ void OAI::process(const ProcessArgs &args) {
 			}
 
 			if (channels[i].active) {
-				int xi = channels[i].head;
-				float xf = channels[i].head - xi;
-				float crossfaded = crossfade(channels[i].playBuffer[xi].samples[0], channels[i].playBuffer[xi + 1].samples[0], xf);
-				channels[i].filter.setParams(freq, q, args.sampleRate);
-				channels[i].filter.calcOutput(crossfaded);
-				if (filterType == 0.0f) {
-					outputs[POLY_OUTPUT].setVoltage(5.0f * crossfaded,i);
-				}
-				else if (filterType == 1.0f) {
-					outputs[POLY_OUTPUT].setVoltage(5.0f * channels[i].filter.lp,i);
-				}
-				else if (filterType == 2.0f) {
-					outputs[POLY_OUTPUT].setVoltage(5.0f * channels[i].filter.bp,i);
-				}
-				else {
-					outputs[POLY_OUTPUT].setVoltage(5.0f * channels[i].filter.hp,i);
-				}
-
-				channels[i].head += speed;
-				if ((channels[i].head >= (channels[i].playBuffer.size()-1)) || (channels[i].head > ((start+len)*channels[i].playBuffer.size()))) {
-					if (loop && (gate==0.0f)) {
-						channels[i].head = start*channels[i].playBuffer.size();
-					}
-					else {
-						channels[i].active=false;
-					}
-				}
-			}
-			else {
-				outputs[POLY_OUTPUT].setVoltage(0.0f,i);
+				int xi = std::min((int)channels[i].head, size-1);
+				voiceActive[i] = 1.0f;
+				voiceX0[i] = channels[i].playBuffer[xi].samples[0];
+				voiceX1[i] = channels[i].playBuffer[std::min(xi + 1, size-1)].samples[0];
+				voiceXf[i] = channels[i].head - xi;
 			}
+			voiceHead[i] = channels[i].head;
+			voiceSpeed[i] = speed;
+			voiceStart[i] = start*channels[i].playBuffer.size();
+			voiceEnd[i] = (start+len)*channels[i].playBuffer.size();
+			voiceLast[i] = size-1;
+			voiceRewind[i] = (loop && (gate==0.0f)) ? 1.0f : 0.0f;
+			voiceFilterType[i] = filterType;
+		}
+	}
+
+	for (int i=0;i<c;i+=4) {
+		float_4 active = float_4::load(voiceActive+i) > 0.0f;
+		float_4 in = simd::crossfade(float_4::load(voiceX0+i), float_4::load(voiceX1+i), float_4::load(voiceXf+i));
+		filters[i/4].calcOutput(in, active);
+
+		float_4 filterType = float_4::load(voiceFilterType+i);
+		float_4 out = simd::ifelse(filterType == 0.0f, in,
+			simd::ifelse(filterType == 1.0f, filters[i/4].lp,
+			simd::ifelse(filterType == 2.0f, filters[i/4].bp, filters[i/4].hp)));
+		outputs[POLY_OUTPUT].setVoltageSimd(simd::ifelse(active, 5.0f * out, 0.0f), i);
+
+		float_4 head = float_4::load(voiceHead+i);
+		head = simd::ifelse(active, head + float_4::load(voiceSpeed+i), head);
+		float_4 end = active & ((head >= float_4::load(voiceLast+i)) | (head > float_4::load(voiceEnd+i)));
+		float_4 rewind = float_4::load(voiceRewind+i) > 0.0f;
+		head = simd::ifelse(end & rewind, float_4::load(voiceStart+i), head);
+		active = simd::ifelse(end & ~rewind, 0.0f, active);
+		head.store(voiceHead+i);
+		simd::ifelse(active, 1.0f, 0.0f).store(voiceActive+i);
+	}
+
+	for (int i=0;i<c;i++) {
+		if (channels[i].playBuffer.size()>0) {
+			channels[i].head = voiceHead[i];
+			channels[i].active = voiceActive[i] > 0.0f;
 		}
 	}
 }
@@ -467,6 +494,14 @@ struct OAIWidget : BidooWidget {
 		assert(module);
 		menu->addChild(new MenuSeparator());
 		menu->addChild(construct<OAIItem>(&MenuItem::text, "Load sample", &OAIItem::module, module));
+		menu->addChild(createIndexSubmenuItem("Sample storage", {"Float 32", "Int 16", "Half float"},
+			[=]() {return module->storage;},
+			[=](int index) {
+				module->storage = index;
+				module->keepSource = index == waves::STORAGE_FLOAT;
+				module->reloading = true;
+			}));
+		menu->addChild(createBoolPtrMenuItem("Keep source for sample rate changes", "", &module->keepSource));
 	}
 };
 
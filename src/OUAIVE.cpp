@@ -40,31 +40,38 @@ struct OUAIVE : BidooModule {
 		NUM_LIGHTS
 	};
 
-	bool play = false;
 	int channels;
   int sampleRate;
   int totalSampleCount=0;
-	float samplePos = 0.0f;
-	vector<dsp::Frame<2>> playBuffer;
+	// voice state in float_4 lanes, voice v lives in lane v%4 of group v/4
+	int polyphony = 1;
+	int nbVoices = 1;
+	float_4 voicePos[4] = {};
+	float_4 voiceSlice[4] = {};
+	float_4 voiceActive[4] = {};
+	int voiceChannel[16] = {};
+	unsigned int voiceAge[16] = {};
+	unsigned int voiceCounter = 0;
+	waves::StereoSample playBuffer;
 	std::string lastPath;
 	std::string waveFileName;
 	std::string waveExtension;
 	bool loading = false;
+	int storage = waves::STORAGE_FLOAT;
+	bool keepSource = true;
 	int trigMode = 0; // 0 trig 1 gate, 2 sliced
 	int sliceIndex = -1;
 	int sliceLength = 0;
 	int nbSlices = 1;
 	int readMode = 0; // 0 formward, 1 backward, 2 repeat
 	float speed;
-	dsp::SchmittTrigger playTrigger;
+	dsp::SchmittTrigger playTriggers[16];
 	dsp::SchmittTrigger trigModeTrigger;
 	dsp::SchmittTrigger readModeTrigger;
 	dsp::SchmittTrigger posResetTrigger;
 	std::mutex mylock;
 	bool first = true;
-	int eoc=0;
-	bool pulse = false;
-	dsp::PulseGenerator eocPulse;
+	dsp::PulseGenerator eocPulses[16];
 
 	OUAIVE() {
     config(NUM_PARAMS, NUM_INPUTS, NUM_OUTPUTS, NUM_LIGHTS);
@@ -75,23 +82,32 @@ struct OUAIVE : BidooModule {
 		configParam(SPEED_PARAM, -0.05, 10, 1.0);
 		configParam(CVSPEED_PARAM, -1.0f, 1.0f, 0.0f);
 
-		playBuffer.resize(0);
+		playBuffer.clear();
 	}
 
 	void process(const ProcessArgs &args) override;
 
 	void loadSample();
+	int allocateVoice();
+	void startVoice(int channel);
 
 	json_t *dataToJson() override {
 		json_t *rootJ = BidooModule::dataToJson();
 		json_object_set_new(rootJ, "lastPath", json_string(lastPath.c_str()));
 		json_object_set_new(rootJ, "trigMode", json_integer(trigMode));
 		json_object_set_new(rootJ, "readMode", json_integer(readMode));
+		json_object_set_new(rootJ, "storage", json_integer(storage));
+		json_object_set_new(rootJ, "keepSource", json_boolean(keepSource));
+		json_object_set_new(rootJ, "polyphony", json_integer(polyphony));
 		return rootJ;
 	}
 
 	void dataFromJson(json_t *rootJ) override {
 		BidooModule::dataFromJson(rootJ);
+		json_t *storageJ = json_object_get(rootJ, "storage");
+		if (storageJ) storage = json_integer_value(storageJ);
+		json_t *keepSourceJ = json_object_get(rootJ, "keepSource");
+		keepSource = keepSourceJ ? json_is_true(keepSourceJ) : storage == waves::STORAGE_FLOAT;
 		json_t *lastPathJ = json_object_get(rootJ, "lastPath");
 		if (lastPathJ) {
 			lastPath = json_string_value(lastPathJ);
@@ -105,6 +121,10 @@ struct OUAIVE : BidooModule {
 		if (readModeJ) {
 			readMode = json_integer_value(readModeJ);
 		}
+		json_t *polyphonyJ = json_object_get(rootJ, "polyphony");
+		if (polyphonyJ) {
+			polyphony = clamp((int)json_integer_value(polyphonyJ), 1, 16);
+		}
 	}
 
 	void onSampleRateChange() override {
@@ -115,12 +135,50 @@ struct OUAIVE : BidooModule {
 void OUAIVE::loadSample() {
 	APP->engine->yieldWorkers();
 	mylock.lock();
-	playBuffer = waves::getStereoWav(lastPath, APP->engine->getSampleRate(), waveFileName, waveExtension, channels, sampleRate, totalSampleCount);
+	playBuffer = waves::acquireStereoWav(lastPath, APP->engine->getSampleRate(), waveFileName, waveExtension, channels, sampleRate, totalSampleCount, storage, keepSource);
 	mylock.unlock();
 	loading = false;
 }
 
+// Free voice first, otherwise the oldest one is stolen.
+int OUAIVE::allocateVoice() {
+	int oldest = 0;
+	for (int v = 0; v < polyphony; v++) {
+		if (voiceActive[v/4][v%4] == 0.0f) return v;
+		if (voiceAge[v] < voiceAge[oldest]) oldest = v;
+	}
+	return oldest;
+}
+
+void OUAIVE::startVoice(int channel) {
+	int v = allocateVoice();
+	int g = v/4, l = v%4;
+	voiceChannel[v] = channel;
+	voiceAge[v] = ++voiceCounter;
+	voiceActive[g][l] = 1.0f;
+	float pos = inputs[POS_INPUT].getPolyVoltage(channel);
+	if (trigMode == 0) {
+		voiceSlice[g][l] = -1.0f;
+		if (inputs[POS_INPUT].isConnected())
+			voicePos[g][l] = clamp(pos * (totalSampleCount-1.0f) * 0.1f, 0.0f , totalSampleCount - 1.0f);
+		else
+			voicePos[g][l] = (readMode != 1) ? 0.0f : (totalSampleCount - 1.0f);
+	}
+	else {
+		if (inputs[POS_INPUT].isConnected())
+			sliceIndex = clamp((int)(pos * nbSlices * 0.1f), 0, nbSlices);
+		else
+			sliceIndex = (sliceIndex+1)%nbSlices;
+		voiceSlice[g][l] = sliceIndex;
+		if (readMode != 1)
+			voicePos[g][l] = clamp(sliceIndex*sliceLength, 0, totalSampleCount-1);
+		else
+			voicePos[g][l] = clamp((sliceIndex + 1) * sliceLength - 1, 0 , totalSampleCount-1);
+	}
+}
+
 void OUAIVE::process(const ProcessArgs &args) {
+	ProfileScope profile(this, args);
 	if (loading) {
 		loadSample();
 	}
@@ -137,109 +195,107 @@ void OUAIVE::process(const ProcessArgs &args) {
 
 	sliceLength = clamp(totalSampleCount / nbSlices, 1, totalSampleCount);
 
-	if ((trigMode == 0) && (playTrigger.process(inputs[GATE_INPUT].getVoltage()))) {
-		play = true;
-		if (inputs[POS_INPUT].isConnected())
-			samplePos = clamp(inputs[POS_INPUT].getVoltage() * (totalSampleCount-1.0f) * 0.1f, 0.0f , totalSampleCount - 1.0f);
-		else {
-			if (readMode != 1)
-				samplePos = 0.0f;
-			else
-				samplePos = totalSampleCount - 1.0f;
+	int gateChannels = std::max(1, inputs[GATE_INPUT].getChannels());
+	// gate mode scrubs one voice per gate channel, the other modes allocate from the pool
+	nbVoices = (trigMode == 1) ? gateChannels : polyphony;
+
+	float_4 wasActive[4];
+	for (int g = 0; g < 4; g++) wasActive[g] = voiceActive[g];
+
+	if (trigMode == 1) {
+		for (int v = 0; v < 16; v++) {
+			bool gate = (v < gateChannels) && (inputs[GATE_INPUT].getVoltage(v) > 0);
+			voiceActive[v/4][v%4] = gate ? 1.0f : 0.0f;
+			voiceSlice[v/4][v%4] = -1.0f;
+			voicePos[v/4][v%4] = clamp(inputs[POS_INPUT].getPolyVoltage(v) * (totalSampleCount-1.0f) * 0.1f, 0.0f , totalSampleCount - 1.0f);
 		}
-	}	else if (trigMode == 1) {
-		play = (inputs[GATE_INPUT].getVoltage() > 0);
-		samplePos = clamp(inputs[POS_INPUT].getVoltage() * (totalSampleCount-1.0f) * 0.1f, 0.0f , totalSampleCount - 1.0f);
-	} else if ((trigMode == 2) && (playTrigger.process(inputs[GATE_INPUT].getVoltage()))) {
-		play = true;
-		if (inputs[POS_INPUT].isConnected())
-			sliceIndex = clamp((int)(inputs[POS_INPUT].getVoltage() * nbSlices * 0.1f), 0, nbSlices);
-		 else
-			sliceIndex = (sliceIndex+1)%nbSlices;
-		if (readMode != 1)
-			samplePos = clamp(sliceIndex*sliceLength, 0, totalSampleCount-1);
-		else
-			samplePos = clamp((sliceIndex + 1) * sliceLength - 1, 0 , totalSampleCount-1);
+	}
+	else {
+		for (int c = 0; c < gateChannels; c++) {
+			if (playTriggers[c].process(inputs[GATE_INPUT].getVoltage(c))) startVoice(c);
+		}
+		for (int v = nbVoices; v < 16; v++) voiceActive[v/4][v%4] = 0.0f;
 	}
 
 	if (posResetTrigger.process(inputs[POS_RESET_INPUT].getVoltage())) {
 		sliceIndex = 0;
-		samplePos = 0.0f;
+		for (int g = 0; g < 4; g++) voicePos[g] = 0.0f;
 	}
 
-	if (play && (samplePos>=0) && (samplePos < totalSampleCount)) {
+	bool stereo = (channels == 2) && outputs[OUTL_OUTPUT].isConnected() && outputs[OUTR_OUTPUT].isConnected();
+	float total = totalSampleCount;
+	float direction = (readMode != 1) ? speed : -speed;
+	int nbGroups = (nbVoices + 3) / 4;
+
+	for (int g = 0; g < nbGroups; g++) {
+		float_4 inRange = (voiceActive[g] > 0.0f) & (voicePos[g] >= 0.0f) & (voicePos[g] < total);
+		int mask = simd::movemask(inRange);
+
+		// gather the two frames around each head, then interpolate all lanes at once
+		float_4 xf = voicePos[g] - simd::floor(voicePos[g]);
+		float_4 l0 = 0.0f, l1 = 0.0f, r0 = 0.0f, r1 = 0.0f;
+		for (int l = 0; l < 4; l++) {
+			if (!(mask & (1 << l))) continue;
+			int xi = voicePos[g][l];
+			dsp::Frame<2> f0 = playBuffer[xi];
+			dsp::Frame<2> f1 = playBuffer[min(xi + 1, totalSampleCount - 1)];
+			l0[l] = f0.samples[0];
+			l1[l] = f1.samples[0];
+			r0[l] = f0.samples[1];
+			r1[l] = f1.samples[1];
+		}
+		float_4 left = l0 + (l1 - l0) * xf;
+		float_4 right = r0 + (r1 - r0) * xf;
 		if (channels == 1) {
-			int xi = samplePos;
-			float xf = samplePos - xi;
-			float crossfaded = crossfade(playBuffer[xi].samples[0], playBuffer[min(xi + 1,(int)totalSampleCount-1)].samples[0], xf);
-			outputs[OUTL_OUTPUT].setVoltage(5.0f * crossfaded);
-			outputs[OUTR_OUTPUT].setVoltage(5.0f * crossfaded);
+			right = left;
+		}
+		else if (!stereo) {
+			left = 0.5f * (left + right);
+			right = left;
 		}
-		else if (channels == 2) {
-			if (outputs[OUTL_OUTPUT].isConnected() && outputs[OUTR_OUTPUT].isConnected()) {
-				int xi = samplePos;
-				float xf = samplePos - xi;
-				float crossfaded = crossfade(playBuffer[xi].samples[0], playBuffer[min(xi + 1,(int)totalSampleCount-1)].samples[0], xf);
-				outputs[OUTL_OUTPUT].setVoltage(5.0f * crossfaded);
-				crossfaded = crossfade(playBuffer[xi].samples[1], playBuffer[min(xi + 1,(int)totalSampleCount-1)].samples[1], xf);
-				outputs[OUTR_OUTPUT].setVoltage(5.0f * crossfaded);
+		outputs[OUTL_OUTPUT].setVoltageSimd(simd::ifelse(inRange, 5.0f * left, float_4(0.0f)), g*4);
+		outputs[OUTR_OUTPUT].setVoltageSimd(simd::ifelse(inRange, 5.0f * right, float_4(0.0f)), g*4);
+
+		if (trigMode != 1) {
+			float_4 sliced = voiceSlice[g] >= 0.0f;
+			float_4 start = simd::ifelse(sliced, voiceSlice[g] * (float)sliceLength, float_4(0.0f));
+			float_4 end = simd::ifelse(sliced, simd::fmin((voiceSlice[g] + 1.0f) * (float)sliceLength, float_4(total)), float_4(total));
+			float_4 pos = simd::ifelse(inRange, voicePos[g] + direction, voicePos[g]);
+			float_4 active = simd::ifelse(inRange, float_4(1.0f), float_4(0.0f));
+			if (readMode == 0) {
+				active = simd::ifelse(pos >= end, float_4(0.0f), active);
+			}
+			else if (readMode == 1) {
+				active = simd::ifelse((pos <= start) | (pos <= 0.0f), float_4(0.0f), active);
 			}
 			else {
-				int xi = samplePos;
-				float xf = samplePos - xi;
-				float crossfaded = crossfade(0.5f*(playBuffer[xi].samples[0]+playBuffer[xi].samples[1]), 0.5f*(playBuffer[min(xi + 1,(int)totalSampleCount-1)].samples[0]+playBuffer[min(xi + 1,(int)totalSampleCount-1)].samples[1]), xf);
-				outputs[OUTL_OUTPUT].setVoltage(5.0f * crossfaded);
-				outputs[OUTR_OUTPUT].setVoltage(5.0f * crossfaded);
+				float_4 wrap = inRange & (pos >= end);
+				int wrapMask = simd::movemask(wrap);
+				if (wrapMask) {
+					float_4 restart = start;
+					for (int l = 0; l < 4; l++) {
+						if ((wrapMask & (1 << l)) && (voiceSlice[g][l] < 0.0f))
+							restart[l] = clamp(inputs[POS_INPUT].getPolyVoltage(voiceChannel[g*4+l]) * (total-1.0f) * 0.1f, 0.0f, total - 1.0f);
+					}
+					pos = simd::ifelse(wrap, restart, pos);
+				}
 			}
+			voicePos[g] = pos;
+			voiceActive[g] = active;
 		}
-
-		if (trigMode == 0) {
-			if (readMode != 1)
-				samplePos = samplePos + speed;
-			else
-				samplePos = samplePos - speed;
-			//manage eof readMode
-			if ((readMode == 0) && (samplePos >= totalSampleCount))
-					play = false;
-			else if ((readMode == 1) && (samplePos <=0))
-					play = false;
-			else if ((readMode == 2) && (samplePos >= totalSampleCount))
-				samplePos = clamp(inputs[POS_INPUT].getVoltage() * (totalSampleCount-1.0f) * 0.1f , 0.0f ,totalSampleCount - 1.0f);
-		}
-		else if (trigMode == 2)
-		{
-			if (readMode != 1)
-				samplePos = samplePos + speed;
-			else
-				samplePos = samplePos - speed;
-
-			//manage eof readMode
-			if ((readMode == 0) && ((samplePos >= (sliceIndex+1) * sliceLength) || (samplePos >= totalSampleCount)))
-					play = false;
-			if ((readMode == 1) && ((samplePos <= (sliceIndex) * sliceLength) || (samplePos <= 0)))
-					play = false;
-			if ((readMode == 2) && ((samplePos >= (sliceIndex+1) * sliceLength) || (samplePos >= totalSampleCount)))
-				samplePos = clamp(sliceIndex*sliceLength, 0 , totalSampleCount);
-		}
-	}
-	else if (samplePos == totalSampleCount) {
-		play = false;
 	}
 
-	if ((eoc == 0) && (play)) {
-		eoc = 1;
-	}
-
-	if ((eoc == 1) && (!play)) {
-		eoc = 0;
-		eocPulse.reset();
-		eocPulse.trigger(1e-3f);
+	for (int v = 0; v < nbVoices; v++) {
+		if ((wasActive[v/4][v%4] > 0.0f) && (voiceActive[v/4][v%4] == 0.0f)) {
+			eocPulses[v].reset();
+			eocPulses[v].trigger(1e-3f);
+		}
+		outputs[EOC_OUTPUT].setVoltage(eocPulses[v].process(args.sampleTime) ? 10 : 0, v);
 	}
 
-	pulse = eocPulse.process(args.sampleTime);
-
-	outputs[EOC_OUTPUT].setVoltage(pulse ? 10 : 0);
-
+	outputs[OUTL_OUTPUT].setChannels(nbVoices);
+	outputs[OUTR_OUTPUT].setChannels(nbVoices);
+	outputs[EOC_OUTPUT].setChannels(nbVoices);
 }
 
 struct OUAIVEDisplay : OpaqueWidget {
@@ -330,20 +386,16 @@ struct OUAIVEDisplay : OpaqueWidget {
 
 				nvgTextBox(args.vg, 90, -15, 40, speed.c_str(), NULL);
 
-				//Draw play line
-				if ((module->play) && (nbSample>0)) {
+				//Draw play lines
+				for (int v = 0; (v < module->nbVoices) && (nbSample>0); v++) {
+					if (module->voiceActive[v/4][v%4] == 0.0f) continue;
+					float samplePos = module->voicePos[v/4][v%4];
 					nvgStrokeColor(args.vg, LIGHTBLUE_BIDOO);
 					{
 						nvgBeginPath(args.vg);
 						nvgStrokeWidth(args.vg, 2);
-						if (module->totalSampleCount>0) {
-							nvgMoveTo(args.vg, module->samplePos * zoomWidth / nbSample + zoomLeftAnchor, 0);
-							nvgLineTo(args.vg, module->samplePos * zoomWidth / nbSample + zoomLeftAnchor, 2 * height+10);
-						}
-						else {
-							nvgMoveTo(args.vg, 0, 0);
-							nvgLineTo(args.vg, 0, 2 * height+10);
-						}
+						nvgMoveTo(args.vg, samplePos * zoomWidth / nbSample + zoomLeftAnchor, 0);
+						nvgLineTo(args.vg, samplePos * zoomWidth / nbSample + zoomLeftAnchor, 2 * height+10);
 						nvgClosePath(args.vg);
 					}
 					nvgStroke(args.vg);
@@ -494,7 +546,6 @@ struct OUAIVEWidget : BidooWidget {
   		std::string dir = module->lastPath.empty() ? asset::user("") : rack::system::getDirectory(module->lastPath);
   		char *path = osdialog_file(OSDIALOG_OPEN, dir.c_str(), NULL, NULL);
   		if (path) {
-  			module->samplePos = 0;
   			module->lastPath = path;
   			module->sliceIndex = -1;
 				module->loading=true;
@@ -510,12 +561,22 @@ struct OUAIVEWidget : BidooWidget {
 
 		menu->addChild(new MenuSeparator());
 		menu->addChild(construct<OUAIVEItem>(&MenuItem::text, "Load sample", &OUAIVEItem::module, module));
+		menu->addChild(createIndexSubmenuItem("Sample storage", {"Float 32", "Int 16", "Half float"},
+			[=]() {return module->storage;},
+			[=](int index) {
+				module->storage = index;
+				module->keepSource = index == waves::STORAGE_FLOAT;
+				module->loading = !module->lastPath.empty();
+			}));
+		menu->addChild(createBoolPtrMenuItem("Keep source for sample rate changes", "", &module->keepSource));
+		menu->addChild(createIndexSubmenuItem("Polyphony", {"1", "2", "3", "4", "5", "6", "7", "8", "9", "10", "11", "12", "13", "14", "15", "16"},
+			[=]() {return module->polyphony - 1;},
+			[=](int index) {module->polyphony = index + 1;}));
 	}
 
 	void onPathDrop(const PathDropEvent& e) override {
 		Widget::onPathDrop(e);
 		OUAIVE *module = dynamic_cast<OUAIVE*>(this->module);
-		module->samplePos = 0;
 		module->lastPath = e.paths[0];
 		module->sliceIndex = -1;
 		module->loading=true;
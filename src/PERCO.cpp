@@ -3,34 +3,10 @@
 #include "plugin.hpp"
 #include "BidooComponents.hpp"
 #include "dsp/resampler.hpp"
+#include "dep/filters/svf.hpp"
 
 using namespace std;
-
-#define pi 3.14159265359
-
-
-struct MultiFilter {
-	float q;
-	float freq;
-	float smpRate;
-	float hp = 0.0f, bp = 0.0f, lp = 0.0f, mem1 = 0.0f, mem2 = 0.0f;
-
-	void setParams(float freq, float q, float smpRate) {
-		this->freq = freq;
-		this->q = q;
-		this->smpRate = smpRate;
-	}
-
-	void calcOutput(float sample) {
-		float g = tan(pi*freq / smpRate);
-		float R = 1.0f / (2.0f*q);
-		hp = (sample - (2.0f*R + g)*mem1 - mem2) / (1.0f + 2.0f * R * g + g * g);
-		bp = g * hp + mem1;
-		lp = g * bp + mem2;
-		mem1 = g * hp + bp;
-		mem2 = g * bp + lp;
-	}
-};
+using simd::float_4;
 
 struct PERCO : BidooModule {
 	enum ParamIds {
@@ -56,7 +32,10 @@ struct PERCO : BidooModule {
 		NUM_LIGHTS
 	};
 
-	MultiFilter filter;
+	svf::MultiFilter4 filters[4];
+	// cutoff and Q last handed to each lane
+	float laneCutoff[16] = {};
+	float laneQ[16] = {};
 
 	PERCO() {
 		config(NUM_PARAMS, NUM_INPUTS, NUM_OUTPUTS, NUM_LIGHTS);
@@ -66,23 +45,38 @@ struct PERCO : BidooModule {
 	}
 
 	void process(const ProcessArgs &args) override {
+		ProfileScope profile(this, args);
+		int channels = std::max(inputs[IN].getChannels(), 1);
 
 		float freqCvParam = params[CMOD_PARAM].getValue();
 		freqCvParam = dsp::quadraticBipolar(freqCvParam);
 		float freqParam = params[CUTOFF_PARAM].getValue();
 		freqParam = freqParam * 10.f - 5.f;
 
-		float pitch = freqParam + inputs[CUTOFF_INPUT].getVoltage() * freqCvParam;
-		float cutoff = dsp::FREQ_C4 * std::pow(2.f, pitch);
-		cutoff = clamp(cutoff, 1.f, 8000.f);
-
-		float q = 10.0f * clamp(params[Q_PARAM].getValue() + inputs[Q_INPUT].getVoltage() * 0.2f, 0.1f, 1.0f);
-		filter.setParams(cutoff, q, args.sampleRate);
-		float in = inputs[IN].getVoltage() * 0.2f;
-		filter.calcOutput(in);
-		outputs[OUT_LP].setVoltage(filter.lp * 5.0f);
-		outputs[OUT_HP].setVoltage(filter.hp * 5.0f);
-		outputs[OUT_BP].setVoltage(filter.bp * 5.0f);
+		for (int c=0; c<channels; c+=4) {
+			svf::MultiFilter4 &filter = filters[c/4];
+			// 1Hz..8kHz, approxExp2 wants a positive argument
+			float_4 pitch = simd::clamp(freqParam + inputs[CUTOFF_INPUT].getPolyVoltageSimd<float_4>(c) * freqCvParam, -8.f, 5.f);
+			float_4 cutoff = simd::clamp(dsp::FREQ_C4 * dsp::approxExp2_taylor5(pitch + 10.f) / 1024.f, 1.f, 8000.f);
+			float_4 q = 10.0f * simd::clamp(params[Q_PARAM].getValue() + inputs[Q_INPUT].getPolyVoltageSimd<float_4>(c) * 0.2f, 0.1f, 1.0f);
+
+			// only retune a lane when it moved by more than ~2 cents or 0.01 of Q
+			for (int l=0; l<4; l++) {
+				if ((std::fabs(cutoff[l] - laneCutoff[c+l]) > 1e-3f * laneCutoff[c+l]) || (std::fabs(q[l] - laneQ[c+l]) > 1e-2f) || (args.sampleRate != filter.smpRate[l])) {
+					laneCutoff[c+l] = cutoff[l];
+					laneQ[c+l] = q[l];
+					filter.setParams(l, cutoff[l], q[l], args.sampleRate);
+				}
+			}
+
+			filter.calcOutput(inputs[IN].getVoltageSimd<float_4>(c) * 0.2f);
+			outputs[OUT_LP].setVoltageSimd(filter.lp * 5.0f, c);
+			outputs[OUT_HP].setVoltageSimd(filter.hp * 5.0f, c);
+			outputs[OUT_BP].setVoltageSimd(filter.bp * 5.0f, c);
+		}
+		outputs[OUT_LP].setChannels(channels);
+		outputs[OUT_HP].setChannels(channels);
+		outputs[OUT_BP].setChannels(channels);
 	}
 
 };
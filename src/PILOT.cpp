@@ -368,6 +368,7 @@ struct PILOT : BidooModule {
 };
 
 void PILOT::process(const ProcessArgs &args) {
+	ProfileScope profile(this, args);
 	changeDir =false;
 	oldTopScene = topScene;
 	oldBottomScene = bottomScene;
@@ -52,10 +52,12 @@ struct POUPRE : BidooModule {
 	dsp::SchmittTrigger triggers[16];
 	bool active[16]={false};
 	bool loading=false;
+	int storage = waves::STORAGE_FLOAT;
+	bool keepSource = true;
 	int sampleChannels;
 	int sampleRate;
 	int totalSampleCount;
-	vector<dsp::Frame<1>> playBuffer;
+	waves::MonoSample playBuffer;
 	bool play = false;
 	std::string lastPath;
 	std::string waveFileName;
@@ -76,7 +78,7 @@ struct POUPRE : BidooModule {
 		configParam(PRESET_PARAM+2, 0.0f, 1.0f, 0.0f);
 		configParam(PRESET_PARAM+3, 0.0f, 1.0f, 0.0f);
 
-		playBuffer.resize(0);
+		playBuffer.clear();
 	}
 
 	void process(const ProcessArgs &args) override;
@@ -88,6 +90,8 @@ struct POUPRE : BidooModule {
 		json_t *rootJ = BidooModule::dataToJson();
 		json_object_set_new(rootJ, "lastPath", json_string(lastPath.c_str()));
 		json_object_set_new(rootJ, "currentChannel", json_integer(currentChannel));
+		json_object_set_new(rootJ, "storage", json_integer(storage));
+		json_object_set_new(rootJ, "keepSource", json_boolean(keepSource));
 		for (size_t i = 0; i<16 ; i++) {
 			json_t *channelJ = json_object();
 			json_object_set_new(channelJ, "start", json_real(channels[i].start));
@@ -102,6 +106,10 @@ struct POUPRE : BidooModule {
 
 	void dataFromJson(json_t *rootJ) override {
 		BidooModule::dataFromJson(rootJ);
+		json_t *storageJ = json_object_get(rootJ, "storage");
+		if (storageJ) storage = json_integer_value(storageJ);
+		json_t *keepSourceJ = json_object_get(rootJ, "keepSource");
+		keepSource = keepSourceJ ? json_is_true(keepSourceJ) : storage == waves::STORAGE_FLOAT;
 		json_t *lastPathJ = json_object_get(rootJ, "lastPath");
 		json_t *currentChannelJ = json_object_get(rootJ, "currentChannel");
 		if (currentChannelJ) {
@@ -147,11 +155,12 @@ struct POUPRE : BidooModule {
 
 void POUPRE::loadSample() {
 	APP->engine->yieldWorkers();
-	playBuffer = waves::getMonoWav(lastPath, APP->engine->getSampleRate(), waveFileName, waveExtension, sampleChannels, sampleRate, totalSampleCount);
+	playBuffer = waves::acquireMonoWav(lastPath, APP->engine->getSampleRate(), waveFileName, waveExtension, sampleChannels, sampleRate, totalSampleCount, storage, keepSource);
 	loading = false;
 }
 
 void POUPRE::process(const ProcessArgs &args) {
+	ProfileScope profile(this, args);
 	mylock.lock();
 	if (loading) {
 		loadSample();
@@ -341,6 +350,14 @@ struct POUPREWidget : BidooWidget {
 		assert(module);
 		menu->addChild(new MenuSeparator());
 		menu->addChild(construct<POUPREItem>(&MenuItem::text, "Load sample", &POUPREItem::module, module));
+		menu->addChild(createIndexSubmenuItem("Sample storage", {"Float 32", "Int 16", "Half float"},
+			[=]() {return module->storage;},
+			[=](int index) {
+				module->storage = index;
+				module->keepSource = index == waves::STORAGE_FLOAT;
+				module->loading = !module->lastPath.empty();
+			}));
+		menu->addChild(createBoolPtrMenuItem("Keep source for sample rate changes", "", &module->keepSource));
 	}
 };
 
@@ -66,6 +66,7 @@ struct RABBIT : BidooModule {
 	}
 
 	void process(const ProcessArgs &args) override {
+		ProfileScope profile(this, args);
 		float in_L = clamp(inputs[L_INPUT].getVoltage(), -10.0f, 10.0f);
 		float in_R = clamp(inputs[R_INPUT].getVoltage(), -10.0f, 10.0f);
 
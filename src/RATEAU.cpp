@@ -535,6 +535,7 @@ struct RATEAU : BidooModule {
 };
 
 void RATEAU::process(const ProcessArgs &args) {
+	ProfileScope profile(this, args);
 	int nBank = clamp(params[BANK_PARAM].getValue()+rescale(inputs[BANK_INPUT].getVoltage(),0.f,10.0f,0.0f,15.0f),0.0f,15.0f);
 
 	if (start) {
@@ -4,6 +4,7 @@
 #include "dep/freeverb/revmodel.hpp"
 #include "dep/filters/pitchshifter.h"
 #include "dsp/digital.hpp"
+#include "dep/fastmath.hpp"
 
 #define REIBUFF_SIZE 512
 
@@ -77,6 +78,7 @@ struct REI : BidooModule {
 	}
 
 	void process(const ProcessArgs &args) override {
+		ProfileScope profile(this, args);
 		float outL = 0.0f, outR = 0.0f;
 		float wOutL = 0.0f, wOutR = 0.0f;
 		float inL = 0.0f, inR = 0.0f;
@@ -108,8 +110,8 @@ struct REI : BidooModule {
 			outL = clamp(outL, -7.0f, 7.0f);
 			outR = clamp(outR, -7.0f, 7.0f);
 		} else {
-			outL = tanh(outL / 5.0f)*7.0f;
-			outR = tanh(outR / 5.0f)*7.0f;
+			outL = fastmath::tanh(outL / 5.0f)*7.0f;
+			outR = fastmath::tanh(outR / 5.0f)*7.0f;
 		}
 
 		in_Buffer.push((outL + outR)*0.05f);
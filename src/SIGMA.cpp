@@ -25,6 +25,7 @@ struct SIGMA : BidooModule {
 	}
 
 	void process(const ProcessArgs &args) override {
+		ProfileScope profile(this, args);
 		for (int i = 0; i < NUM_OUTPUTS; i++) {
 			outputs[i].setVoltage(inputs[3 * i].getVoltage() + inputs[3 * i + 1].getVoltage() + inputs[3 * i + 2].getVoltage());
 		}
@@ -208,6 +208,7 @@ struct SPORE : BidooModule {
 	}
 
 	void process(const ProcessArgs &args) override {
+		ProfileScope profile(this, args);
 
 		grainSize = clamp(params[GRAINSIZE_PARAM].getValue() + rescale(inputs[GRAINSIZE_INPUT].getVoltage(),0.0f,10.0f,100.0f,5000.0f),20.0f,(float)LongueurMax);
 		hopsizeAnalysis = clamp(params[HOPSIZEANALYSIS_PARAM].getValue() + rescale(inputs[HOPSIZEANALYSIS_INPUT].getVoltage(),0.0f,10.0f,0.0f,(float)LongueurMax*2.0f),10.0f,(float)LongueurMax*2.0f);
@@ -88,12 +88,10 @@ struct Oscillator {
 		phase += deltaPhase;
 		phase -= simd::floor(phase);
 
-		for (int i=0; i<channels; i++) {
-			if (phase[i] <= phaseDistX)
-					phaseDist[i] = phase[i] * phaseDistY / phaseDistX;
-				else
-					phaseDist[i] = phaseDistY + (phase[i]-phaseDistX) * (1.0f - phaseDistY) / (1.0f - phaseDistX);
-		}
+		// Two segment breakpoint mapping, both slopes are shared by every lane
+		float riseSlope = phaseDistY / phaseDistX;
+		float fallSlope = (1.0f - phaseDistY) / (1.0f - phaseDistX);
+		phaseDist = simd::ifelse(phase <= phaseDistX, phase * riseSlope, phaseDistY + (phase - phaseDistX) * fallSlope);
 
 		// Wrap phase
 		phaseDist -= simd::floor(phaseDist);
@@ -372,7 +370,10 @@ struct TIARE : BidooModule {
 	float phaseDist = 0.0f;
 	float phaseDistX = 0.5f, phaseDistY = 0.5f;
 	int freqFactor = 1;
+	int oversample = 1;
 	Oscillator<16, 16, float_4> oscillators[4];
+	dsp::Decimator<2, 8, float_4> decimators2[4][4];
+	dsp::Decimator<4, 8, float_4> decimators4[4][4];
 
 	TIARE() {
 		config(NUM_PARAMS, NUM_INPUTS, NUM_OUTPUTS, NUM_LIGHTS);
@@ -398,6 +399,7 @@ struct TIARE : BidooModule {
 		json_object_set_new(rootJ, "phaseDistX", json_real(phaseDistX));
 		json_object_set_new(rootJ, "phaseDistY", json_real(phaseDistY));
 		json_object_set_new(rootJ, "freqFactor", json_integer(freqFactor));
+		json_object_set_new(rootJ, "oversample", json_integer(oversample));
 		return rootJ;
 	}
 
@@ -415,6 +417,11 @@ struct TIARE : BidooModule {
 		if (freqFactorJ) {
 			freqFactor = json_integer_value(freqFactorJ);
 		}
+		json_t *oversampleJ = json_object_get(rootJ, "oversample");
+		if (oversampleJ) {
+			int value = json_integer_value(oversampleJ);
+			oversample = ((value == 2) || (value == 4)) ? value : 1;
+		}
 	}
 
 	void onRandomize() override {
@@ -436,6 +443,7 @@ struct TIARE : BidooModule {
 	}
 
 	void process(const ProcessArgs &args) override {
+		ProfileScope profile(this, args);
 		if (inputs[DIST_X_INPUT].isConnected())
 			phaseDistX = rescale(clamp(inputs[DIST_X_INPUT].getVoltage(), 0.0f, 10.0f), 0.0f, 10.0f, 0.01f, 0.98f);
 
@@ -463,17 +471,40 @@ struct TIARE : BidooModule {
 			oscillator->setPulseWidth(params[PW_PARAM].getValue() + params[PWM_PARAM].getValue() * inputs[PW_INPUT].getPolyVoltageSimd<float_4>(c) / 10.f);
 
 			oscillator->syncEnabled = inputs[SYNC_INPUT].isConnected();
-			oscillator->process(args.sampleTime, inputs[SYNC_INPUT].getPolyVoltageSimd<float_4>(c), phaseDistX, phaseDistY);
+
+			float_4 sync = inputs[SYNC_INPUT].getPolyVoltageSimd<float_4>(c);
+			float_4 out[4];
+			if (oversample > 1) {
+				// Run the oscillator at the higher rate and decimate each waveform
+				float_4 buffers[4][4];
+				for (int k = 0; k < oversample; k++) {
+					oscillator->process(args.sampleTime / oversample, sync, phaseDistX, phaseDistY);
+					buffers[0][k] = oscillator->sin();
+					buffers[1][k] = oscillator->tri();
+					buffers[2][k] = oscillator->saw();
+					buffers[3][k] = oscillator->sqr();
+				}
+				for (int w = 0; w < 4; w++) {
+					out[w] = (oversample == 2) ? decimators2[c / 4][w].process(buffers[w]) : decimators4[c / 4][w].process(buffers[w]);
+				}
+			}
+			else {
+				oscillator->process(args.sampleTime, sync, phaseDistX, phaseDistY);
+				out[0] = oscillator->sin();
+				out[1] = oscillator->tri();
+				out[2] = oscillator->saw();
+				out[3] = oscillator->sqr();
+			}
 
 			// Set output
 			if (outputs[SIN_OUTPUT].isConnected())
-				outputs[SIN_OUTPUT].setVoltageSimd(5.f * oscillator->sin(), c);
+				outputs[SIN_OUTPUT].setVoltageSimd(5.f * out[0], c);
 			if (outputs[TRI_OUTPUT].isConnected())
-				outputs[TRI_OUTPUT].setVoltageSimd(5.f * oscillator->tri(), c);
+				outputs[TRI_OUTPUT].setVoltageSimd(5.f * out[1], c);
 			if (outputs[SAW_OUTPUT].isConnected())
-				outputs[SAW_OUTPUT].setVoltageSimd(5.f * oscillator->saw(), c);
+				outputs[SAW_OUTPUT].setVoltageSimd(5.f * out[2], c);
 			if (outputs[SQR_OUTPUT].isConnected())
-				outputs[SQR_OUTPUT].setVoltageSimd(5.f * oscillator->sqr(), c);
+				outputs[SQR_OUTPUT].setVoltageSimd(5.f * out[3], c);
 		}
 
 		outputs[SIN_OUTPUT].setChannels(channels);
@@ -603,6 +634,11 @@ struct TIAREWidget : BidooWidget {
 		modeItem->rightText = dynamic_cast<TIARE*>(this->module)->freqFactor == 1 ? "OSC✔ LFO" : "OSC  LFO✔";
 		modeItem->module = dynamic_cast<TIARE*>(this->module);
 		menu->addChild(modeItem);
+
+		TIARE *module = dynamic_cast<TIARE*>(this->module);
+		menu->addChild(createIndexSubmenuItem("Oversampling", {"1x", "2x", "4x"},
+			[=]() {return module->oversample == 4 ? 2 : module->oversample - 1;},
+			[=](int index) {module->oversample = 1 << index;}));
 	}
 };
 
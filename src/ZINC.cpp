@@ -1,6 +1,7 @@
 #include "plugin.hpp"
 #include "BidooComponents.hpp"
 #include "dsp/resampler.hpp"
+#include "dep/fastmath.hpp"
 
 using namespace std;
 
@@ -30,8 +31,8 @@ protected:
 
 inline float_4 ZBiquad::process(float_4 in) {
     float_4 out = in * a0 + z1;
-    z1 = in * a1 + z2 - b1 * out;
-    z2 = in * a2 - b2 * out;
+    z1 = fastmath::flushDenormal(in * a1 + z2 - b1 * out);
+    z2 = fastmath::flushDenormal(in * a2 - b2 * out);
     return out;
 }
 
@@ -75,7 +76,7 @@ void ZBiquad::setBiquad(float_4 Fc, float_4 Q, float_4 peakGainDB) {
 
 void ZBiquad::calcBiquad(void) {
     float_4 norm;
-    float_4 K = tan(M_PI * Fc);
+    float_4 K = fastmath::tan((float)M_PI * Fc);
     norm = 1 / (1 + K / Q + K * K);
     a0 = K / Q * norm;
     a1 = 0;
@@ -153,6 +154,7 @@ struct ZINC : BidooModule {
 	}
 
 	void process(const ProcessArgs &args) override {
+		ProfileScope profile(this, args);
 		float inM = inputs[IN_MOD].getVoltage() / 5.0f;
 		float inC = inputs[IN_CARR].getVoltage() / 5.0f;
 		float attack = params[ATTACK_PARAM].getValue();
@@ -182,6 +184,7 @@ struct ZINC : BidooModule {
 				}
 			}
 			peaks[i] = peak;
+			coeff = fastmath::flushDenormal(coeff);
 			mem[i] = coeff;
 			cFilter[i]->setQ(q3);
 			cFilter[i + BANDS4]->setQ(q4);
@@ -8,6 +8,7 @@
 #include <iomanip>
 #include <sstream>
 #include "dep/quantizer.hpp"
+#include "dep/packedstate.hpp"
 
 using namespace std;
 
@@ -33,6 +34,9 @@ struct TrigAttibutes {
 	static const unsigned long TRIG_INCOUNT					= 0xFF000000; static const unsigned long trigInCountShift = 24;
 
 
+	static const unsigned long TRIG_PERSISTED_MAIN	= TRIG_ACTIVE | TRIG_TYPE | TRIG_INDEX | TRIG_PULSECOUNT | TRIG_OCTAVE | TRIG_SEMITONES;
+	static const unsigned long TRIG_PERSISTED_PROB	= TRIG_PROBA | TRIG_COUNT | TRIG_COUNTRESET;
+
 	static const unsigned long intiMainAttributes = 1576960;
 	static const unsigned long intiProbAttributes = 91136;
 
@@ -301,6 +305,25 @@ struct TrackAttibutes {
 	inline void setRefAttributes(const unsigned long _refAttributes) {refAttributes = _refAttributes;}
 };
 
+// Played trig of a track flattened for playback, rebuilt only when the trig,
+// its settings, the transposition or the quantizer change.
+struct TrigEvent {
+	int trig = -1;
+	bool dirty = true;
+	bool quantize = false;
+	float transpose = 0.0f;
+	float start = 0.0f;
+	float length = 0.0f;
+	float pulseDistance = 0.0f;
+	int pulseCount = 0;
+	float fullLength = 0.0f;
+	float vo = 0.0f;
+	float cv1 = 0.0f;
+	float cv2 = 0.0f;
+	float *slideCurve = NULL;
+	bool slideType = false;
+};
+
 struct ZOUMAI : BidooModule {
 	enum ParamIds {
 		STEPS_PARAMS,
@@ -432,8 +455,14 @@ struct ZOUMAI : BidooModule {
 	int rotLen[8] = {16,16,16,16,16,16,16,16};
 
 	bool solo = false;
+	bool compactStorage = false;
+	float lastParamValues[NUM_PARAMS];
+	dsp::ClockDivider paramDivider;
+	dsp::ClockDivider lightDivider;
+	static const int PATTERNS_VERSION = 1;
 
 	float powTable[100][10000] = {{0.0f}};
+	TrigEvent trackEvents[8];
 
   std::string labels[8] = {"Track 1","Track 2","Track 3","Track 4","Track 5","Track 6","Track 7","Track 8"};
 
@@ -443,6 +472,10 @@ struct ZOUMAI : BidooModule {
 		rightExpander.producerMessage = rightMessages[0];
 		rightExpander.consumerMessage = rightMessages[1];
 
+		for (int i=0; i<NUM_PARAMS; i++) lastParamValues[i] = NAN;
+		paramDivider.setDivision(32);
+		lightDivider.setDivision(512);
+
 		configParam(FILL_PARAM, 0.0f, 1.0f, 0.0f);
     configParam(RUN_PARAM, 0.0f, 1.0f, 0.0f);
 
@@ -546,31 +579,46 @@ struct ZOUMAI : BidooModule {
     array_cycle_left(_ptr, n, es, n - shift);
   }
 
+	void invalidateTrackEvents() {
+		for (int i=0; i<8; i++) trackEvents[i].dirty = true;
+	}
+
+	// Edits of another pattern are picked up when switching to it.
+	void invalidateTrackEvents(const int pattern, const int track) {
+		if (pattern == currentPattern) trackEvents[track].dirty = true;
+	}
+
+	// Set from the model on selection, which is not an edit.
+	void setEditParam(const int paramId, const float value) {
+		params[paramId].setValue(value);
+		lastParamValues[paramId] = value;
+	}
+
 	void updateTrackToParams() {
-		params[TRACKLENGTH_PARAM].setValue(nTracksAttibutes[currentPattern][currentTrack].getTrackLength());
-		params[TRACKSPEED_PARAM].setValue(nTracksAttibutes[currentPattern][currentTrack].getTrackSpeed());
-		params[TRACKREADMODE_PARAM].setValue(nTracksAttibutes[currentPattern][currentTrack].getTrackReadMode());
-		params[TRACKROOTNOTE_PARAM].setValue(rootNote[currentPattern][currentTrack]);
-		params[TRACKSCALE_PARAM].setValue(scale[currentPattern][currentTrack]);
-		params[TRACKQUANTIZECV1_PARAM].setValue(quantizeCV1[currentPattern][currentTrack]);
-		params[TRACKSCALE_PARAM].setValue(scale[currentPattern][currentTrack]);
-		params[TRACKROOTNOTE_PARAM].setValue(rootNote[currentPattern][currentTrack]);
-		params[TRACKQUANTIZECV1_PARAM].setValue(quantizeCV1[currentPattern][currentTrack]);
+		setEditParam(TRACKLENGTH_PARAM, nTracksAttibutes[currentPattern][currentTrack].getTrackLength());
+		setEditParam(TRACKSPEED_PARAM, nTracksAttibutes[currentPattern][currentTrack].getTrackSpeed());
+		setEditParam(TRACKREADMODE_PARAM, nTracksAttibutes[currentPattern][currentTrack].getTrackReadMode());
+		setEditParam(TRACKROOTNOTE_PARAM, rootNote[currentPattern][currentTrack]);
+		setEditParam(TRACKSCALE_PARAM, scale[currentPattern][currentTrack]);
+		setEditParam(TRACKQUANTIZECV1_PARAM, quantizeCV1[currentPattern][currentTrack]);
+		setEditParam(TRACKSCALE_PARAM, scale[currentPattern][currentTrack]);
+		setEditParam(TRACKROOTNOTE_PARAM, rootNote[currentPattern][currentTrack]);
+		setEditParam(TRACKQUANTIZECV1_PARAM, quantizeCV1[currentPattern][currentTrack]);
 	}
 
 	void updateTrigToParams() {
-		params[TRIGLENGTH_PARAM].setValue(trigLength[currentPattern][currentTrack][currentTrig]);
-		params[TRIGSLIDE_PARAM].setValue(trigSlide[currentPattern][currentTrack][currentTrig]);
-		params[TRIGTYPE_PARAM].setValue(nTrigsAttibutes[currentPattern][currentTrack][currentTrig].getTrigType());
-		params[TRIGTRIM_PARAM].setValue(trigTrim[currentPattern][currentTrack][currentTrig]);
-		params[TRIGPULSECOUNT_PARAM].setValue(nTrigsAttibutes[currentPattern][currentTrack][currentTrig].getTrigPulseCount());
-		params[TRIGPULSEDISTANCE_PARAM].setValue(trigPulseDistance[currentPattern][currentTrack][currentTrig]);
-		params[TRIGCV1_PARAM].setValue(trigCV1[currentPattern][currentTrack][currentTrig]);
-		params[TRIGCV2_PARAM].setValue(trigCV2[currentPattern][currentTrack][currentTrig]);
-		params[TRIGPROBA_PARAM].setValue(nTrigsAttibutes[currentPattern][currentTrack][currentTrig].getTrigProba());
-		params[TRIGPROBACOUNT_PARAM].setValue(nTrigsAttibutes[currentPattern][currentTrack][currentTrig].getTrigCount());
-		params[TRIGPROBACOUNTRESET_PARAM].setValue(nTrigsAttibutes[currentPattern][currentTrack][currentTrig].getTrigCountReset());
-    params[TRIGSLIDETYPE_PARAM].setValue(trigSlideType[currentPattern][currentTrack][currentTrig]);
+		setEditParam(TRIGLENGTH_PARAM, trigLength[currentPattern][currentTrack][currentTrig]);
+		setEditParam(TRIGSLIDE_PARAM, trigSlide[currentPattern][currentTrack][currentTrig]);
+		setEditParam(TRIGTYPE_PARAM, nTrigsAttibutes[currentPattern][currentTrack][currentTrig].getTrigType());
+		setEditParam(TRIGTRIM_PARAM, trigTrim[currentPattern][currentTrack][currentTrig]);
+		setEditParam(TRIGPULSECOUNT_PARAM, nTrigsAttibutes[currentPattern][currentTrack][currentTrig].getTrigPulseCount());
+		setEditParam(TRIGPULSEDISTANCE_PARAM, trigPulseDistance[currentPattern][currentTrack][currentTrig]);
+		setEditParam(TRIGCV1_PARAM, trigCV1[currentPattern][currentTrack][currentTrig]);
+		setEditParam(TRIGCV2_PARAM, trigCV2[currentPattern][currentTrack][currentTrig]);
+		setEditParam(TRIGPROBA_PARAM, nTrigsAttibutes[currentPattern][currentTrack][currentTrig].getTrigProba());
+		setEditParam(TRIGPROBACOUNT_PARAM, nTrigsAttibutes[currentPattern][currentTrack][currentTrig].getTrigCount());
+		setEditParam(TRIGPROBACOUNTRESET_PARAM, nTrigsAttibutes[currentPattern][currentTrack][currentTrig].getTrigCountReset());
+    setEditParam(TRIGSLIDETYPE_PARAM, trigSlideType[currentPattern][currentTrack][currentTrig]);
 	}
 
 	void updateTrigVO() {
@@ -597,31 +645,46 @@ struct ZOUMAI : BidooModule {
 		}
 	}
 
+	// True once per knob movement, so the model is only written when a param really changed.
+	// Every synced param edits the current track or trig.
+	bool paramMoved(const int paramId) {
+		float value = params[paramId].getValue();
+		if (value == lastParamValues[paramId]) return false;
+		lastParamValues[paramId] = value;
+		invalidateTrackEvents(currentPattern, currentTrack);
+		return true;
+	}
+
 	void updateParamsToTrack() {
-		nTracksAttibutes[currentPattern][currentTrack].setTrackLength(params[TRACKLENGTH_PARAM].getValue());
-		nTracksAttibutes[currentPattern][currentTrack].setTrackSpeed(params[TRACKSPEED_PARAM].getValue());
-		nTracksAttibutes[currentPattern][currentTrack].setTrackReadMode(params[TRACKREADMODE_PARAM].getValue());
-		rootNote[currentPattern][currentTrack]=params[TRACKROOTNOTE_PARAM].getValue();
-		scale[currentPattern][currentTrack]=params[TRACKSCALE_PARAM].getValue();
-		quantizeCV1[currentPattern][currentTrack]=params[TRACKQUANTIZECV1_PARAM].getValue();
+		if (paramMoved(TRACKLENGTH_PARAM)) nTracksAttibutes[currentPattern][currentTrack].setTrackLength(params[TRACKLENGTH_PARAM].getValue());
+		if (paramMoved(TRACKSPEED_PARAM)) nTracksAttibutes[currentPattern][currentTrack].setTrackSpeed(params[TRACKSPEED_PARAM].getValue());
+		if (paramMoved(TRACKREADMODE_PARAM)) nTracksAttibutes[currentPattern][currentTrack].setTrackReadMode(params[TRACKREADMODE_PARAM].getValue());
+		if (paramMoved(TRACKROOTNOTE_PARAM)) rootNote[currentPattern][currentTrack]=params[TRACKROOTNOTE_PARAM].getValue();
+		if (paramMoved(TRACKSCALE_PARAM)) scale[currentPattern][currentTrack]=params[TRACKSCALE_PARAM].getValue();
+		if (paramMoved(TRACKQUANTIZECV1_PARAM)) quantizeCV1[currentPattern][currentTrack]=params[TRACKQUANTIZECV1_PARAM].getValue();
 	}
 
 	void updateParamsToTrig() {
-		trigLength[currentPattern][currentTrack][currentTrig] = params[TRIGLENGTH_PARAM].getValue();
-    trigSlideType[currentPattern][currentTrack][currentTrig] = params[TRIGSLIDETYPE_PARAM].getValue();
-		trigSlide[currentPattern][currentTrack][currentTrig] =  params[TRIGSLIDE_PARAM].getValue();
-		nTrigsAttibutes[currentPattern][currentTrack][currentTrig].setTrigType(params[TRIGTYPE_PARAM].getValue());
-		trigTrim[currentPattern][currentTrack][currentTrig] =  params[TRIGTRIM_PARAM].getValue();
-		nTrigsAttibutes[currentPattern][currentTrack][currentTrig].setTrigPulseCount(params[TRIGPULSECOUNT_PARAM].getValue());
-		trigPulseDistance[currentPattern][currentTrack][currentTrig] = params[TRIGPULSEDISTANCE_PARAM].getValue();
-		trigCV1[currentPattern][currentTrack][currentTrig] = params[TRIGCV1_PARAM].getValue();
-		trigCV2[currentPattern][currentTrack][currentTrig] = params[TRIGCV2_PARAM].getValue();
-		nTrigsAttibutes[currentPattern][currentTrack][currentTrig].setTrigProba(params[TRIGPROBA_PARAM].getValue());
-		nTrigsAttibutes[currentPattern][currentTrack][currentTrig].setTrigCount(params[TRIGPROBACOUNT_PARAM].getValue());
-		nTrigsAttibutes[currentPattern][currentTrack][currentTrig].setTrigCountReset(params[TRIGPROBACOUNTRESET_PARAM].getValue());
+		if (paramMoved(TRIGLENGTH_PARAM)) trigLength[currentPattern][currentTrack][currentTrig] = params[TRIGLENGTH_PARAM].getValue();
+    if (paramMoved(TRIGSLIDETYPE_PARAM)) trigSlideType[currentPattern][currentTrack][currentTrig] = params[TRIGSLIDETYPE_PARAM].getValue();
+		if (paramMoved(TRIGSLIDE_PARAM)) trigSlide[currentPattern][currentTrack][currentTrig] =  params[TRIGSLIDE_PARAM].getValue();
+		if (paramMoved(TRIGTYPE_PARAM)) nTrigsAttibutes[currentPattern][currentTrack][currentTrig].setTrigType(params[TRIGTYPE_PARAM].getValue());
+		if (paramMoved(TRIGTRIM_PARAM)) trigTrim[currentPattern][currentTrack][currentTrig] =  params[TRIGTRIM_PARAM].getValue();
+		if (paramMoved(TRIGPULSECOUNT_PARAM)) nTrigsAttibutes[currentPattern][currentTrack][currentTrig].setTrigPulseCount(params[TRIGPULSECOUNT_PARAM].getValue());
+		if (paramMoved(TRIGPULSEDISTANCE_PARAM)) trigPulseDistance[currentPattern][currentTrack][currentTrig] = params[TRIGPULSEDISTANCE_PARAM].getValue();
+		if (paramMoved(TRIGCV1_PARAM)) trigCV1[currentPattern][currentTrack][currentTrig] = params[TRIGCV1_PARAM].getValue();
+		if (paramMoved(TRIGCV2_PARAM)) trigCV2[currentPattern][currentTrack][currentTrig] = params[TRIGCV2_PARAM].getValue();
+		if (paramMoved(TRIGPROBA_PARAM)) nTrigsAttibutes[currentPattern][currentTrack][currentTrig].setTrigProba(params[TRIGPROBA_PARAM].getValue());
+		if (paramMoved(TRIGPROBACOUNT_PARAM)) nTrigsAttibutes[currentPattern][currentTrack][currentTrig].setTrigCount(params[TRIGPROBACOUNT_PARAM].getValue());
+		if (paramMoved(TRIGPROBACOUNTRESET_PARAM)) nTrigsAttibutes[currentPattern][currentTrack][currentTrig].setTrigCountReset(params[TRIGPROBACOUNTRESET_PARAM].getValue());
 	}
 
 
+	packedstate::SequencerBank<TrackAttibutes, TrigAttibutes, float> patternBank() {
+		return {nTracksAttibutes, rootNote, scale, quantizeCV1, slideMode, nTrigsAttibutes,
+			trigSlide, trigSlideType, trigTrim, trigLength, trigPulseDistance, trigCV1, trigCV2};
+	}
+
 	json_t *dataToJson() override {
 		json_t *rootJ = BidooModule::dataToJson();
 		json_object_set_new(rootJ, "currentPattern", json_integer(currentPattern));
@@ -631,6 +694,12 @@ struct ZOUMAI : BidooModule {
     for(size_t i=0; i<8; i++) {
       json_object_set_new(rootJ, ("label" + to_string(i)).c_str(), json_string(labels[i].c_str()));
     }
+		json_object_set_new(rootJ, "compactStorage", json_boolean(compactStorage));
+		if (compactStorage) {
+			json_object_set_new(rootJ, "patternsVersion", json_integer(PATTERNS_VERSION));
+			json_object_set_new(rootJ, "patterns", json_string(patternBank().toBase64().c_str()));
+			return rootJ;
+		}
 		for (size_t i = 0; i<8; i++) {
 			json_t *patternJ = json_object();
 			for (size_t j = 0; j < 8; j++) {
@@ -696,6 +765,28 @@ struct ZOUMAI : BidooModule {
       }
     }
 
+		json_t *compactStorageJ = json_object_get(rootJ, "compactStorage");
+		if (compactStorageJ)
+			compactStorage = json_boolean_value(compactStorageJ);
+
+		json_t *patternsJ = json_object_get(rootJ, "patterns");
+		json_t *patternsVersionJ = json_object_get(rootJ, "patternsVersion");
+		if (patternsJ && (json_integer_value(patternsVersionJ) == PATTERNS_VERSION)) {
+			bool loaded = false;
+			try {
+				loaded = patternBank().fromBase64(json_string_value(patternsJ));
+			}
+			catch (Exception& e) {
+				WARN("%s", e.what());
+			}
+			if (loaded) {
+				invalidateTrackEvents();
+				updateTrackToParams();
+				updateTrigToParams();
+				return;
+			}
+		}
+
 		for (size_t i=0; i<8;i++) {
 			json_t *patternJ = json_object_get(rootJ, ("pattern" + to_string(i)).c_str());
 			if (patternJ){
@@ -786,12 +877,14 @@ struct ZOUMAI : BidooModule {
 				}
 			}
 		}
+		invalidateTrackEvents();
 		updateTrackToParams();
 		updateTrigToParams();
 	}
 
 	void randomizeTrigNote(const int track, const int trig) {
 		nTrigsAttibutes[currentPattern][track][trig].fullRandomize();
+		invalidateTrackEvents(currentPattern, track);
 	}
 
 	void randomizeTrigNotePlus(const int track, const int trig) {
@@ -800,18 +893,22 @@ struct ZOUMAI : BidooModule {
     trigSlideType[currentPattern][track][trig]=random::uniform()>0.5f?true:false;
 		trigLength[currentPattern][track][trig]=random::uniform()*2.0f;
 		trigPulseDistance[currentPattern][track][trig]=random::uniform()*2.0f;
+		invalidateTrackEvents(currentPattern, track);
 	}
 
 	void randomizeTrigProb(const int track, const int trig) {
 		nTrigsAttibutes[currentPattern][track][trig].randomizeProbs();
+		invalidateTrackEvents(currentPattern, track);
 	}
 
 	void randomizeTrigCV1(const int track, const int trig) {
 		trigCV1[currentPattern][track][trig]=random::uniform()*10.0f;
+		invalidateTrackEvents(currentPattern, track);
 	}
 
 	void randomizeTrigCV2(const int track, const int trig) {
 		trigCV2[currentPattern][track][trig]=random::uniform()*10.0f;
+		invalidateTrackEvents(currentPattern, track);
 	}
 
 	void fullRandomizeTrig(const int track, const int trig) {
@@ -823,6 +920,7 @@ struct ZOUMAI : BidooModule {
 
 	void randomizeTrack(const int track) {
 		nTracksAttibutes[currentPattern][track].randomize();
+		invalidateTrackEvents(currentPattern, track);
 	}
 
 	void randomizeTrackTrigsNotes(const int track) {
@@ -953,6 +1051,7 @@ struct ZOUMAI : BidooModule {
 			nTrigsAttibutes[currentPattern][track][tLen-1] = temp;
 			nTrigsAttibutes[currentPattern][track][tLen-1].setTrigIndex(tLen-1);
 		}
+		invalidateTrackEvents(currentPattern, track);
 	}
 
 
@@ -975,26 +1074,31 @@ struct ZOUMAI : BidooModule {
 			nTrigsAttibutes[currentPattern][track][0] = temp;
 			nTrigsAttibutes[currentPattern][track][0].setTrigIndex(0);
 		}
+		invalidateTrackEvents(currentPattern, track);
 	}
 
 	void trackUp(const int track) {
 		for (int i = 0; i < 64; i++) {
 			nTrigsAttibutes[currentPattern][track][i].up();
 		}
+		invalidateTrackEvents(currentPattern, track);
 	}
 
 	void trackDown(const int track) {
 		for (int i = 0; i < 64; i++) {
 			nTrigsAttibutes[currentPattern][track][i].down();
 		}
+		invalidateTrackEvents(currentPattern, track);
 	}
 
 	void trigUp(const int trig) {
 		nTrigsAttibutes[currentPattern][currentTrack][trig].up();
+		invalidateTrackEvents(currentPattern, currentTrack);
 	}
 
 	void trigDown(const int trig) {
 		nTrigsAttibutes[currentPattern][currentTrack][trig].down();
+		invalidateTrackEvents(currentPattern, currentTrack);
 	}
 
 
@@ -1016,6 +1120,7 @@ struct ZOUMAI : BidooModule {
 		for (int i=0; i<64; i++) {
 			pasteTrig(fromPattern,fromTrack,i,toPattern,toTrack,i);
 		}
+		invalidateTrackEvents(toPattern, toTrack);
 	}
 
 	void pasteTrig(const int fromPattern, const int fromTrack, const int fromTrig, const int toPattern, const int toTrack, const int toTrig) {
@@ -1030,6 +1135,7 @@ struct ZOUMAI : BidooModule {
 		trigCV1[toPattern][toTrack][toTrig] = trigCV1[fromPattern][fromTrack][fromTrig];
 		trigCV2[toPattern][toTrack][toTrig] = trigCV2[fromPattern][fromTrack][fromTrig];
     trigSlideType[toPattern][toTrack][toTrig] = trigSlideType[fromPattern][fromTrack][fromTrig];
+		invalidateTrackEvents(toPattern, toTrack);
 	}
 
 	void pastePattern() {
@@ -1056,6 +1162,7 @@ struct ZOUMAI : BidooModule {
 		trigCV1[pattern][track][trig] = 0.0f;
 		trigCV2[pattern][track][trig] = 0.0f;
     trigSlideType[pattern][track][trig] = false;
+		invalidateTrackEvents(pattern, track);
 	}
 
 	void pageInit(const int page) {
@@ -1078,6 +1185,7 @@ struct ZOUMAI : BidooModule {
 			trigInit(pattern, track, i);
 			nTrigsAttibutes[pattern][track][i].setTrigIndex(i);
 		}
+		invalidateTrackEvents(pattern, track);
 	}
 
 	void onReset() override {
@@ -1109,16 +1217,17 @@ struct ZOUMAI : BidooModule {
 
 	float trackGetGate(const int track, const int tPT) {
 		if (nTrigsAttibutes[currentPattern][track][tPT].getTrigActive() && !nTrigsAttibutes[currentPattern][track][tPT].getTrigSleeping()) {
-			float rTP = trigGetRelativeTrackPosition(track, tPT);
+			const TrigEvent &e = trackEvents[track];
+			float rTP = trackHead[currentPattern][track] - e.start;
 			if (rTP >= 0) {
-				if (rTP<trigLength[currentPattern][track][tPT]) {
+				if (rTP<e.length) {
 					return 10.0f;
 				}
 				else {
-					int cPulses = (trigPulseDistance[currentPattern][track][tPT] == 0) ? 0 : (int)(rTP/(float)trigPulseDistance[currentPattern][track][tPT]);
-					return ((cPulses<nTrigsAttibutes[currentPattern][track][tPT].getTrigPulseCount())
-					&& (rTP>=(cPulses*trigPulseDistance[currentPattern][track][tPT]))
-					&& (rTP<=((cPulses*trigPulseDistance[currentPattern][track][tPT])+trigLength[currentPattern][track][tPT]))) ? 10.0f : 0.0f;
+					int cPulses = (e.pulseDistance == 0) ? 0 : (int)(rTP/e.pulseDistance);
+					return ((cPulses<e.pulseCount)
+					&& (rTP>=(cPulses*e.pulseDistance))
+					&& (rTP<=((cPulses*e.pulseDistance)+e.length))) ? 10.0f : 0.0f;
 				}
 			}
 			else
@@ -1145,43 +1254,34 @@ struct ZOUMAI : BidooModule {
 		return nTrigsAttibutes[currentPattern][track][trig].getTrigIndex() + trigTrim[currentPattern][track][trig];
 	}
 
-	float trackGetVO(const int track, const int tPT, const bool quantize = false) {
+	void trackCompileEvent(const int track, const int tPT, const bool quantize) {
+		TrigEvent &e = trackEvents[track];
+		e.trig = tPT;
+		e.dirty = false;
+		e.quantize = quantize;
+		e.transpose = trsp[track];
+		e.start = trigGetTrimedIndex(track, tPT);
+		e.length = trigLength[currentPattern][track][tPT];
+		e.pulseDistance = trigPulseDistance[currentPattern][track][tPT];
+		e.pulseCount = nTrigsAttibutes[currentPattern][track][tPT].getTrigPulseCount();
+		e.fullLength = trigGetFullLength(track, tPT);
 		float vo = nTrigsAttibutes[currentPattern][track][tPT].getVO() + trsp[track];
-		if (trigSlide[currentPattern][track][tPT] == 0.0f) {
-			return quantize ? std::get<0>(quant.closestVoltageInScale(vo, rootNote[currentPattern][track], scale[currentPattern][track])) : vo;
-		}
-		else
-		{
-			float fullLength = trigGetFullLength(track,tPT);
-			float voQ = quantize ? std::get<0>(quant.closestVoltageInScale(vo, rootNote[currentPattern][track], scale[currentPattern][track])) : vo;
-			if (fullLength > 0.0f) {
-				if (slideMode[currentPattern][track]) {
-          if (trigSlideType[currentPattern][track][tPT]) {
-            float subPhase = clamp(trigGetRelativeTrackPosition(track, tPT),0.0f,1.0f);
-  					return voQ - (1.0f - interpolateLinear(powTable[(int)(trigSlide[currentPattern][track][tPT]*99.0f)],9999.0f*subPhase)) * (voQ - prevVO[track]);
-          }
-          else
-          {
-            float subPhase = clamp(trigGetRelativeTrackPosition(track, tPT),0.0f,fullLength);
-  					return voQ - (1.0f - interpolateLinear(powTable[(int)(trigSlide[currentPattern][track][tPT]*99.0f)],9999.0f*subPhase/fullLength)) * (voQ - prevVO[track]);
-          }
-				}
-				else {
-          if (trigSlideType[currentPattern][track][tPT]) {
-            float subPhase = clamp(trigGetRelativeTrackPosition(track, tPT)*(1.0f/max((int)abs(voQ - prevVO[track]),1)),0.0f,1.0f);
-  					return voQ - (1.0f - interpolateLinear(powTable[(int)(trigSlide[currentPattern][track][tPT]*99.0f)],9999.0f*subPhase)) * (voQ - prevVO[track]);
-          }
-          else
-          {
-            float subPhase = clamp(trigGetRelativeTrackPosition(track, tPT)*(1.0f/max((int)abs(voQ - prevVO[track]),1)),0.0f,fullLength);
-  					return voQ - (1.0f - interpolateLinear(powTable[(int)(trigSlide[currentPattern][track][tPT]*99.0f)],9999.0f*subPhase/fullLength)) * (voQ - prevVO[track]);
-          }
-				}
-			}
-			else {
-				return voQ;
-			}
+		e.vo = quantize ? std::get<0>(quant.closestVoltageInScale(vo, rootNote[currentPattern][track], scale[currentPattern][track])) : vo;
+		e.cv1 = (quantizeCV1[currentPattern][track]>0 && quantize) ? std::get<0>(quant.closestVoltageInScale(trigCV1[currentPattern][track][tPT]-4.0f, rootNote[currentPattern][track], scale[currentPattern][track])) : trigCV1[currentPattern][track][tPT];
+		e.cv2 = trigCV2[currentPattern][track][tPT];
+		e.slideCurve = trigSlide[currentPattern][track][tPT] == 0 ? NULL : powTable[(int)(trigSlide[currentPattern][track][tPT]*99.0f)];
+		e.slideType = trigSlideType[currentPattern][track][tPT];
+	}
+
+	float trackGetVO(const int track) {
+		const TrigEvent &e = trackEvents[track];
+		if (!e.slideCurve || (e.fullLength <= 0.0f)) {
+			return e.vo;
 		}
+		float rTP = trackHead[currentPattern][track] - e.start;
+		float range = slideMode[currentPattern][track] ? 1.0f : 1.0f/max((int)abs(e.vo - prevVO[track]),1);
+		float phase = e.slideType ? clamp(rTP*range,0.0f,1.0f) : clamp(rTP*range,0.0f,e.fullLength)/e.fullLength;
+		return e.vo - (1.0f - interpolateLinear(e.slideCurve,9999.0f*phase)) * (e.vo - prevVO[track]);
 	}
 
 	void trackSetCurrentTrig(const int track, const bool fill, const bool pNei, const bool force=false, const bool forceTrig = false, const bool killTrig = false, const float dice = 0.0f) {
@@ -1388,6 +1488,7 @@ struct ZOUMAI : BidooModule {
 };
 
 void ZOUMAI::process(const ProcessArgs &args) {
+	ProfileScope profile(this, args);
 	currentPattern = (int)clamp((inputs[PATTERN_INPUT].isConnected() ? rescale(clamp(inputs[PATTERN_INPUT].getVoltage(), 0.0f, 10.0f),0.0f,10.0f,0.0f,8.0f) : 0) + (int)params[PATTERN_PARAM].getValue(), 0.0f, 7.0f);
 
 	if (rightExpander.module && rightExpander.module->model == modelZOUMAIExpander) {
@@ -1423,96 +1524,102 @@ void ZOUMAI::process(const ProcessArgs &args) {
 			trackSync(i,trackCurrentTickCount[previousPattern][i], trackLastTickCount[previousPattern][i], trackHead[previousPattern][i]);
 		}
 		previousPattern = currentPattern;
+		invalidateTrackEvents();
 		updateTrackToParams();
 		updateTrigToParams();
 	}
-	else {
-		updateTrigVO();
+	else if (paramDivider.process()) {
 		updateParamsToTrack();
 		updateParamsToTrig();
 	}
 
-	int pageOffset = trigPage*16;
-	int tCT = nTracksAttibutes[currentPattern][currentTrack].getTrackCurrentTrig();
-	for (int i = 0; i<16; i++) {
-		int shiftedIndex = i + pageOffset;
-		if (tCT == shiftedIndex) {
-			lights[STEPS_LIGHTS+3*i].setBrightness(1.0f);
-			lights[STEPS_LIGHTS+3*i+1].setBrightness(0.0f);
-			lights[STEPS_LIGHTS+3*i+2].setBrightness(0.0f);
+	for (int i = 0; i<8; i++) {
+		if (trackActiveTriggers[i].process(inputs[TRACKACTIVE_INPUTS+i].getVoltage())) {
+			nTracksAttibutes[currentPattern][i].toggleTrackActive();
 		}
-		else if (nTrigsAttibutes[currentPattern][currentTrack][shiftedIndex].getTrigActive()) {
-			if (shiftedIndex == currentTrig) {
-				lights[STEPS_LIGHTS+3*i].setBrightness(0.0f);
+	}
+
+	if (lightDivider.process()) {
+		updateTrigVO();
+
+		int pageOffset = trigPage*16;
+		int tCT = nTracksAttibutes[currentPattern][currentTrack].getTrackCurrentTrig();
+		for (int i = 0; i<16; i++) {
+			int shiftedIndex = i + pageOffset;
+			if (tCT == shiftedIndex) {
+				lights[STEPS_LIGHTS+3*i].setBrightness(1.0f);
 				lights[STEPS_LIGHTS+3*i+1].setBrightness(0.0f);
-				lights[STEPS_LIGHTS+3*i+2].setBrightness(1.0f);
-			}
-			else {
-				lights[STEPS_LIGHTS+3*i].setBrightness(0.0f);
-				lights[STEPS_LIGHTS+3*i+1].setBrightness(1.0f);
 				lights[STEPS_LIGHTS+3*i+2].setBrightness(0.0f);
 			}
-		}
-		else if (currentTrig == shiftedIndex) {
-			lights[STEPS_LIGHTS+3*i].setBrightness(0.0f);
-			lights[STEPS_LIGHTS+3*i+1].setBrightness(0.0f);
-			lights[STEPS_LIGHTS+3*i+2].setBrightness(0.5f);
-		}
-		else {
-			lights[STEPS_LIGHTS+3*i].setBrightness(0.1f);
-			lights[STEPS_LIGHTS+3*i+1].setBrightness(0.1f);
-			lights[STEPS_LIGHTS+3*i+2].setBrightness(0.1f);
-		}
-
-		if (i<4) {
-			if (i == trigPage) {
-				lights[TRIGPAGE_LIGHTS+3*i].setBrightness(0.0f);
-				lights[TRIGPAGE_LIGHTS+3*i+2].setBrightness(1.0f);
+			else if (nTrigsAttibutes[currentPattern][currentTrack][shiftedIndex].getTrigActive()) {
+				if (shiftedIndex == currentTrig) {
+					lights[STEPS_LIGHTS+3*i].setBrightness(0.0f);
+					lights[STEPS_LIGHTS+3*i+1].setBrightness(0.0f);
+					lights[STEPS_LIGHTS+3*i+2].setBrightness(1.0f);
+				}
+				else {
+					lights[STEPS_LIGHTS+3*i].setBrightness(0.0f);
+					lights[STEPS_LIGHTS+3*i+1].setBrightness(1.0f);
+					lights[STEPS_LIGHTS+3*i+2].setBrightness(0.0f);
+				}
 			}
-			else if ((tCT >= (i*16)) && (tCT<(16*(i+1)-1))) {
-				lights[TRIGPAGE_LIGHTS+3*i].setBrightness(1.0f);
-				lights[TRIGPAGE_LIGHTS+3*i+2].setBrightness(0.0f);
+			else if (currentTrig == shiftedIndex) {
+				lights[STEPS_LIGHTS+3*i].setBrightness(0.0f);
+				lights[STEPS_LIGHTS+3*i+1].setBrightness(0.0f);
+				lights[STEPS_LIGHTS+3*i+2].setBrightness(0.5f);
 			}
 			else {
-				lights[TRIGPAGE_LIGHTS+3*i].setBrightness(0.0f);
-				lights[TRIGPAGE_LIGHTS+3*i+2].setBrightness(0.0f);
+				lights[STEPS_LIGHTS+3*i].setBrightness(0.1f);
+				lights[STEPS_LIGHTS+3*i+1].setBrightness(0.1f);
+				lights[STEPS_LIGHTS+3*i+2].setBrightness(0.1f);
 			}
-		}
 
-		if (i<7) {
-				if (nTrigsAttibutes[currentPattern][currentTrack][currentTrig].getTrigOctave()==i) {
-					lights[OCTAVE_LIGHTS+3*i+2].setBrightness(1.0f);
+			if (i<4) {
+				if (i == trigPage) {
+					lights[TRIGPAGE_LIGHTS+3*i].setBrightness(0.0f);
+					lights[TRIGPAGE_LIGHTS+3*i+2].setBrightness(1.0f);
+				}
+				else if ((tCT >= (i*16)) && (tCT<(16*(i+1)-1))) {
+					lights[TRIGPAGE_LIGHTS+3*i].setBrightness(1.0f);
+					lights[TRIGPAGE_LIGHTS+3*i+2].setBrightness(0.0f);
 				}
 				else {
-					lights[OCTAVE_LIGHTS+3*i+2].setBrightness(0.0f);
+					lights[TRIGPAGE_LIGHTS+3*i].setBrightness(0.0f);
+					lights[TRIGPAGE_LIGHTS+3*i+2].setBrightness(0.0f);
 				}
-		}
-
-		if (i<8) {
-			if (trackActiveTriggers[i].process(inputs[TRACKACTIVE_INPUTS+i].getVoltage())) {
-				nTracksAttibutes[currentPattern][i].toggleTrackActive();
 			}
 
-			if (currentTrack==i) {
-				lights[TRACKSELECT_LIGHTS+i*3+1].setBrightness(0.0f);
-				lights[TRACKSELECT_LIGHTS+i*3+2].setBrightness(1.0f);
-			}
-			else {
-				lights[TRACKSELECT_LIGHTS+i*3+1].setBrightness(0.0f);
-				lights[TRACKSELECT_LIGHTS+i*3+2].setBrightness(0.0f);
+			if (i<7) {
+					if (nTrigsAttibutes[currentPattern][currentTrack][currentTrig].getTrigOctave()==i) {
+						lights[OCTAVE_LIGHTS+3*i+2].setBrightness(1.0f);
+					}
+					else {
+						lights[OCTAVE_LIGHTS+3*i+2].setBrightness(0.0f);
+					}
 			}
 
-			if (!solo && nTracksAttibutes[currentPattern][i].getTrackActive()) {
-				lights[TRACKSONOFF_LIGHTS+i*3+1].setBrightness(1.0f);
-				lights[TRACKSONOFF_LIGHTS+i*3+2].setBrightness(0.0f);
-			}
-			else if (solo && nTracksAttibutes[currentPattern][i].getTrackSolo()) {
-				lights[TRACKSONOFF_LIGHTS+i*3+1].setBrightness(0.0f);
-				lights[TRACKSONOFF_LIGHTS+i*3+2].setBrightness(1.0f);
-			}
-			else {
-				lights[TRACKSONOFF_LIGHTS+i*3+1].setBrightness(0.0f);
-				lights[TRACKSONOFF_LIGHTS+i*3+2].setBrightness(0.0f);
+			if (i<8) {
+				if (currentTrack==i) {
+					lights[TRACKSELECT_LIGHTS+i*3+1].setBrightness(0.0f);
+					lights[TRACKSELECT_LIGHTS+i*3+2].setBrightness(1.0f);
+				}
+				else {
+					lights[TRACKSELECT_LIGHTS+i*3+1].setBrightness(0.0f);
+					lights[TRACKSELECT_LIGHTS+i*3+2].setBrightness(0.0f);
+				}
+
+				if (!solo && nTracksAttibutes[currentPattern][i].getTrackActive()) {
+					lights[TRACKSONOFF_LIGHTS+i*3+1].setBrightness(1.0f);
+					lights[TRACKSONOFF_LIGHTS+i*3+2].setBrightness(0.0f);
+				}
+				else if (solo && nTracksAttibutes[currentPattern][i].getTrackSolo()) {
+					lights[TRACKSONOFF_LIGHTS+i*3+1].setBrightness(0.0f);
+					lights[TRACKSONOFF_LIGHTS+i*3+2].setBrightness(1.0f);
+				}
+				else {
+					lights[TRACKSONOFF_LIGHTS+i*3+1].setBrightness(0.0f);
+					lights[TRACKSONOFF_LIGHTS+i*3+2].setBrightness(0.0f);
+				}
 			}
 		}
 	}
@@ -1593,6 +1700,7 @@ void ZOUMAI::process(const ProcessArgs &args) {
 			int tPT = nTracksAttibutes[currentPattern][i].getTrackPlayedTrig();
 
 			if ((currentTrack == i) && (params[RECORD_PARAM].getValue() == 1.0f)) {
+					trackEvents[i].dirty = true;
 					if (inputs[GATE_INPUT].getVoltage()>0.0f) {
 						if (!noteIncoming) {
 							noteIncoming = true;
@@ -1638,6 +1746,11 @@ void ZOUMAI::process(const ProcessArgs &args) {
 			}
 
 
+			bool q = rootNote[currentPattern][i]>=0 && scale[currentPattern][i]>0;
+			if (trackEvents[i].dirty || (trackEvents[i].trig != tPT) || (trackEvents[i].transpose != trsp[i]) || (trackEvents[i].quantize != q)) {
+				trackCompileEvent(i, tPT, q);
+			}
+
 			if ((solo && nTracksAttibutes[currentPattern][i].getTrackSolo()) || (!solo && nTracksAttibutes[currentPattern][i].getTrackActive())) {
 				float gate = trackGetGate(i, tPT);
 				if (gate>0.0f) {
@@ -1661,10 +1774,9 @@ void ZOUMAI::process(const ProcessArgs &args) {
 				prevTrig[i] = tPT;
 			}
 
-			bool q = rootNote[currentPattern][i]>=0 && scale[currentPattern][i]>0;
-			outputs[VO_OUTPUTS + i].setVoltage(trackGetVO(i, tPT, q));
-			outputs[CV1_OUTPUTS + i].setVoltage(outputs[GATE_OUTPUTS + i].getVoltage() == 0.0f ? 0.0f : ((quantizeCV1[currentPattern][i]>0 && q) ? std::get<0>(quant.closestVoltageInScale(trigCV1[currentPattern][i][tPT]-4.0f, rootNote[currentPattern][i], scale[currentPattern][i])) : trigCV1[currentPattern][i][tPT]));
-			outputs[CV2_OUTPUTS + i].setVoltage(outputs[GATE_OUTPUTS + i].getVoltage() == 0.0f ? 0.0f : trigCV2[currentPattern][i][tPT]);
+			outputs[VO_OUTPUTS + i].setVoltage(trackGetVO(i));
+			outputs[CV1_OUTPUTS + i].setVoltage(outputs[GATE_OUTPUTS + i].getVoltage() == 0.0f ? 0.0f : trackEvents[i].cv1);
+			outputs[CV2_OUTPUTS + i].setVoltage(outputs[GATE_OUTPUTS + i].getVoltage() == 0.0f ? 0.0f : trackEvents[i].cv2);
 		}
 	}
 	else {
@@ -1716,6 +1828,7 @@ struct octaveBtn : SmallLEDLightBezel<RedGreenBlueLight> {
 				}
 				else {
 					mod->nTrigsAttibutes[mod->currentPattern][mod->currentTrack][mod->currentTrig].setTrigOctave(i);
+					mod->invalidateTrackEvents(mod->currentPattern, mod->currentTrack);
 				}
 			}
 			e.consume(this);
@@ -2079,6 +2192,7 @@ struct noteBtn : LEDLightBezel<RedGreenBlueLight> {
 			else {
 				mod->nTrigsAttibutes[mod->currentPattern][mod->currentTrack][mod->currentTrig].setTrigSemiTones(getParamQuantity()->paramId - ZOUMAI::NOTE_PARAMS);
 				mod->nTrigsAttibutes[mod->currentPattern][mod->currentTrack][mod->currentTrig].setTrigActive(true);
+				mod->invalidateTrackEvents(mod->currentPattern, mod->currentTrack);
 			}
 			e.consume(this);
 			return;
@@ -2950,6 +3064,10 @@ struct ZOUMAIWidget : BidooWidget {
 
 			menu->addChild(new MenuSeparator());
 
+			menu->addChild(createBoolPtrMenuItem("Compact patch storage", "", &module->compactStorage));
+
+			menu->addChild(new MenuSeparator());
+
 			menu->addChild(createSubmenuItem("Trig", "", [=](ui::Menu* menu) {
 				menu->addChild(construct<ZouInitTrigItem>(&MenuItem::text, "Erase (over+E)", &ZouInitTrigItem::module, module));
 				menu->addChild(construct<ZouCopyTrigItem>(&MenuItem::text, "Copy (over+C)", &ZouCopyTrigItem::module, module));
@@ -0,0 +1,168 @@
+#pragma once
+#include <rack.hpp>
+
+namespace fastmath {
+
+  using rack::simd::float_4;
+
+  // Approximations for the per sample math of the modules. The templates take
+  // float or float_4, the error bounds are measured against double precision
+  // libm over the domain given for each function, with the plugin's
+  // -funsafe-math-optimizations build flags.
+
+  // fmin and fmax compile to calls on float when NaNs have to be honoured.
+  inline float minimum(float a, float b) {
+    return a < b ? a : b;
+  }
+
+  inline float maximum(float a, float b) {
+    return a > b ? a : b;
+  }
+
+  inline float_4 minimum(float_4 a, float_4 b) {
+    return rack::simd::fmin(a, b);
+  }
+
+  inline float_4 maximum(float_4 a, float_4 b) {
+    return rack::simd::fmax(a, b);
+  }
+
+  // Zero below 1e-15 (-300 dB), for recursive states that would otherwise
+  // decay into denormals on threads without flush to zero.
+  inline float flushDenormal(float x) {
+    return std::fabs(x) < 1e-15f ? 0.f : x;
+  }
+
+  inline float_4 flushDenormal(float_4 x) {
+    return rack::simd::ifelse(rack::simd::fabs(x) < 1e-15f, float_4::zero(), x);
+  }
+
+  // 2^x, relative error < 3e-7, x is clamped to [-126, 126].
+  inline float exp2(float x) {
+    x = maximum(minimum(x, 126.f), -126.f);
+    float xi = std::floor(x + 0.5f);
+    float f = x - xi;
+    float p = 1.000000072f + f * (0.6931469670f + f * (0.2402211972f + f * (5.550713301e-2f + f * (9.675541706e-3f + f * 1.327646442e-3f))));
+    int32_t bits = ((int32_t)xi + 127) << 23;
+    float scale;
+    std::memcpy(&scale, &bits, sizeof(scale));
+    return p * scale;
+  }
+
+  // log2(x) for positive normal x, error < 1e-6 absolute or 1e-7 relative.
+  inline float log2(float x) {
+    int32_t bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+    float e = (float)(((bits >> 23) & 0xff) - 127);
+    bits = (bits & 0x007fffff) | 0x3f800000;
+    float m;
+    std::memcpy(&m, &bits, sizeof(m));
+    if (m > 1.41421356f) {
+      m *= 0.5f;
+      e += 1.f;
+    }
+    float t = (m - 1.f) / (m + 1.f);
+    float t2 = t * t;
+    return e + t * (2.885390082f + t2 * (0.9617966939f + t2 * (0.5770780164f + t2 * 0.4121985831f)));
+  }
+
+  // The float_4 versions go through Rack's vector exp and log. exp2 has a
+  // relative error < 5e-6 over [-126, 126], growing with |x| as x ln 2 is
+  // rounded, log2 an absolute error < 1.5e-6.
+  inline float_4 exp2(float_4 x) {
+    return rack::simd::exp(x * 0.693147181f);
+  }
+
+  inline float_4 log2(float_4 x) {
+    return rack::simd::log(x) * 1.44269504f;
+  }
+
+  // e^x, relative error grows with |x| and stays < 4e-6 up to 80.
+  template <typename T>
+  inline T exp(T x) {
+    return fastmath::exp2(x * 1.44269504f);
+  }
+
+  template <typename T>
+  inline T log10(T x) {
+    return fastmath::log2(x) * 0.301029996f;
+  }
+
+  // 20 log10(x) and back, for meters and gain computers.
+  template <typename T>
+  inline T ampToDb(T x) {
+    return fastmath::log2(x) * 6.02059991f;
+  }
+
+  template <typename T>
+  inline T dbToAmp(T db) {
+    return fastmath::exp2(db * 0.166096405f);
+  }
+
+  // tan(x) for x in [0, pi/2), Pade [7/6]. Relative error < 3e-7 up to
+  // x = 1.2 (cutoff at 0.38 of the sample rate), < 1.5e-6 up to x = 1.5.
+  template <typename T>
+  inline T tan(T x) {
+    T x2 = x * x;
+    return x * (135135.f + x2 * (-17325.f + x2 * (378.f - x2))) / (135135.f + x2 * (-62370.f + x2 * (3150.f - 28.f * x2)));
+  }
+
+  // tanh(x), Pade [7/6] below 1 and 1 - 2 / (e^2x + 1) above. Absolute
+  // error < 2e-7.
+  template <typename T>
+  inline T tanh(T x) {
+    T ax = minimum(rack::simd::fabs(x), T(9.f));
+    T x2 = ax * ax;
+    T low = ax * (135135.f + x2 * (17325.f + x2 * (378.f + x2))) / (135135.f + x2 * (62370.f + x2 * (3150.f + 28.f * x2)));
+    T high = 1.f - 2.f / (fastmath::exp2(ax * 2.88539008f) + 1.f);
+    T r = rack::simd::ifelse(ax < 1.f, low, high);
+    return rack::simd::ifelse(x < 0.f, -r, r);
+  }
+
+  // sin(x) and cos(x) together, x is reduced around the nearest quarter turn.
+  // Absolute error < 4e-7 for |x| < 10, callers keep their phases wrapped.
+  template <typename T>
+  inline void sincos(T x, T &s, T &c) {
+    T q = rack::simd::floor(x * 0.636619772f + 0.5f);
+    T r = x - q * 1.57079633f;
+    T r2 = r * r;
+    T sr = r * (0.9999999862f + r2 * (-0.1666663675f + r2 * (8.331584589e-3f - r2 * 1.946211508e-4f)));
+    T cr = 1.f + r2 * (-0.4999999962f + r2 * (4.166661674e-2f + r2 * (-1.388661919e-3f + r2 * 2.437992751e-5f)));
+    T quadrant = q - 4.f * rack::simd::floor(q * 0.25f);
+    T odd = quadrant - 2.f * rack::simd::floor(quadrant * 0.5f);
+    s = rack::simd::ifelse(odd > 0.5f, cr, sr);
+    c = rack::simd::ifelse(odd > 0.5f, sr, cr);
+    s = rack::simd::ifelse(quadrant > 1.5f, -s, s);
+    c = rack::simd::ifelse(rack::simd::fabs(quadrant - 1.5f) < 1.f, -c, c);
+  }
+
+  template <typename T>
+  inline T sin(T x) {
+    T s, c;
+    sincos(x, s, c);
+    return s;
+  }
+
+  template <typename T>
+  inline T cos(T x) {
+    T s, c;
+    sincos(x, s, c);
+    return c;
+  }
+
+  // atan2(y, x), absolute error < 6e-7 rad. Returns 0 for (0, 0) and pi for
+  // (-0, x < 0) where libm gives -pi.
+  template <typename T>
+  inline T atan2(T y, T x) {
+    T ax = rack::simd::fabs(x);
+    T ay = rack::simd::fabs(y);
+    T a = minimum(ax, ay) / maximum(maximum(ax, ay), T(1e-30f));
+    T a2 = a * a;
+    T r = a * (0.9999961117f + a2 * (-0.3331736824f + a2 * (0.1980781569f + a2 * (-0.1323333945f
+      + a2 * (7.962359005e-2f + a2 * (-3.360413017e-2f + a2 * 6.811759101e-3f))))));
+    r = rack::simd::ifelse(ay > ax, 1.57079633f - r, r);
+    r = rack::simd::ifelse(x < 0.f, 3.14159265f - r, r);
+    return rack::simd::ifelse(y < 0.f, -r, r);
+  }
+
+}
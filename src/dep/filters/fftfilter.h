@@ -2,6 +2,7 @@
 #include <math.h>
 #include <stdio.h>
 #include "../pffft/pffft.h"
+#include "../fastmath.hpp"
 
 using namespace std;
 
@@ -22,6 +23,7 @@ struct FFTFilter {
 	PFFFT_Setup *pffftSetup;
 	long gRover = false;
 	double magn, phase, tmp, window, real, imag;
+	float sinPhase, cosPhase;
 	double freqPerBin, expct, invOsamp, invFftFrameSize, invFftFrameSize2, invPi;
 	long fftFrameSize, osamp, i,k, qpd, index, inFifoLatency, stepSize, fftFrameSize2;
 
@@ -86,7 +88,7 @@ struct FFTFilter {
 
 					/* do windowing and re,im interleave */
 					for (k = 0; k < fftFrameSize;k++) {
-						window = -0.5 * cos(2.0f * M_PI * (double)k * invFftFrameSize) + 0.5f;
+						window = -0.5f * fastmath::cos(2.0f * (float)M_PI * k * (float)invFftFrameSize) + 0.5f;
 						gFFTworksp[k] = gInFIFO[k] * window;
 					}
 
@@ -103,7 +105,7 @@ struct FFTFilter {
 
 						/* compute magnitude and phase */
 						magn = 2.*sqrt(real*real + imag*imag);
-						phase = atan2(imag,real);
+						phase = fastmath::atan2((float)imag, (float)real);
 
 						/* compute phase difference */
 						tmp = phase - gLastPhase[k];
@@ -171,11 +173,13 @@ struct FFTFilter {
 
 						/* accumulate delta phase to get bin phase */
 						gSumPhase[k] += tmp;
-						phase = gSumPhase[k];
+						// wrapped so the float accumulator keeps its resolution
+						gSumPhase[k] -= 2.0f * M_PI * floor(gSumPhase[k] * invPi * 0.5f + 0.5f);
+						fastmath::sincos(gSumPhase[k], sinPhase, cosPhase);
 
 						/* get real and imag part and re-interleave */
-						gFFTworksp[2*k] = magn*cos(phase);
-						gFFTworksp[2*k+1] = magn*sin(phase);
+						gFFTworksp[2*k] = magn*cosPhase;
+						gFFTworksp[2*k+1] = magn*sinPhase;
 					}
 
 					// /* zero negative frequencies */
@@ -186,10 +190,10 @@ struct FFTFilter {
 
 					/* do windowing and add to output accumulator */
 					for(k=0; k < fftFrameSize; k++) {
-						window = -0.5f * cos(2.0f * M_PI *(double)k * invFftFrameSize) + 0.5f;
+						window = -0.5f * fastmath::cos(2.0f * (float)M_PI * k * (float)invFftFrameSize) + 0.5f;
 						gOutputAccum[k] += 2.0f * window * gFFTworkspOut[k] * invFftFrameSize2 * invOsamp;
 					}
-					for (k = 0; k < stepSize; k++) gOutFIFO[k] = gOutputAccum[k];
+					for (k = 0; k < stepSize; k++) gOutFIFO[k] = fastmath::flushDenormal(gOutputAccum[k]);
 
 					/* shift accumulator */
 					memmove(gOutputAccum, gOutputAccum+stepSize, fftFrameSize*sizeof(float));
@@ -2,6 +2,7 @@
 #include <math.h>
 #include <stdio.h>
 #include "../pffft/pffft.h"
+#include "../fastmath.hpp"
 
 using namespace std;
 
@@ -17,10 +18,13 @@ struct PitchShifter {
 	float *gAnaMagn;
 	float *gSynFreq;
 	float *gSynMagn;
+	// Hann window, computed once in double precision
+	double *gWindow;
 	float sampleRate;
 	PFFFT_Setup *pffftSetup;
 	long gRover = false;
-	double magn, phase, tmp, window, real, imag;
+	double magn, phase, tmp, real, imag;
+	float sinPhase, cosPhase;
 	double freqPerBin, expct, invOsamp, invFftFrameSize, invFftFrameSize2, invPi;
 	long fftFrameSize, osamp, i,k, qpd, index, inFifoLatency, stepSize, fftFrameSize2;
 
@@ -56,6 +60,10 @@ struct PitchShifter {
 		gAnaMagn = new float[fftFrameSize] {0.f};
 		gSynFreq = new float[fftFrameSize] {0.f};
 		gSynMagn = new float[fftFrameSize] {0.f};
+		gWindow = new double[fftFrameSize];
+		for (k = 0; k < fftFrameSize; k++) {
+			gWindow[k] = -0.5 * cos(2.0f * M_PI * (double)k * invFftFrameSize) + 0.5f;
+		}
 	}
 
 	~PitchShifter() {
@@ -69,6 +77,7 @@ struct PitchShifter {
 		delete[] gAnaMagn;
 		delete[] gSynFreq;
 		delete[] gSynMagn;
+		delete[] gWindow;
 		pffft_aligned_free(gFFTworksp);
 		pffft_aligned_free(gFFTworkspOut);
 	}
@@ -92,8 +101,7 @@ struct PitchShifter {
 					memset(gFFTworkspOut, 0, fftFrameSize*sizeof(float));
 
 					for (k = 0; k < fftFrameSize;k++) {
-						window = -0.5 * cos(2.0f * M_PI * (double)k * invFftFrameSize) + 0.5f;
-						gFFTworksp[k] = gInFIFO[k] * window;
+						gFFTworksp[k] = gInFIFO[k] * gWindow[k];
 					}
 
 					pffft_transform_ordered(pffftSetup, gFFTworksp, gFFTworkspOut, NULL, PFFFT_FORWARD);
@@ -102,7 +110,7 @@ struct PitchShifter {
 						real = gFFTworkspOut[2*k];
 						imag = gFFTworkspOut[2*k+1];
 						magn = 2.*sqrt(real*real + imag*imag);
-						phase = atan2(imag,real);
+						phase = fastmath::atan2((float)imag, (float)real);
 						tmp = phase - gLastPhase[k];
 						gLastPhase[k] = phase;
 						tmp -= (double)k*expct;
@@ -138,18 +146,19 @@ struct PitchShifter {
 						tmp = 2.0f * M_PI * tmp * invOsamp;
 						tmp += (double)k*expct;
 						gSumPhase[k] += tmp;
-						phase = gSumPhase[k];
-						gFFTworksp[2*k] = magn*cos(phase);
-						gFFTworksp[2*k+1] = magn*sin(phase);
+						// wrapped so the float accumulator keeps its resolution
+						gSumPhase[k] -= 2.0f * M_PI * floor(gSumPhase[k] * invPi * 0.5f + 0.5f);
+						fastmath::sincos(gSumPhase[k], sinPhase, cosPhase);
+						gFFTworksp[2*k] = magn*cosPhase;
+						gFFTworksp[2*k+1] = magn*sinPhase;
 					}
 
 					pffft_transform_ordered(pffftSetup, gFFTworksp, gFFTworkspOut , NULL, PFFFT_BACKWARD);
 					for(k=0; k < fftFrameSize; k++) {
-						window = -0.5f * cos(2.0f * M_PI *(double)k * invFftFrameSize) + 0.5f;
-						gOutputAccum[k] += 2.0f * window * gFFTworkspOut[k] * invFftFrameSize2 * invOsamp;
+						gOutputAccum[k] += 2.0f * gWindow[k] * gFFTworkspOut[k] * invFftFrameSize2 * invOsamp;
 					}
 
-					for (k = 0; k < stepSize; k++) gOutFIFO[k] = gOutputAccum[k];
+					for (k = 0; k < stepSize; k++) gOutFIFO[k] = fastmath::flushDenormal(gOutputAccum[k]);
 					memmove(gOutputAccum, gOutputAccum+stepSize, fftFrameSize*sizeof(float));
 					for (k = 0; k < inFifoLatency; k++) gInFIFO[k] = gInFIFO[k+stepSize];
 				}
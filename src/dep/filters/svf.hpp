@@ -0,0 +1,54 @@
+#pragma once
+#include <rack.hpp>
+#include "../fastmath.hpp"
+
+namespace svf {
+
+// Four state variable filters packed in float_4 lanes, same response as the
+// scalar MultiFilter used by the modules. tan() is only evaluated for a lane
+// when its cutoff, resonance or sample rate changes.
+struct MultiFilter4 {
+  float freq[4] = {-1.0f, -1.0f, -1.0f, -1.0f};
+  float q[4] = {-1.0f, -1.0f, -1.0f, -1.0f};
+  float smpRate[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+  rack::simd::float_4 g = 0.0f, k = 0.0f, d = 0.0f;
+  rack::simd::float_4 hp = 0.0f, bp = 0.0f, lp = 0.0f, mem1 = 0.0f, mem2 = 0.0f;
+
+  void setParams(int lane, float freq, float q, float smpRate) {
+    if ((freq == this->freq[lane]) && (q == this->q[lane]) && (smpRate == this->smpRate[lane])) return;
+    this->freq[lane] = freq;
+    this->q[lane] = q;
+    this->smpRate[lane] = smpRate;
+    float gl = fastmath::tan((float)M_PI * freq / smpRate);
+    float R = 1.0f / (2.0f * q);
+    g[lane] = gl;
+    k[lane] = 2.0f * R + gl;
+    d[lane] = 1.0f / (1.0f + 2.0f * R * gl + gl * gl);
+  }
+
+  void setParams(float freq, float q, float smpRate) {
+    for (int lane=0; lane<4; lane++) setParams(lane, freq, q, smpRate);
+  }
+
+  void calcOutput(rack::simd::float_4 sample) {
+    hp = (sample - k * mem1 - mem2) * d;
+    bp = g * hp + mem1;
+    lp = g * bp + mem2;
+    mem1 = fastmath::flushDenormal(g * hp + bp);
+    mem2 = fastmath::flushDenormal(g * bp + lp);
+  }
+
+  // Lanes outside the mask keep their outputs and memories untouched.
+  void calcOutput(rack::simd::float_4 sample, rack::simd::float_4 mask) {
+    rack::simd::float_4 nhp = (sample - k * mem1 - mem2) * d;
+    rack::simd::float_4 nbp = g * nhp + mem1;
+    rack::simd::float_4 nlp = g * nbp + mem2;
+    mem1 = rack::simd::ifelse(mask, fastmath::flushDenormal(g * nhp + nbp), mem1);
+    mem2 = rack::simd::ifelse(mask, fastmath::flushDenormal(g * nbp + nlp), mem2);
+    hp = rack::simd::ifelse(mask, nhp, hp);
+    bp = rack::simd::ifelse(mask, nbp, bp);
+    lp = rack::simd::ifelse(mask, nlp, lp);
+  }
+};
+
+}
@@ -7,6 +7,8 @@
 #ifndef _allpass_
 #define _allpass_
 
+#include "denormals.hpp"
+
 struct allpass
 {
 	allpass();
@@ -31,7 +33,7 @@ inline float allpass::process(float input)
 
 	bufout = buffer[bufidx];
 	output = -input + bufout;
-	buffer[bufidx] = input + (bufout*feedback);
+	buffer[bufidx] = undenormalise(input + (bufout*feedback));
 
 	if(++bufidx>=bufsize) bufidx = 0;
 
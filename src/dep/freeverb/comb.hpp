@@ -7,6 +7,8 @@
 #ifndef _comb_
 #define _comb_
 
+#include "denormals.hpp"
+
 struct comb
 {
 	comb();
@@ -37,7 +39,7 @@ inline float comb::process(float input)
 	float output;
 
 	output = buffer[bufidx];
-	filterstore = (output*damp2) + (filterstore*damp1);
+	filterstore = undenormalise((output*damp2) + (filterstore*damp1));
 	buffer[bufidx] = input + (filterstore*feedback);
 
 	if(++bufidx>=bufsize) bufidx = 0;
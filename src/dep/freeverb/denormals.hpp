@@ -0,0 +1,18 @@
+// Denormal guard for the recursive states
+//
+// Values below 1e-15 (-300 dB) are zeroed before they decay into the
+// denormal range, which is very slow on threads without flush to zero.
+
+#ifndef _denormals_
+#define _denormals_
+
+#include <math.h>
+
+static inline float undenormalise(float sample)
+{
+	return fabsf(sample) < 1e-15f ? 0.0f : sample;
+}
+
+#endif
+
+//ends
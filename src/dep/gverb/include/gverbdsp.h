@@ -78,6 +78,7 @@ static inline float damper_do(ty_damper *p, float x)
   float y;
 
   y = x*(1.0-p->damping) + p->delay*p->damping;
+  y = flush_to_zero(y);
   p->delay = y;
   return(y);
 }
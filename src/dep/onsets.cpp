@@ -0,0 +1,84 @@
+#include "onsets.hpp"
+
+namespace onsets {
+
+  SpectralFlux::SpectralFlux(int frameSize, int hopSize) : frameSize(frameSize), hopSize(hopSize) {
+    setup = pffft_new_setup(frameSize, PFFFT_REAL);
+    window = (float*)pffft_aligned_malloc(frameSize*sizeof(float));
+    frame = (float*)pffft_aligned_malloc(frameSize*sizeof(float));
+    fftIn = (float*)pffft_aligned_malloc(frameSize*sizeof(float));
+    fftOut = (float*)pffft_aligned_malloc(frameSize*sizeof(float));
+    work = (float*)pffft_aligned_malloc(frameSize*sizeof(float));
+    for (int i = 0; i < frameSize; i++) {
+      window[i] = 0.5f - 0.5f * std::cos(2.0f * M_PI * i / frameSize);
+      frame[i] = 0.0f;
+    }
+    lastMagnitude.assign(frameSize/2, 0.0f);
+  }
+
+  SpectralFlux::~SpectralFlux() {
+    pffft_destroy_setup(setup);
+    pffft_aligned_free(window);
+    pffft_aligned_free(frame);
+    pffft_aligned_free(fftIn);
+    pffft_aligned_free(fftOut);
+    pffft_aligned_free(work);
+  }
+
+  float SpectralFlux::process(const float *hop) {
+    std::memmove(frame, frame + hopSize, (frameSize - hopSize)*sizeof(float));
+    std::memcpy(frame + frameSize - hopSize, hop, hopSize*sizeof(float));
+    for (int i = 0; i < frameSize; i++) {
+      fftIn[i] = frame[i] * window[i];
+    }
+    pffft_transform_ordered(setup, fftIn, fftOut, work, PFFFT_FORWARD);
+
+    float flux = 0.0f;
+    // skip the DC/Nyquist pair stored in the first slot
+    for (int k = 1; k < frameSize/2; k++) {
+      float re = fftOut[2*k];
+      float im = fftOut[2*k+1];
+      float magnitude = std::log(1.0f + 100.0f * std::sqrt(re*re + im*im));
+      float diff = magnitude - lastMagnitude[k];
+      if (diff > 0.0f) flux += diff;
+      lastMagnitude[k] = magnitude;
+    }
+    return flux;
+  }
+
+  std::vector<int> pickPeaks(const std::vector<float> &flux, float threshold, int minGap) {
+    std::vector<int> peaks;
+    int n = flux.size();
+    if (n == 0) return peaks;
+    float maxFlux = *std::max_element(flux.begin(), flux.end());
+    if (maxFlux <= 0.0f) return peaks;
+    float norm = 1.0f / maxFlux;
+
+    // running mean over +/- meanRadius frames
+    const int meanRadius = 8;
+    const int maxRadius = 3;
+    float sum = 0.0f;
+    int lo = 0, hi = 0;
+    int last = -minGap;
+    for (int t = 0; t < n; t++) {
+      while (hi < std::min(n, t + meanRadius + 1)) sum += flux[hi++];
+      while (lo < t - meanRadius) sum -= flux[lo++];
+      float mean = sum / (hi - lo);
+      float v = flux[t];
+      if (((v - mean) * norm) <= threshold) continue;
+      bool isMax = true;
+      for (int k = std::max(0, t - maxRadius); k <= std::min(n - 1, t + maxRadius); k++) {
+        if ((flux[k] > v) || ((flux[k] == v) && (k < t))) {
+          isMax = false;
+          break;
+        }
+      }
+      if (isMax && (t - last >= minGap)) {
+        peaks.push_back(t);
+        last = t;
+      }
+    }
+    return peaks;
+  }
+
+}
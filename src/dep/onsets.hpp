@@ -0,0 +1,33 @@
+#pragma once
+#include <rack.hpp>
+#include "pffft/pffft.h"
+
+namespace onsets {
+
+  // Spectral flux of a mono stream: hann windowed frames of frameSize samples,
+  // log compressed magnitudes, sum of the positive bin increases between two
+  // consecutive frames.
+  struct SpectralFlux {
+    int frameSize;
+    int hopSize;
+    PFFFT_Setup *setup;
+    float *window;
+    float *frame;
+    float *fftIn;
+    float *fftOut;
+    float *work;
+    std::vector<float> lastMagnitude;
+
+    SpectralFlux(int frameSize = 1024, int hopSize = 256);
+    ~SpectralFlux();
+
+    // Feeds the next hopSize samples and returns the flux of the frame ending with them.
+    float process(const float *hop);
+  };
+
+  // Adaptive threshold peak picking on a flux curve normalised to its maximum.
+  // A frame is an onset when it is the local maximum and exceeds the mean of its
+  // neighbourhood by threshold. Positions are in frames.
+  std::vector<int> pickPeaks(const std::vector<float> &flux, float threshold, int minGap);
+
+}
@@ -1,6 +1,7 @@
 #include "dsp/resampler.hpp"
 #include "dsp/fir.hpp"
 #include "../pffft/pffft.h"
+#include "../fastmath.hpp"
 #include <algorithm>
 #include <iostream>
 #include <fstream>
@@ -18,6 +19,30 @@ using namespace std;
 
 using simd::float_4;
 
+// FFT setup and twiddles shared by every frame, built on first use.
+struct wtFFT {
+  PFFFT_Setup *setup;
+  float cosTable[FS];
+  float sinTable[FS];
+
+  wtFFT() {
+    setup = pffft_new_setup(FS, PFFFT_REAL);
+    for (size_t i=0; i<FS; i++) {
+      cosTable[i] = cos(i*AC);
+      sinTable[i] = sin(i*AC);
+    }
+  }
+
+  ~wtFFT() {
+    pffft_destroy_setup(setup);
+  }
+};
+
+inline const wtFFT& wtFFTShared() {
+  static wtFFT fft;
+  return fft;
+}
+
 struct wtFrame {
   vector<float> sample;
   vector<float> magnitude;
@@ -34,6 +59,7 @@ struct wtFrame {
   void calcFFT();
   void calcIFFT();
   void calcWav();
+  void updateBin(size_t bin, float oldMagnitude, float oldPhase);
   void normalize();
   void smooth();
   void window();
@@ -59,8 +85,7 @@ inline void wtFrame::reset() {
 }
 
 void wtFrame::calcFFT() {
-  PFFFT_Setup *pffftSetup;
-	pffftSetup = pffft_new_setup(FS, PFFFT_REAL);
+  PFFFT_Setup *pffftSetup = wtFFTShared().setup;
 	float *fftIn;
 	float *fftOut;
 	fftIn = (float*)pffft_aligned_malloc(FS*sizeof(float));
@@ -78,7 +103,7 @@ void wtFrame::calcFFT() {
 		if ((abs(fftOut[2*k])>1e-2f) || (abs(fftOut[2*k+1])>1e-2f)) {
 			float real = fftOut[2*k];
 			float imag = fftOut[2*k+1];
-			phase[k] = atan2(imag,real);
+			phase[k] = fastmath::atan2(imag,real);
 			magnitude[k] = 2.0f*sqrt(real*real+imag*imag)/FS;
 		}
     else {
@@ -87,14 +112,12 @@ void wtFrame::calcFFT() {
     }
 	}
 
-	pffft_destroy_setup(pffftSetup);
 	pffft_aligned_free(fftIn);
 	pffft_aligned_free(fftOut);
 }
 
 void wtFrame::calcIFFT() {
-  PFFFT_Setup *pffftSetup;
-	pffftSetup = pffft_new_setup(FS, PFFFT_REAL);
+  PFFFT_Setup *pffftSetup = wtFFTShared().setup;
 	float *fftIn;
 	float *fftOut;
 	fftIn = (float*)pffft_aligned_malloc(FS*sizeof(float));
@@ -103,8 +126,10 @@ void wtFrame::calcIFFT() {
 	memset(fftOut, 0, FS*sizeof(float));
 
 	for (size_t i = 0; i < FS2; i++) {
-		fftIn[2*i] = magnitude[i]*cos(phase[i]);
-		fftIn[2*i+1] = magnitude[i]*sin(phase[i]);
+		float s, c;
+		fastmath::sincos(phase[i], s, c);
+		fftIn[2*i] = magnitude[i]*c;
+		fftIn[2*i+1] = magnitude[i]*s;
 	}
 
 	pffft_transform_ordered(pffftSetup, fftIn, fftOut, 0, PFFFT_BACKWARD);
@@ -113,19 +138,47 @@ void wtFrame::calcIFFT() {
 		sample[i]=fftOut[i]*0.5f;
 	}
 
-	pffft_destroy_setup(pffftSetup);
 	pffft_aligned_free(fftIn);
 	pffft_aligned_free(fftOut);
 }
 
+// Sum of magnitude[j]*cos(i*j*AC + phase[j]) over the bins, done with one inverse FFT.
 void wtFrame::calcWav() {
-  for(size_t i = 0 ; i < FS; i++) {
-    sample[i] = 0;
-		for(size_t j = 0; j < FS2; j++) {
-			if (magnitude[j]>0) {
-        sample[i] += magnitude[j] * cos(i*j*AC + phase[j]);
-      }
-		}
+  PFFFT_Setup *pffftSetup = wtFFTShared().setup;
+	float *fftIn;
+	float *fftOut;
+	fftIn = (float*)pffft_aligned_malloc(FS*sizeof(float));
+	fftOut = (float*)pffft_aligned_malloc(FS*sizeof(float));
+
+	// slot 1 holds the Nyquist bin which is not part of the sum, the output is halved below
+	fftIn[0] = 2.0f*magnitude[0]*cos(phase[0]);
+	fftIn[1] = 0.0f;
+	for (size_t i = 1; i < FS2; i++) {
+		float s, c;
+		fastmath::sincos(phase[i], s, c);
+		fftIn[2*i] = magnitude[i]*c;
+		fftIn[2*i+1] = magnitude[i]*s;
+	}
+
+	pffft_transform_ordered(pffftSetup, fftIn, fftOut, 0, PFFFT_BACKWARD);
+
+	for (size_t i = 0; i < FS; i++) {
+		sample[i]=fftOut[i]*0.5f;
+	}
+
+	pffft_aligned_free(fftIn);
+	pffft_aligned_free(fftOut);
+}
+
+// Adds the contribution change of one bin after its magnitude or phase was edited.
+void wtFrame::updateBin(size_t bin, float oldMagnitude, float oldPhase) {
+  const wtFFT &fft = wtFFTShared();
+  float re = magnitude[bin]*cos(phase[bin]) - oldMagnitude*cos(oldPhase);
+  float im = magnitude[bin]*sin(phase[bin]) - oldMagnitude*sin(oldPhase);
+  size_t k = 0;
+  for(size_t i = 0; i < FS; i++) {
+    sample[i] += re*fft.cosTable[k] - im*fft.sinTable[k];
+    k = (k + bin) & (FS - 1);
   }
 }
 
@@ -0,0 +1,158 @@
+#pragma once
+#include <rack.hpp>
+#include <cstring>
+
+namespace packedstate {
+
+// Flat little helpers to store fixed size arrays in a single base64 string
+// instead of one json object per element. Values are copied in host byte
+// order, which is little endian on every platform Rack ships on.
+
+struct Writer {
+  std::vector<uint8_t> bytes;
+
+  template <typename T>
+  void write(const T* data, size_t count) {
+    size_t pos = bytes.size();
+    bytes.resize(pos + count * sizeof(T));
+    std::memcpy(&bytes[pos], data, count * sizeof(T));
+  }
+
+  template <typename T>
+  void write(const T value) {
+    write(&value, 1);
+  }
+
+  std::string toBase64() {
+    return rack::string::toBase64(bytes);
+  }
+};
+
+struct Reader {
+  std::vector<uint8_t> bytes;
+  size_t pos = 0;
+
+  Reader(const std::string &base64) {
+    bytes = rack::string::fromBase64(base64);
+  }
+
+  template <typename T>
+  bool read(T* data, size_t count) {
+    if (pos + count * sizeof(T) > bytes.size()) return false;
+    std::memcpy(data, &bytes[pos], count * sizeof(T));
+    pos += count * sizeof(T);
+    return true;
+  }
+
+  template <typename T>
+  bool read(T &value) {
+    return read(&value, 1);
+  }
+
+  bool atEnd() {
+    return pos == bytes.size();
+  }
+};
+
+// Pattern bank of the ZOUMAI and ENCORE sequencers, 8 patterns of 8 tracks
+// of 64 trigs, bound to the module arrays. TTime is the type of the trim,
+// length and pulse distance arrays, float in ZOUMAI and int in ENCORE.
+// Layout: 9 int32 per track, the persisted trig attribute bits as uint32
+// pairs, then one plane per trig array.
+template <typename TTrack, typename TTrig, typename TTime>
+struct SequencerBank {
+  TTrack (&tracks)[8][8];
+  int (&rootNote)[8][8];
+  int (&scale)[8][8];
+  int (&quantizeCV1)[8][8];
+  bool (&slideMode)[8][8];
+  TTrig (&trigs)[8][8][64];
+  float (&trigSlide)[8][8][64];
+  bool (&trigSlideType)[8][8][64];
+  TTime (&trigTrim)[8][8][64];
+  TTime (&trigLength)[8][8][64];
+  TTime (&trigPulseDistance)[8][8][64];
+  float (&trigCV1)[8][8][64];
+  float (&trigCV2)[8][8][64];
+
+  static const size_t size = 8*8*9*sizeof(int32_t) + 8*8*64*(2*sizeof(uint32_t) + sizeof(bool) + 3*sizeof(float) + 3*sizeof(TTime));
+
+  std::string toBase64() const {
+    Writer writer;
+    writer.bytes.reserve(size);
+    for (int i=0; i<8; i++) {
+      for (int j=0; j<8; j++) {
+        int32_t track[9] = {
+          tracks[i][j].getTrackActive(),
+          tracks[i][j].getTrackSolo(),
+          tracks[i][j].getTrackSpeed(),
+          tracks[i][j].getTrackReadMode(),
+          tracks[i][j].getTrackLength(),
+          rootNote[i][j],
+          scale[i][j],
+          quantizeCV1[i][j],
+          slideMode[i][j]
+        };
+        writer.write(track, 9);
+      }
+    }
+    for (int i=0; i<8; i++) {
+      for (int j=0; j<8; j++) {
+        for (int k=0; k<64; k++) {
+          writer.write<uint32_t>(trigs[i][j][k].getMainAttributes() & TTrig::TRIG_PERSISTED_MAIN);
+          writer.write<uint32_t>(trigs[i][j][k].getProbAttributes() & TTrig::TRIG_PERSISTED_PROB);
+        }
+      }
+    }
+    writer.write(&trigSlide[0][0][0], 8*8*64);
+    writer.write(&trigSlideType[0][0][0], 8*8*64);
+    writer.write(&trigTrim[0][0][0], 8*8*64);
+    writer.write(&trigLength[0][0][0], 8*8*64);
+    writer.write(&trigPulseDistance[0][0][0], 8*8*64);
+    writer.write(&trigCV1[0][0][0], 8*8*64);
+    writer.write(&trigCV2[0][0][0], 8*8*64);
+    return writer.toBase64();
+  }
+
+  // Leaves the bank untouched and returns false when the size does not match.
+  bool fromBase64(const std::string &data) {
+    Reader reader(data);
+    if (reader.bytes.size() != size) return false;
+    for (int i=0; i<8; i++) {
+      for (int j=0; j<8; j++) {
+        int32_t track[9];
+        reader.read(track, 9);
+        tracks[i][j].setTrackActive(track[0]);
+        tracks[i][j].setTrackSolo(track[1]);
+        tracks[i][j].setTrackSpeed(track[2]);
+        tracks[i][j].setTrackReadMode(track[3]);
+        tracks[i][j].setTrackLength(track[4]);
+        rootNote[i][j] = track[5];
+        scale[i][j] = track[6];
+        quantizeCV1[i][j] = track[7];
+        slideMode[i][j] = track[8];
+      }
+    }
+    for (int i=0; i<8; i++) {
+      for (int j=0; j<8; j++) {
+        for (int k=0; k<64; k++) {
+          uint32_t attributes[2] = {0, 0};
+          reader.read(attributes, 2);
+          TTrig &trig = trigs[i][j][k];
+          trig.setMainAttributes((trig.getMainAttributes() & ~TTrig::TRIG_PERSISTED_MAIN) | (attributes[0] & TTrig::TRIG_PERSISTED_MAIN));
+          trig.setProbAttributes((trig.getProbAttributes() & ~TTrig::TRIG_PERSISTED_PROB) | (attributes[1] & TTrig::TRIG_PERSISTED_PROB));
+        }
+      }
+    }
+    reader.read(&trigSlide[0][0][0], 8*8*64);
+    reader.read(&trigSlideType[0][0][0], 8*8*64);
+    reader.read(&trigTrim[0][0][0], 8*8*64);
+    reader.read(&trigLength[0][0][0], 8*8*64);
+    reader.read(&trigPulseDistance[0][0][0], 8*8*64);
+    reader.read(&trigCV1[0][0][0], 8*8*64);
+    reader.read(&trigCV2[0][0][0], 8*8*64);
+    return reader.atEnd();
+  }
+};
+
+}
@@ -0,0 +1,90 @@
+#include "profiler.hpp"
+
+namespace profiler {
+
+  static double bucketLimit(int i) {
+    return std::exp2((i + 1) * 0.25);
+  }
+
+  void ProcessProfile::record(double ns, int64_t frame) {
+    if (resetRequested) {
+      reset();
+      resetRequested = false;
+    }
+    int i = ns > 1.0 ? rack::clamp((int)(4.0 * std::log2(ns)), 0, BUCKETS - 1) : 0;
+    histogram[i]++;
+    calls++;
+    totalNs += ns;
+    if (ns > worstNs) {
+      worstNs = ns;
+      worstFrame = frame;
+    }
+    if (burstCount == 0) burstFrame = frame;
+    burstNs += ns;
+    if (++burstCount == BURST) {
+      if (burstNs > worstBurstNs) {
+        worstBurstNs = burstNs;
+        worstBurstFrame = burstFrame;
+      }
+      burstNs = 0.0;
+      burstCount = 0;
+    }
+  }
+
+  double ProcessProfile::mean() const {
+    return calls > 0 ? totalNs / calls : 0.0;
+  }
+
+  double ProcessProfile::percentile(double p) const {
+    uint64_t target = (uint64_t)std::ceil(p * calls);
+    uint64_t count = 0;
+    for (int i = 0; i < BUCKETS; i++) {
+      count += histogram[i];
+      if ((count > 0) && (count >= target)) return std::min(bucketLimit(i), worstNs);
+    }
+    return worstNs;
+  }
+
+  std::string ProcessProfile::summary() const {
+    if (calls == 0) return "No calls recorded";
+    return rack::string::f("mean %.2f us, p99 %.2f us, worst %.1f us, burst %.1f us",
+      mean() * 1e-3, percentile(0.99) * 1e-3, worstNs * 1e-3, worstBurstNs * 1e-3);
+  }
+
+  json_t *ProcessProfile::toJson() const {
+    json_t *rootJ = json_object();
+    json_object_set_new(rootJ, "calls", json_integer(calls));
+    json_object_set_new(rootJ, "meanUs", json_real(mean() * 1e-3));
+    json_object_set_new(rootJ, "p50Us", json_real(percentile(0.5) * 1e-3));
+    json_object_set_new(rootJ, "p99Us", json_real(percentile(0.99) * 1e-3));
+    json_object_set_new(rootJ, "worstUs", json_real(worstNs * 1e-3));
+    json_object_set_new(rootJ, "worstFrame", json_integer(worstFrame));
+    json_object_set_new(rootJ, "burstCalls", json_integer(BURST));
+    json_object_set_new(rootJ, "worstBurstUs", json_real(worstBurstNs * 1e-3));
+    json_object_set_new(rootJ, "worstBurstFrame", json_integer(worstBurstFrame));
+    json_t *histogramJ = json_array();
+    for (int i = 0; i < BUCKETS; i++) {
+      if (histogram[i] == 0) continue;
+      json_t *bucketJ = json_object();
+      json_object_set_new(bucketJ, "upToUs", json_real(bucketLimit(i) * 1e-3));
+      json_object_set_new(bucketJ, "count", json_integer(histogram[i]));
+      json_array_append_new(histogramJ, bucketJ);
+    }
+    json_object_set_new(rootJ, "histogram", histogramJ);
+    return rootJ;
+  }
+
+  void ProcessProfile::reset() {
+    std::fill(histogram, histogram + BUCKETS, 0);
+    calls = 0;
+    totalNs = 0.0;
+    worstNs = 0.0;
+    worstFrame = 0;
+    burstNs = 0.0;
+    burstCount = 0;
+    burstFrame = 0;
+    worstBurstNs = 0.0;
+    worstBurstFrame = 0;
+  }
+
+}
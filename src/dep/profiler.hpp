@@ -0,0 +1,40 @@
+#pragma once
+#include <rack.hpp>
+#include <atomic>
+#include <chrono>
+
+namespace profiler {
+
+  // Cost of the process() calls of one module. Durations go in log2 buckets
+  // with four steps per octave, bursts are sums over BURST consecutive calls
+  // so periodic FFT frames show up even when the mean is low.
+  struct ProcessProfile {
+    static const int BUCKETS = 160;
+    static const int BURST = 256;
+
+    std::atomic<bool> enabled {false};
+    std::atomic<bool> resetRequested {false};
+    uint64_t histogram[BUCKETS] = {};
+    uint64_t calls = 0;
+    double totalNs = 0.0;
+    double worstNs = 0.0;
+    int64_t worstFrame = 0;
+    double burstNs = 0.0;
+    int burstCount = 0;
+    int64_t burstFrame = 0;
+    double worstBurstNs = 0.0;
+    int64_t worstBurstFrame = 0;
+
+    // engine thread
+    void record(double ns, int64_t frame);
+
+    // UI thread, the figures may lag a call behind
+    double mean() const;
+    double percentile(double p) const;
+    std::string summary() const;
+    json_t *toJson() const;
+
+    void reset();
+  };
+
+}
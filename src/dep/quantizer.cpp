@@ -3,23 +3,6 @@
 
 namespace quantizer {
 
-  Quantizer::Quantizer() {
-    for (int l=0; l<12; l++) {
-      for(int i=0; i<numScales; i++) {
-        int index = 0;
-        for (int j=0; j<11; j++) {
-          for (int k=0; k<scales[i].numNotes;k++) {
-            float pitch = -5.f + l/12.0f + j + scales[i].intervals[k]/12.0f;
-            if ((pitch>=-4.0f) && (pitch<=6.0f)) {
-              map[l][i][index]=pitch;
-              index++;
-            }
-          }
-        }
-      }
-    }
-  }
-
   std::tuple<float, int> getNearest(float x, float y, float target, int lower, int upper) {
     if (target - x >= y - target)
     {
@@ -64,8 +47,38 @@ namespace quantizer {
    return std::make_tuple(arr[mid],mid);
   }
 
+  Tables::Tables() {
+    for (int l=0; l<12; l++) {
+      for(int i=0; i<numScales; i++) {
+        int index = 0;
+        for (int j=0; j<11; j++) {
+          for (int k=0; k<scales[i].numNotes;k++) {
+            float pitch = -5.f + l/12.0f + j + scales[i].intervals[k]/12.0f;
+            if ((pitch>=-4.0f) && (pitch<=6.0f)) {
+              map[l][i][index]=pitch;
+              index++;
+            }
+          }
+        }
+        if (scales[i].numNotes == 0) continue;
+        for (int c=0; c<gridSize; c++) {
+          nearest[l][i][c] = std::get<1>(getNearestElement(map[l][i], scales[i].numNotes*10, -4.0f + (c + 0.5f) / 24.0f));
+        }
+      }
+    }
+  }
+
+  const Tables& tables() {
+    static const Tables shared;
+    return shared;
+  }
+
+  Quantizer::Quantizer() {
+    t = &tables();
+  }
+
   std::tuple<float, int> Quantizer::quantize(float voltsIn) {
-    return getNearestElement(map[0][26], scales[26].numNotes*10, voltsIn);
+    return closestVoltageInScale(voltsIn, -1, 26);
   }
 
   std::string Quantizer::noteName(float voltsIn) {
@@ -86,18 +99,6 @@ namespace quantizer {
 
 
 
-  std::tuple<float, int> Quantizer::closestVoltageInScale(float voltsIn, int rootNote, int scale) {
-    if (scale == 0) {
-      return std::make_tuple(voltsIn,0);
-    }
-    else if (rootNote==-1) {
-      return Quantizer::quantize(voltsIn);
-    }
-    else {
-      return getNearestElement(map[rootNote][scale], scales[scale].numNotes*10, voltsIn);
-    }
-  }
-
   Chord Quantizer::closestChordInScale(float voltsIn, int rootNote, int scale) {
     Chord result;
     if (scale == 0) {
@@ -124,16 +125,36 @@ namespace quantizer {
     else {
       float pitch;
       int index;
-      std::tie(pitch, index) = getNearestElement(map[rootNote][scale], scales[scale].numNotes*10, voltsIn);
+      std::tie(pitch, index) = closestVoltageInScale(voltsIn, rootNote, scale);
       result.tonic = pitch;
-      result.third = map[rootNote][scale][rack::math::clamp(index+2,0,scales[scale].numNotes*10)];
-      result.fifth = map[rootNote][scale][rack::math::clamp(index+4,0,scales[scale].numNotes*10)];
-      result.seventh = map[rootNote][scale][rack::math::clamp(index+6,0,scales[scale].numNotes*10)];
-      result.ninth = map[rootNote][scale][rack::math::clamp(index+8,0,scales[scale].numNotes*10)];
-      result.eleventh = map[rootNote][scale][rack::math::clamp(index+10,0,scales[scale].numNotes*10)];
-      result.thirteenth = map[rootNote][scale][rack::math::clamp(index+12,0,scales[scale].numNotes*10)];
+      result.third = t->map[rootNote][scale][rack::math::clamp(index+2,0,scales[scale].numNotes*10)];
+      result.fifth = t->map[rootNote][scale][rack::math::clamp(index+4,0,scales[scale].numNotes*10)];
+      result.seventh = t->map[rootNote][scale][rack::math::clamp(index+6,0,scales[scale].numNotes*10)];
+      result.ninth = t->map[rootNote][scale][rack::math::clamp(index+8,0,scales[scale].numNotes*10)];
+      result.eleventh = t->map[rootNote][scale][rack::math::clamp(index+10,0,scales[scale].numNotes*10)];
+      result.thirteenth = t->map[rootNote][scale][rack::math::clamp(index+12,0,scales[scale].numNotes*10)];
     }
     return result;
   }
 
+  void Quantizer::closestChordInScale(const rack::simd::float_4 inVolts, const int *rootNote, const int *scale, rack::simd::float_4 *tones) {
+    for (int lane=0; lane<4; lane++) {
+      if (scale[lane] == 0) {
+        for (int k=0; k<7; k++) tones[k][lane] = inVolts[lane];
+      }
+      else if (rootNote[lane] == -1) {
+        float pitch = std::get<0>(quantize(inVolts[lane]));
+        for (int k=0; k<7; k++) tones[k][lane] = pitch;
+      }
+      else {
+        // The degree row of the shared map already holds every chord tone,
+        // they are two scale steps apart starting from the nearest degree.
+        const float *degrees = t->map[rootNote[lane]][scale[lane]];
+        int last = scales[scale[lane]].numNotes*10;
+        int index = nearest(rootNote[lane], scale[lane], inVolts[lane]);
+        for (int k=0; k<7; k++) tones[k][lane] = degrees[std::min(index+2*k, last)];
+      }
+    }
+  }
+
 }
@@ -96,9 +96,28 @@ namespace quantizer {
   };
 
 
-  struct Quantizer {
+  static constexpr int gridSize = 241;
 
+  // Scale tables shared by every quantizer, built once on first use.
+  struct Tables {
     float map[12][numScales][121] = {{{0.0f}}};
+    // Index of the nearest note for each 1/24V cell from -4V to 6V. Midpoints
+    // between two notes always fall on a cell edge, so one lookup is exact up
+    // to the rounding of the table, see Quantizer::nearest().
+    uint8_t nearest[12][numScales][gridSize] = {{{0}}};
+
+    Tables();
+  };
+
+  const Tables& tables();
+
+  inline int gridCell(const float voltsIn) {
+    return (int)std::floor(rack::math::clamp((voltsIn + 4.0f) * 24.0f, 0.0f, (float)(gridSize - 1)));
+  }
+
+  struct Quantizer {
+
+    const Tables *t;
 
     Quantizer();
 
@@ -108,10 +127,51 @@ namespace quantizer {
 
     std::string scaleName(int scale);
 
-    std::tuple<float, int> closestVoltageInScale(const float inVolts, const int rootNote, const int scale);
+    // The table pitches are rounded, so an input within an ulp of a midpoint can
+    // be nearer to the note in the next cell. Inputs that close to a cell edge
+    // are settled with the comparison of the former binary search, ties go up.
+    int nearest(const int r, const int s, const float inVolts) const {
+      int index = t->nearest[r][s][gridCell(inVolts)];
+      float x = (inVolts + 4.0f) * 24.0f;
+      if (std::fabs(x - std::floor(x + 0.5f)) < 1e-3f) {
+        const float *notes = t->map[r][s];
+        int last = scales[s].numNotes*10 - 1;
+        if ((index > 0) && (inVolts < notes[index]) && !(inVolts - notes[index-1] >= notes[index] - inVolts)) index--;
+        else if ((index < last) && (inVolts > notes[index]) && (inVolts - notes[index] >= notes[index+1] - inVolts)) index++;
+      }
+      return index;
+    }
+
+    std::tuple<float, int> closestVoltageInScale(const float inVolts, const int rootNote, const int scale) {
+      if (scale == 0) {
+        return std::make_tuple(inVolts, 0);
+      }
+      int r = rootNote == -1 ? 0 : rootNote;
+      int s = rootNote == -1 ? 26 : scale;
+      int index = nearest(r, s, inVolts);
+      return std::make_tuple(t->map[r][s][index], index);
+    }
+
+    // Four voltages against the same root and scale, for polyphonic callers.
+    rack::simd::float_4 closestVoltageInScale(const rack::simd::float_4 inVolts, const int rootNote, const int scale) {
+      if (scale == 0) {
+        return inVolts;
+      }
+      int r = rootNote == -1 ? 0 : rootNote;
+      int s = rootNote == -1 ? 26 : scale;
+      rack::simd::float_4 result;
+      for (int i=0; i<4; i++) {
+        result[i] = t->map[r][s][nearest(r, s, inVolts[i])];
+      }
+      return result;
+    }
 
     Chord closestChordInScale(const float inVolts, const int rootNote, const int scale);
 
+    // Chords for four voltages, each lane with its own root and scale. Tones are
+    // written third by third in tones[0..6], tonic first.
+    void closestChordInScale(const rack::simd::float_4 inVolts, const int *rootNote, const int *scale, rack::simd::float_4 *tones);
+
   };
 
 }
@@ -0,0 +1,79 @@
+#include "recorder.hpp"
+
+namespace recorder {
+
+  ChunkedRecorder::~ChunkedRecorder() {
+    Block *block;
+    while (freeBlocks.pop(block)) delete block;
+    Take take;
+    while (finished.pop(take)) recycle(take);
+    recycle(current);
+    for (Block *b : spare) delete b;
+  }
+
+  void ChunkedRecorder::write(const Frame &frame) {
+    if (!current.last || (current.last->count == BLOCK_SIZE)) {
+      Block *block;
+      if (!freeBlocks.pop(block)) {
+        dropped++;
+        return;
+      }
+      block->count = 0;
+      block->next = nullptr;
+      if (current.last) current.last->next = block;
+      else current.first = block;
+      current.last = block;
+    }
+    current.last->frames[current.last->count++] = frame;
+    current.size++;
+  }
+
+  bool ChunkedRecorder::finish(bool append) {
+    current.append = append;
+    // worker is far behind, the take stays open and goes with the next stop
+    if (!finished.push(current)) return false;
+    current = Take();
+    return true;
+  }
+
+  void ChunkedRecorder::refill(int target) {
+    while (freeBlocks.size() < target) {
+      Block *block;
+      if (spare.empty()) {
+        block = new Block;
+        // touch the pages here rather than on the first write
+        std::memset(block->frames, 0, sizeof(block->frames));
+      }
+      else {
+        block = spare.back();
+        spare.pop_back();
+      }
+      if (!freeBlocks.push(block)) {
+        spare.push_back(block);
+        break;
+      }
+    }
+  }
+
+  bool ChunkedRecorder::next(Take &take) {
+    return finished.pop(take);
+  }
+
+  void ChunkedRecorder::copy(const Take &take, std::vector<Frame> &dst) {
+    dst.reserve(dst.size() + take.size);
+    for (Block *b = take.first; b; b = b->next) {
+      dst.insert(dst.end(), b->frames, b->frames + b->count);
+    }
+  }
+
+  void ChunkedRecorder::recycle(Take &take) {
+    Block *b = take.first;
+    while (b) {
+      Block *next = b->next;
+      spare.push_back(b);
+      b = next;
+    }
+    take = Take();
+  }
+
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include <rack.hpp>
+#include <atomic>
+
+namespace recorder {
+
+  typedef rack::dsp::Frame<2> Frame;
+
+  static const int BLOCK_SIZE = 16384;
+
+  struct Block {
+    Frame frames[BLOCK_SIZE];
+    int count = 0;
+    Block *next = nullptr;
+  };
+
+  // Frames recorded between a record start and stop, as a chain of blocks.
+  struct Take {
+    Block *first = nullptr;
+    Block *last = nullptr;
+    size_t size = 0;
+    bool append = false;
+  };
+
+  // Single producer single consumer ring, wait free on both sides.
+  template <typename T, int N>
+  struct Ring {
+    T items[N];
+    std::atomic<int> head {0};
+    std::atomic<int> tail {0};
+
+    bool push(const T &item) {
+      int t = tail.load(std::memory_order_relaxed);
+      int next = (t + 1) % N;
+      if (next == head.load(std::memory_order_acquire)) return false;
+      items[t] = item;
+      tail.store(next, std::memory_order_release);
+      return true;
+    }
+
+    bool pop(T &item) {
+      int h = head.load(std::memory_order_relaxed);
+      if (h == tail.load(std::memory_order_acquire)) return false;
+      item = items[h];
+      head.store((h + 1) % N, std::memory_order_release);
+      return true;
+    }
+
+    int size() {
+      return (tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire) + N) % N;
+    }
+  };
+
+  // Recording store written by the audio thread without locks or allocations.
+  // Blocks come from a free ring that a worker keeps topped up, finished takes
+  // are handed back to the worker through a second ring. When the free ring
+  // runs dry frames are dropped and counted rather than allocated.
+  struct ChunkedRecorder {
+    Ring<Block*, 64> freeBlocks;
+    Ring<Take, 8> finished;
+    Take current;
+    std::atomic<int> dropped {0};
+    std::vector<Block*> spare;
+
+    ~ChunkedRecorder();
+
+    // audio thread
+    void write(const Frame &frame);
+    bool finish(bool append);
+
+    // worker thread
+    void refill(int target);
+    bool next(Take &take);
+    void copy(const Take &take, std::vector<Frame> &dst);
+    void recycle(Take &take);
+  };
+
+}
@@ -3,159 +3,377 @@
 #define DR_WAV_IMPLEMENTATION
 #include "dr_wav/dr_wav.h"
 #include <dsp/resampler.hpp>
+#include <sys/stat.h>
+#include <map>
+#include <mutex>
+#include <future>
+#include <tuple>
 
 namespace waves {
 
-  std::vector<rack::dsp::Frame<1>> getMonoWav(const std::string path, const float currentSampleRate, std::string &waveFileName, std::string &waveExtension, int &sampleChannels, int &sampleRate, int &sampleCount) {
-    waveFileName = rack::system::getFilename(path);
-    waveExtension = rack::system::getExtension(waveFileName);
-    std::vector<rack::dsp::Frame<1>> result;
-    if (rack::string::uppercase(waveExtension) == ".WAV") {
-      unsigned int c;
-      unsigned int sr;
-      drwav_uint64 sc;
-      float* pSampleData;
-      pSampleData = drwav_open_file_and_read_pcm_frames_f32(path.c_str(), &c, &sr, &sc, NULL);
-      if (pSampleData != NULL)  {
-        sampleChannels = c;
-        sampleRate = sr;
-        for (long long unsigned int i=0; i < sc; i = i + c) {
-          rack::dsp::Frame<1> frame;
-          if (sampleChannels == 2) {
-            frame.samples[0] = (pSampleData[i] + pSampleData[i+1])/2.0f;
-          }
-          else {
-            frame.samples[0] = pSampleData[i];
-          }
-          result.push_back(frame);
-        }
-        sampleCount = sc/c;
-        drwav_free(pSampleData, NULL);
+  template <typename K, typename T>
+  struct SharedCache {
+    std::mutex mutex;
+    std::map<K, std::weak_ptr<const T>> entries;
+    std::map<K, std::shared_future<std::shared_ptr<const T>>> pending;
+
+    template <typename F>
+    std::shared_ptr<const T> get(const K &key, F build) {
+      std::unique_lock<std::mutex> lock(mutex);
+      auto it = entries.find(key);
+      if (it != entries.end()) {
+        std::shared_ptr<const T> entry = it->second.lock();
+        if (entry) return entry;
+      }
+      auto pendingIt = pending.find(key);
+      if (pendingIt != pending.end()) {
+        std::shared_future<std::shared_ptr<const T>> inFlight = pendingIt->second;
+        lock.unlock();
+        return inFlight.get();
+      }
+      std::promise<std::shared_ptr<const T>> promise;
+      pending[key] = promise.get_future().share();
+      lock.unlock();
+
+      std::shared_ptr<const T> entry;
+      try {
+        entry = build();
+      }
+      catch (...) {
+        lock.lock();
+        pending.erase(key);
+        lock.unlock();
+        promise.set_exception(std::current_exception());
+        throw;
       }
+
+      lock.lock();
+      for (auto e = entries.begin(); e != entries.end();) {
+        if (e->second.expired()) e = entries.erase(e); else ++e;
+      }
+      entries[key] = entry;
+      pending.erase(key);
+      lock.unlock();
+      promise.set_value(entry);
+      return entry;
     }
-    else if (rack::string::uppercase(waveExtension) == ".AIFF") {
-      AudioFile<float> audioFile;
-      if (audioFile.load (path.c_str()))  {
-        sampleChannels = audioFile.getNumChannels();
-        sampleRate = audioFile.getSampleRate();
-        sampleCount = audioFile.getNumSamplesPerChannel();
-        for (int i=0; i < sampleCount; i++) {
-          rack::dsp::Frame<1> frame;
-          if (sampleChannels == 2) {
-            frame.samples[0] = (audioFile.samples[0][i] + audioFile.samples[1][i])/2.0f;
-          }
-          else {
-            frame.samples[0] = audioFile.samples[0][i];
-          }
-          result.push_back(frame);
-        }
+  };
+
+  // Path, modification time, target rate, storage and whether the source is kept.
+  typedef std::tuple<std::string, long long, int, int, bool> BufferKey;
+  typedef std::tuple<std::string, long long, int> SourceKey;
+
+  static SharedCache<BufferKey, SampleBuffer<1>> monoCache;
+  static SharedCache<BufferKey, SampleBuffer<2>> stereoCache;
+  static SharedCache<SourceKey, SampleBuffer<1>> monoSources;
+  static SharedCache<SourceKey, SampleBuffer<2>> stereoSources;
+
+  static const int LOAD_CHUNK = 4096;
+
+  long long getModifiedTime(const std::string &path) {
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) return -1;
+    return (long long)st.st_mtime;
+  }
+
+  void toFrame(const float *in, int channels, rack::dsp::Frame<1> &frame) {
+    frame.samples[0] = channels >= 2 ? (in[0] + in[1])/2.0f : in[0];
+  }
+
+  void toFrame(const float *in, int channels, rack::dsp::Frame<2> &frame) {
+    frame.samples[0] = in[0];
+    frame.samples[1] = channels >= 2 ? in[1] : in[0];
+  }
+
+  // Converts and resamples interleaved chunks straight into the final buffer,
+  // which is reserved once from the source length and packed as it fills.
+  template <int CHANNELS>
+  struct ChunkResampler {
+    SampleBuffer<CHANNELS> &buffer;
+    rack::dsp::SampleRateConverter<CHANNELS> conv;
+    std::vector<rack::dsp::Frame<CHANNELS>> in;
+    std::vector<rack::dsp::Frame<CHANNELS>> out;
+    bool resample;
+    size_t expected;
+
+    ChunkResampler(SampleBuffer<CHANNELS> &buffer, int sourceRate, int targetRate, size_t sourceCount) : buffer(buffer) {
+      resample = sourceRate != targetRate;
+      expected = resample ? (size_t)std::ceil((double)sourceCount * targetRate / sourceRate) : sourceCount;
+      if (buffer.storage == STORAGE_FLOAT) buffer.frames.reserve(expected);
+      else buffer.packed.reserve(expected * CHANNELS);
+      in.resize(LOAD_CHUNK);
+      if (resample) {
+        conv.setRates(sourceRate, targetRate);
+        conv.setQuality(SPEEX_RESAMPLER_QUALITY_DESKTOP);
+        out.resize((size_t)std::ceil((double)LOAD_CHUNK * targetRate / sourceRate) + 16);
       }
     }
 
-    if ((sampleRate != currentSampleRate) && (sampleCount>0)) {
-      rack::dsp::SampleRateConverter<1> conv;
-      conv.setRates(sampleRate, currentSampleRate);
-      conv.setQuality(SPEEX_RESAMPLER_QUALITY_DESKTOP);
-      int outCount = sampleCount;
-      std::vector<rack::dsp::Frame<1>> subResult;
-      for (int i=0;i<sampleCount;i++) {
-        rack::dsp::Frame<1> frame;
-        frame.samples[0]=0.0f;
-        subResult.push_back(frame);
-      }
-      conv.process(&result[0], &sampleCount, &subResult[0], &outCount);
-      sampleCount = outCount;
-      return subResult;
+    void append(const rack::dsp::Frame<CHANNELS> *chunk, size_t count) {
+      if (buffer.storage == STORAGE_FLOAT) {
+        buffer.frames.insert(buffer.frames.end(), chunk, chunk + count);
+        return;
+      }
+      const float *in = chunk[0].samples;
+      size_t n = count * CHANNELS;
+      size_t pos = buffer.packed.size();
+      buffer.packed.resize(pos + n);
+      uint16_t *out = &buffer.packed[pos];
+      if (buffer.storage == STORAGE_INT16) {
+        for (size_t i = 0; i < n; i++) out[i] = toInt16(in[i]);
+      }
+      else {
+        for (size_t i = 0; i < n; i++) out[i] = toHalf(in[i]);
+      }
     }
 
-    return result;
-  }
+    void push(const rack::dsp::Frame<CHANNELS> *chunk, int count) {
+      if (!resample) {
+        append(chunk, count);
+        return;
+      }
+      while (count > 0) {
+        int inCount = count;
+        int outCount = out.size();
+        conv.process(chunk, &inCount, &out[0], &outCount);
+        size_t room = buffer.size() < expected ? expected - buffer.size() : 0;
+        append(&out[0], std::min((size_t)outCount, room));
+        if ((inCount == 0) && (outCount == 0)) break;
+        chunk += inCount;
+        count -= inCount;
+      }
+    }
 
-  std::vector<rack::dsp::Frame<2>> getStereoWav(const std::string path, const float currentSampleRate, std::string &waveFileName, std::string &waveExtension, int &sampleChannels, int &sampleRate, int &sampleCount) {
-    waveFileName = rack::system::getFilename(path);
-    waveExtension = rack::system::getExtension(waveFileName);
-    std::vector<rack::dsp::Frame<2>> result;
-    if (rack::string::uppercase(waveExtension) == ".WAV") {
-      unsigned int c;
-      unsigned int sr;
-      drwav_uint64 sc;
-      float* pSampleData;
-      pSampleData = drwav_open_file_and_read_pcm_frames_f32(path.c_str(), &c, &sr, &sc, NULL);
-      if (pSampleData != NULL)  {
-        sampleChannels = c;
-        sampleRate = sr;
-        for (long long unsigned int i=0; i < sc; i = i + c) {
-          rack::dsp::Frame<2> frame;
-          frame.samples[0] = pSampleData[i];
-  				if (sampleChannels == 2)
-  					frame.samples[1] = (float)pSampleData[i+1];
-  				else
-  					frame.samples[1] = (float)pSampleData[i];
-          result.push_back(frame);
+    void push(const float *interleaved, int count, int channels) {
+      for (int i = 0; i < count; i++) {
+        toFrame(interleaved + i*channels, channels, in[i]);
+      }
+      push(&in[0], count);
+    }
+
+    // Pushes silence through the filter so the tail comes out, then pads to length.
+    void finish() {
+      if (resample) {
+        std::fill(in.begin(), in.end(), rack::dsp::Frame<CHANNELS>());
+        for (int i = 0; (i < 4) && (buffer.size() < expected); i++) {
+          push(&in[0], LOAD_CHUNK);
         }
-        sampleCount = sc/c;
-        drwav_free(pSampleData, NULL);
       }
+      if (buffer.storage == STORAGE_FLOAT) buffer.frames.resize(expected);
+      else buffer.packed.resize(expected * CHANNELS);
     }
-    else if (rack::string::uppercase(waveExtension) == ".AIFF") {
+  };
+
+  // A target rate of 0 keeps the rate of the file.
+  template <int CHANNELS>
+  std::shared_ptr<SampleBuffer<CHANNELS>> loadFile(const std::string &path, long long mtime, int targetRate, int storage) {
+    std::shared_ptr<SampleBuffer<CHANNELS>> buffer = std::make_shared<SampleBuffer<CHANNELS>>();
+    buffer->storage = storage;
+    buffer->source.path = path;
+    buffer->source.mtime = mtime;
+    buffer->sampleRate = targetRate;
+    std::string extension = rack::string::uppercase(rack::system::getExtension(rack::system::getFilename(path)));
+    if (extension == ".WAV") {
+      drwav wav;
+      if (!drwav_init_file(&wav, path.c_str(), NULL)) return buffer;
+      int c = wav.channels;
+      if ((c > 0) && (wav.sampleRate > 0) && (wav.totalPCMFrameCount > 0)) {
+        buffer->source.channels = c;
+        buffer->source.sampleRate = wav.sampleRate;
+        if (targetRate <= 0) targetRate = buffer->sampleRate = wav.sampleRate;
+        ChunkResampler<CHANNELS> resampler(*buffer, wav.sampleRate, targetRate, wav.totalPCMFrameCount);
+        std::vector<float> interleaved(LOAD_CHUNK * c);
+        int sc = 0;
+        drwav_uint64 read;
+        while ((read = drwav_read_pcm_frames_f32(&wav, LOAD_CHUNK, &interleaved[0])) > 0) {
+          resampler.push(&interleaved[0], read, c);
+          sc += read;
+        }
+        buffer->source.sampleCount = sc;
+        resampler.expected = resampler.resample ? (size_t)std::ceil((double)sc * targetRate / wav.sampleRate) : sc;
+        resampler.finish();
+      }
+      drwav_uninit(&wav);
+    }
+    else if (extension == ".AIFF") {
       AudioFile<float> audioFile;
       if (audioFile.load (path.c_str()))  {
-        sampleChannels = audioFile.getNumChannels();
-        sampleRate = audioFile.getSampleRate();
-        sampleCount = audioFile.getNumSamplesPerChannel();
-        for (int i=0; i < sampleCount; i++) {
-          rack::dsp::Frame<2> frame;
-          frame.samples[0] = audioFile.samples[0][i];
-  				if (sampleChannels == 2)
-  					frame.samples[1] = audioFile.samples[1][i];
-  				else
-  					frame.samples[1] = audioFile.samples[0][i];
-          result.push_back(frame);
+        int c = audioFile.getNumChannels();
+        int sc = audioFile.getNumSamplesPerChannel();
+        if ((c > 0) && (sc > 0)) {
+          buffer->source.channels = c;
+          buffer->source.sampleRate = audioFile.getSampleRate();
+          buffer->source.sampleCount = sc;
+          if (targetRate <= 0) targetRate = buffer->sampleRate = buffer->source.sampleRate;
+          ChunkResampler<CHANNELS> resampler(*buffer, buffer->source.sampleRate, targetRate, sc);
+          std::vector<float> interleaved(LOAD_CHUNK * c);
+          for (int i = 0; i < sc; i += LOAD_CHUNK) {
+            int count = std::min(LOAD_CHUNK, sc - i);
+            for (int k = 0; k < count; k++) {
+              for (int j = 0; j < c; j++) {
+                interleaved[k*c+j] = audioFile.samples[j][i+k];
+              }
+            }
+            resampler.push(&interleaved[0], count, c);
+          }
+          resampler.finish();
         }
       }
     }
+    return buffer;
+  }
 
-    if ((sampleRate != currentSampleRate) && (sampleCount>0)) {
-      rack::dsp::SampleRateConverter<2> conv;
-      conv.setRates(sampleRate, currentSampleRate);
-      conv.setQuality(SPEEX_RESAMPLER_QUALITY_DESKTOP);
-      int outCount = 16*sampleCount;
-      std::vector<rack::dsp::Frame<2>> subResult;
-      for (int i=0;i<outCount;i++) {
-        rack::dsp::Frame<2> frame;
-        frame.samples[0]=0.0f;
-        frame.samples[1]=0.0f;
-        subResult.push_back(frame);
-      }
-      conv.process(&result[0], &sampleCount, &subResult[0], &outCount);
-      sampleCount = outCount;
-      return subResult;
+  // Resamples a kept source from memory, chunk by chunk like a file.
+  template <int CHANNELS>
+  std::shared_ptr<const SampleBuffer<CHANNELS>> resampleSource(const std::shared_ptr<const SampleBuffer<CHANNELS>> &origin, int targetRate) {
+    if ((origin->sampleRate == targetRate) || (origin->source.sampleCount <= 0)) return origin;
+    std::shared_ptr<SampleBuffer<CHANNELS>> buffer = std::make_shared<SampleBuffer<CHANNELS>>();
+    buffer->source = origin->source;
+    buffer->storage = origin->storage;
+    buffer->sampleRate = targetRate;
+    buffer->origin = origin;
+    size_t count = origin->size();
+    ChunkResampler<CHANNELS> resampler(*buffer, origin->sampleRate, targetRate, count);
+    std::vector<rack::dsp::Frame<CHANNELS>> chunk(LOAD_CHUNK);
+    for (size_t i = 0; i < count; i += LOAD_CHUNK) {
+      size_t n = std::min((size_t)LOAD_CHUNK, count - i);
+      origin->read(i, n, &chunk[0]);
+      resampler.push(&chunk[0], n);
     }
+    resampler.finish();
+    return buffer;
+  }
+
+  template <int CHANNELS>
+  SharedSample<CHANNELS> acquireWav(SharedCache<BufferKey, SampleBuffer<CHANNELS>> &cache, SharedCache<SourceKey, SampleBuffer<CHANNELS>> &sources, const std::string &path, const float currentSampleRate, std::string &waveFileName, std::string &waveExtension, int &sampleChannels, int &sampleRate, int &sampleCount, int storage, bool keepSource) {
+    waveFileName = rack::system::getFilename(path);
+    waveExtension = rack::system::getExtension(waveFileName);
+    long long mtime = getModifiedTime(path);
+    int targetRate = (int)std::round(currentSampleRate);
+    SharedSample<CHANNELS> result;
+    if (mtime < 0) return result;
+
+    result.buffer = cache.get(BufferKey(path, mtime, targetRate, storage, keepSource), [&]() -> std::shared_ptr<const SampleBuffer<CHANNELS>> {
+      if (!keepSource) return loadFile<CHANNELS>(path, mtime, targetRate, storage);
+      std::shared_ptr<const SampleBuffer<CHANNELS>> origin = sources.get(SourceKey(path, mtime, storage), [&]() {
+        return loadFile<CHANNELS>(path, mtime, 0, storage);
+      });
+      return resampleSource<CHANNELS>(origin, targetRate);
+    });
 
+    if (result.buffer->source.sampleCount > 0) {
+      sampleChannels = result.buffer->source.channels;
+      sampleRate = result.buffer->source.sampleRate;
+      sampleCount = result.size();
+    }
+    else {
+      result.clear();
+    }
     return result;
   }
 
-  void saveWave(std::vector<rack::dsp::Frame<2>> &sample, int sampleRate, std::string path) {
-    drwav_data_format format;
-    format.container = drwav_container_riff;
-    format.format = DR_WAVE_FORMAT_PCM;
-    format.channels = 2;
-    format.sampleRate = sampleRate;
-    format.bitsPerSample = 32;
-
-    int *pSamples = (int*)calloc(2*sample.size(),sizeof(int));
-    memset(pSamples, 0, 2*sample.size()*sizeof(int));
-    for (unsigned int i = 0; i < sample.size(); i++) {
-    	*(pSamples+2*i)= floor(sample[i].samples[0]*1990000000);
-    	*(pSamples+2*i+1)= floor(sample[i].samples[1]*1990000000);
-    }
+  MonoSample acquireMonoWav(const std::string path, const float currentSampleRate, std::string &waveFileName, std::string &waveExtension, int &sampleChannels, int &sampleRate, int &sampleCount, int storage, bool keepSource) {
+    return acquireWav<1>(monoCache, monoSources, path, currentSampleRate, waveFileName, waveExtension, sampleChannels, sampleRate, sampleCount, storage, keepSource);
+  }
+
+  StereoSample acquireStereoWav(const std::string path, const float currentSampleRate, std::string &waveFileName, std::string &waveExtension, int &sampleChannels, int &sampleRate, int &sampleCount, int storage, bool keepSource) {
+    return acquireWav<2>(stereoCache, stereoSources, path, currentSampleRate, waveFileName, waveExtension, sampleChannels, sampleRate, sampleCount, storage, keepSource);
+  }
+
+  // Private copies skip the pool and take the decoded frames over, so they never exist twice.
+  template <int CHANNELS>
+  std::vector<rack::dsp::Frame<CHANNELS>> getWav(const std::string &path, const float currentSampleRate, std::string &waveFileName, std::string &waveExtension, int &sampleChannels, int &sampleRate, int &sampleCount) {
+    waveFileName = rack::system::getFilename(path);
+    waveExtension = rack::system::getExtension(waveFileName);
+    long long mtime = getModifiedTime(path);
+    if (mtime < 0) return std::vector<rack::dsp::Frame<CHANNELS>>();
+    std::shared_ptr<SampleBuffer<CHANNELS>> buffer = loadFile<CHANNELS>(path, mtime, (int)std::round(currentSampleRate), STORAGE_FLOAT);
+    if (buffer->source.sampleCount <= 0) return std::vector<rack::dsp::Frame<CHANNELS>>();
+    sampleChannels = buffer->source.channels;
+    sampleRate = buffer->source.sampleRate;
+    sampleCount = buffer->frames.size();
+    return std::move(buffer->frames);
+  }
 
+  std::vector<rack::dsp::Frame<1>> getMonoWav(const std::string path, const float currentSampleRate, std::string &waveFileName, std::string &waveExtension, int &sampleChannels, int &sampleRate, int &sampleCount) {
+    return getWav<1>(path, currentSampleRate, waveFileName, waveExtension, sampleChannels, sampleRate, sampleCount);
+  }
+
+  std::vector<rack::dsp::Frame<2>> getStereoWav(const std::string path, const float currentSampleRate, std::string &waveFileName, std::string &waveExtension, int &sampleChannels, int &sampleRate, int &sampleCount) {
+    return getWav<2>(path, currentSampleRate, waveFileName, waveExtension, sampleChannels, sampleRate, sampleCount);
+  }
+
+  static const size_t SAVE_CHUNK = 16384;
+
+  bool saveWave(size_t frameCount, int sampleRate, const std::string &path, WaveFormat format, FrameReader read, const std::atomic<bool> *cancel) {
+    drwav_data_format dataFormat;
+    dataFormat.container = drwav_container_riff;
+    dataFormat.format = format == WAVE_FLOAT32 ? DR_WAVE_FORMAT_IEEE_FLOAT : DR_WAVE_FORMAT_PCM;
+    dataFormat.channels = 2;
+    dataFormat.sampleRate = sampleRate;
+    dataFormat.bitsPerSample = format == WAVE_FLOAT32 ? 32 : 24;
+
+    std::string tmpPath = path + ".tmp";
     drwav wav;
-    drwav_init_file_write(&wav, path.c_str(), &format, NULL);
-    drwav_uint64 framesWritten = drwav_write_pcm_frames(&wav, 2*sample.size(), pSamples);
+    if (!drwav_init_file_write(&wav, tmpPath.c_str(), &dataFormat, NULL)) return false;
+
+    std::vector<rack::dsp::Frame<2>> chunk(SAVE_CHUNK);
+    std::vector<uint8_t> packed(format == WAVE_PCM24 ? SAVE_CHUNK * 2 * 3 : 0);
+    bool ok = true;
+    for (size_t offset = 0; offset < frameCount; offset += SAVE_CHUNK) {
+      size_t count = std::min(SAVE_CHUNK, frameCount - offset);
+      if ((cancel && *cancel) || !read(offset, count, &chunk[0])) {
+        ok = false;
+        break;
+      }
+      const void *data = &chunk[0];
+      if (format == WAVE_PCM24) {
+        uint8_t *out = &packed[0];
+        for (size_t i = 0; i < count; i++) {
+          for (int c = 0; c < 2; c++) {
+            int32_t v = (int32_t)std::lrint(rack::clamp(chunk[i].samples[c], -1.0f, 1.0f) * 8388607.0f);
+            *out++ = v & 0xff;
+            *out++ = (v >> 8) & 0xff;
+            *out++ = (v >> 16) & 0xff;
+          }
+        }
+        data = &packed[0];
+      }
+      if (drwav_write_pcm_frames(&wav, count, data) != count) {
+        ok = false;
+        break;
+      }
+    }
     drwav_uninit(&wav);
 
-    free(pSamples);
+    if (ok) ok = rack::system::rename(tmpPath, path);
+    if (!ok) rack::system::remove(tmpPath);
+    return ok;
+  }
+
+  bool saveWave(const std::vector<rack::dsp::Frame<2>> &sample, int sampleRate, const std::string &path, WaveFormat format) {
+    return saveWave(sample.size(), sampleRate, path, format, [&](size_t offset, size_t count, rack::dsp::Frame<2> *dst) {
+      std::copy(sample.begin() + offset, sample.begin() + offset + count, dst);
+      return true;
+    });
+  }
+
+  WaveWriter::~WaveWriter() {
+    cancel = true;
+    if (thread.joinable()) thread.join();
+  }
+
+  bool WaveWriter::start(size_t frameCount, int sampleRate, const std::string &path, WaveFormat format, FrameReader read, std::function<void(bool)> done) {
+    if (busy) return false;
+    if (thread.joinable()) thread.join();
+    busy = true;
+    cancel = false;
+    thread = std::thread([=]() {
+      bool ok = saveWave(frameCount, sampleRate, path, format, read, &cancel);
+      if (done) done(ok);
+      busy = false;
+    });
+    return true;
   }
 
 }
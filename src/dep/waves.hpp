@@ -1,12 +1,176 @@
 #pragma once
 #include <rack.hpp>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <atomic>
+#include <cstring>
 
 namespace waves {
 
+// Properties of the file a buffer was decoded from.
+struct SampleSource {
+  std::string path;
+  long long mtime = 0;
+  int channels = 0;
+  int sampleRate = 0;
+  int sampleCount = 0;
+};
+
+// How a pooled buffer keeps its samples. The compact modes halve the memory
+// of float frames, int16 clips at full scale, half float keeps 11 bits of
+// mantissa over a wide range.
+enum SampleStorage {
+  STORAGE_FLOAT,
+  STORAGE_INT16,
+  STORAGE_HALF
+};
+
+// Full scale clips, just below 1 on the positive side.
+inline uint16_t toInt16(float x) {
+  return (uint16_t)(int16_t)std::lrint(rack::clamp(x, -1.0f, 32767.0f / 32768.0f) * 32768.0f);
+}
+
+// Integer only conversions rounding to nearest even, so they behave the same
+// with flush to zero on. Out of range values saturate to the largest finite
+// half, infinities and NaN are never produced.
+inline uint16_t toHalf(float x) {
+  uint32_t u;
+  std::memcpy(&u, &x, 4);
+  uint16_t sign = (u >> 16) & 0x8000;
+  u &= 0x7fffffff;
+  if (u >= 0x477ff000) return sign | 0x7bff;
+  if (u < 0x38800000) {
+    if (u < 0x33000000) return sign;
+    int shift = 126 - (u >> 23);
+    uint32_t m = (u & 0x7fffff) | 0x800000;
+    return sign | ((m + (1u << (shift - 1)) - 1 + ((m >> shift) & 1)) >> shift);
+  }
+  return sign | ((u - 0x38000000 + 0xfff + ((u >> 13) & 1)) >> 13);
+}
+
+inline float fromHalf(uint16_t h) {
+  uint32_t u = (h & 0x7fff) << 13;
+  uint32_t sign = (h & 0x8000) << 16;
+  uint32_t normal = sign | (u + 0x38000000);
+  float x;
+  std::memcpy(&x, &normal, 4);
+  float subnormal = (h & 0x3ff) * 5.9604645e-8f;
+  return (h & 0x7c00) ? x : (sign ? -subnormal : subnormal);
+}
+
+// Immutable buffer handed out by the sample pool, resampled to the engine rate.
+// Files are streamed through the resampler in chunks, a sample rate change
+// decodes the file again unless the source was kept. Compact storages keep
+// interleaved samples in packed.
+template <int CHANNELS>
+struct SampleBuffer {
+  SampleSource source;
+  int sampleRate = 0;
+  int storage = STORAGE_FLOAT;
+  std::vector<rack::dsp::Frame<CHANNELS>> frames;
+  std::vector<uint16_t> packed;
+  // The file at its own rate in the same storage, held while any buffer
+  // resampled from it lives. Only set for buffers acquired with keepSource.
+  std::shared_ptr<const SampleBuffer> origin;
+
+  size_t size() const {
+    return storage == STORAGE_FLOAT ? frames.size() : packed.size() / CHANNELS;
+  }
+
+  rack::dsp::Frame<CHANNELS> get(size_t i) const {
+    if (storage == STORAGE_FLOAT) return frames[i];
+    rack::dsp::Frame<CHANNELS> frame;
+    const uint16_t *p = &packed[i * CHANNELS];
+    for (int c = 0; c < CHANNELS; c++) {
+      frame.samples[c] = storage == STORAGE_INT16 ? (int16_t)p[c] * (1.0f / 32768.0f) : fromHalf(p[c]);
+    }
+    return frame;
+  }
+
+  // Converts count frames from start, branch free per sample so it vectorises.
+  void read(size_t start, size_t count, rack::dsp::Frame<CHANNELS> *dst) const {
+    if (storage == STORAGE_FLOAT) {
+      std::copy(frames.begin() + start, frames.begin() + start + count, dst);
+      return;
+    }
+    const uint16_t *p = &packed[start * CHANNELS];
+    float *out = dst[0].samples;
+    size_t n = count * CHANNELS;
+    if (storage == STORAGE_INT16) {
+      for (size_t i = 0; i < n; i++) out[i] = (int16_t)p[i] * (1.0f / 32768.0f);
+    }
+    else {
+      for (size_t i = 0; i < n; i++) out[i] = fromHalf(p[i]);
+    }
+  }
+};
+
+// Refcounted read-only view on a pooled buffer, indexable like the vectors it replaces.
+// Frames are returned by value since compact buffers convert on read.
+template <int CHANNELS>
+struct SharedSample {
+  std::shared_ptr<const SampleBuffer<CHANNELS>> buffer;
+
+  size_t size() const {
+    return buffer ? buffer->size() : 0;
+  }
+
+  rack::dsp::Frame<CHANNELS> operator[](size_t i) const {
+    return buffer->get(i);
+  }
+
+  void read(size_t start, size_t count, rack::dsp::Frame<CHANNELS> *dst) const {
+    buffer->read(start, count, dst);
+  }
+
+  void clear() {
+    buffer.reset();
+  }
+};
+
+typedef SharedSample<1> MonoSample;
+typedef SharedSample<2> StereoSample;
+
+// Pooled loaders, keyed by path, modification time, target rate and storage.
+// Concurrent requests for the same key share a single decode. With keepSource
+// the decoded file stays in memory next to the buffer, at the cost of one more
+// copy in the chosen storage, and a sample rate change resamples from it
+// instead of reading the disk. It is on by default; the modules turn it off
+// with the packed storages, where the copy would undo the saving.
+MonoSample acquireMonoWav(const std::string path, const float currentSampleRate, std::string &waveFileName, std::string &waveExtension, int &sampleChannels, int &sampleRate, int &sampleCount, int storage = STORAGE_FLOAT, bool keepSource = true);
+
+StereoSample acquireStereoWav(const std::string path, const float currentSampleRate, std::string &waveFileName, std::string &waveExtension, int &sampleChannels, int &sampleRate, int &sampleCount, int storage = STORAGE_FLOAT, bool keepSource = true);
+
+// Private copies for modules that edit their buffer.
 std::vector<rack::dsp::Frame<1>> getMonoWav(const std::string path, const float currentSampleRate, std::string &waveFileName, std::string &waveExtension, int &sampleChannels, int &sampleRate, int &sampleCount);
 
 std::vector<rack::dsp::Frame<2>> getStereoWav(const std::string path, const float currentSampleRate, std::string &waveFileName, std::string &waveExtension, int &sampleChannels, int &sampleRate, int &sampleCount);
 
-void saveWave(std::vector<rack::dsp::Frame<2>> &sample, int sampleRate, std::string path);
+enum WaveFormat {
+  WAVE_FLOAT32,
+  WAVE_PCM24
+};
+
+// Fills dst with count frames starting at offset, false aborts the save.
+typedef std::function<bool(size_t offset, size_t count, rack::dsp::Frame<2> *dst)> FrameReader;
+
+// Streams frameCount frames from read to a stereo wav file, chunk by chunk.
+// The file is written next to path and renamed once complete.
+bool saveWave(size_t frameCount, int sampleRate, const std::string &path, WaveFormat format, FrameReader read, const std::atomic<bool> *cancel = nullptr);
+
+bool saveWave(const std::vector<rack::dsp::Frame<2>> &sample, int sampleRate, const std::string &path, WaveFormat format = WAVE_FLOAT32);
+
+// Runs saveWave on its own thread, one file at a time. done is called from
+// that thread with the outcome. The destructor cancels and waits.
+struct WaveWriter {
+  std::thread thread;
+  std::atomic<bool> busy {false};
+  std::atomic<bool> cancel {false};
+
+  ~WaveWriter();
+
+  bool start(size_t frameCount, int sampleRate, const std::string &path, WaveFormat format, FrameReader read, std::function<void(bool)> done);
+};
 
 }
@@ -1,5 +1,6 @@
 #include "plugin.hpp"
 #include <iostream>
+#include <map>
 
 Plugin *pluginInstance;
 
@@ -93,17 +94,42 @@ void BidooWidget::appendContextMenu(Menu *menu) {
 		menu->addChild(construct<BlueItem>(&MenuItem::text, dynamic_cast<BidooModule*>(module)->themeId == 3 ? "Blue ✓" : "Blue", &BlueItem::module, dynamic_cast<BidooModule*>(module), &BlueItem::pWidget, dynamic_cast<BidooWidget*>(this)));
 		menu->addChild(construct<GreenItem>(&MenuItem::text, dynamic_cast<BidooModule*>(module)->themeId == 4 ? "Green ✓" : "Green", &GreenItem::module, dynamic_cast<BidooModule*>(module), &GreenItem::pWidget, dynamic_cast<BidooWidget*>(this)));
 	}));
+	BidooModule *bidooModule = dynamic_cast<BidooModule*>(module);
+	menu->addChild(createSubmenuItem("Profiling", "", [=](ui::Menu* menu) {
+		profiler::ProcessProfile *profile = &bidooModule->processProfile;
+		menu->addChild(createBoolMenuItem("Profile process", "", [=]() {return profile->enabled.load();}, [=](bool on) {profile->enabled = on;}));
+		menu->addChild(createMenuLabel(profile->summary()));
+		menu->addChild(createMenuItem("Copy as JSON", "", [=]() {
+			json_t *rootJ = profile->toJson();
+			json_object_set_new(rootJ, "module", json_string(bidooModule->model->slug.c_str()));
+			json_object_set_new(rootJ, "id", json_integer(bidooModule->id));
+			json_object_set_new(rootJ, "sampleRate", json_real(APP->engine->getSampleRate()));
+			char *text = json_dumps(rootJ, JSON_INDENT(2));
+			glfwSetClipboardString(APP->window->win, text);
+			free(text);
+			json_decref(rootJ);
+		}));
+		menu->addChild(createMenuItem("Reset", "", [=]() {
+			// the engine thread only touches the figures while profiling
+			if (profile->enabled) profile->resetRequested = true;
+			else profile->reset();
+		}));
+	}));
 }
 
 unsigned int packedColor(int r, int g, int b, int a) {
 	return r + (g << 8) + (b << 16) + (a << 24);
 }
 
+// Settings file is read once per session, later reads come from here.
+static int cachedDefaultTheme = -1;
+
 void BidooWidget::writeThemeAndContrastAsDefault() {
 	json_t *settingsJ = json_object();
 
 	// defaultPanelTheme
 	json_object_set_new(settingsJ, "themeDefault", json_integer(defaultPanelTheme));
+	cachedDefaultTheme = defaultPanelTheme;
 
 	std::string settingsFilename = asset::user("Bidoo.json");
 	FILE *file = fopen(settingsFilename.c_str(), "w");
@@ -115,6 +141,11 @@ void BidooWidget::writeThemeAndContrastAsDefault() {
 }
 
 void BidooWidget::readThemeAndContrastFromDefault() {
+	if (cachedDefaultTheme >= 0) {
+		defaultPanelTheme = cachedDefaultTheme;
+		return;
+	}
+
 	std::string settingsFilename = asset::user("Bidoo.json");
 	FILE *file = fopen(settingsFilename.c_str(), "r");
 	if (!file) {
@@ -139,305 +170,131 @@ void BidooWidget::readThemeAndContrastFromDefault() {
 	else {
 		defaultPanelTheme = 0;
 	}
+	cachedDefaultTheme = defaultPanelTheme;
 
 	fclose(file);
 	json_decref(settingsJ);
 	return;
 }
 
-void BidooWidget::prepareThemes(const std::string& filename) {
-	readThemeAndContrastFromDefault();
-
-	setPanel(APP->window->loadSvg(filename));
-	lightPanel = dynamic_cast<SvgPanel*>(getPanel());
+struct ThemeColors {
+	unsigned int background;
+	unsigned int translucent;
+	float translucentOpacity;
+};
 
-	std::shared_ptr<Svg> dSvg;
-	try {
-		dSvg = std::make_shared<Svg>();
-		dSvg->loadFile(filename);
-	}
-	catch (Exception& e) {
-		WARN("%s", e.what());
-		dSvg = NULL;
-	}
+// Dark, black, blue and green, the light theme is the svg file itself.
+static const ThemeColors themeColors[4] = {
+	{packedColor(50, 50, 50, 255), packedColor(80, 80, 80, 255), 0.6f},
+	{packedColor(0, 0, 0, 255), packedColor(60, 60, 60, 255), 0.6f},
+	{packedColor(19, 63, 84, 255), packedColor(60, 60, 60, 255), 0.6f},
+	{packedColor(19, 107, 80, 255), packedColor(60, 60, 60, 255), 0.6f}
+};
 
-	darkPanel = new SvgPanel;
-	darkPanel->setBackground(dSvg);
-	for (NSVGshape *shape = darkPanel->sw->svg->handle->shapes; shape != NULL; shape = shape->next) {
-		std::string sId (shape->id);
-		std::string sScreen ("screen");
-		bool isScreen = sId.find(sScreen)!=std::string::npos;
+// Recoloured panels shared by every widget, built the first time a (file, theme) is shown.
+static std::map<std::pair<std::string, int>, std::shared_ptr<Svg>> themedSvgs;
 
-		if ((shape->fill.color == packedColor(205, 31, 0, 255)) || (shape->stroke.color == packedColor(205, 31, 0, 255))) {
-			shape->fill.color = packedColor(150, 0, 0, 255);
-			shape->stroke.color = packedColor(150, 0, 0, 255);
-		}
-		if (((shape->fill.color == packedColor(0, 0, 0, 255)) || (shape->stroke.color == packedColor(0, 0, 0, 255))) && (!isScreen)) {
-			shape->fill.color = packedColor(180, 180, 180, 255);
-			shape->stroke.color = packedColor(180, 180, 180, 255);
-		}
-		if ((shape->fill.color == packedColor(230, 230, 230, 255)) || (shape->stroke.color == packedColor(230, 230, 230, 255))) {
-			shape->fill.color = packedColor(50, 50, 50, 255);
-			shape->stroke.color = packedColor(50, 50, 50, 255);
-		}
-		if ((shape->fill.color == packedColor(255, 255, 255, 255)) || (shape->stroke.color == packedColor(255, 255, 255, 255))) {
-			shape->fill.color = packedColor(40, 40, 40, 255);
-			shape->stroke.color = packedColor(40, 40, 40, 255);
-		}
-		if (shape->opacity<1) {
-			shape->fill.color = packedColor(80, 80, 80, 255);
-			shape->stroke.color = packedColor(80, 80, 80, 255);
-			shape->opacity = 0.6f;
-		}
+static std::shared_ptr<Svg> loadThemedSvg(const std::string& filename, int theme) {
+	std::pair<std::string, int> key(filename, theme);
+	auto it = themedSvgs.find(key);
+	if (it != themedSvgs.end()) {
+		return it->second;
 	}
-	darkPanel->setVisible(false);
-	addChild(darkPanel);
 
-	std::shared_ptr<Svg> bSvg;
+	std::shared_ptr<Svg> svg;
 	try {
-		bSvg = std::make_shared<Svg>();
-		bSvg->loadFile(filename);
+		svg = std::make_shared<Svg>();
+		svg->loadFile(filename);
 	}
 	catch (Exception& e) {
 		WARN("%s", e.what());
-		bSvg = NULL;
+		svg = NULL;
 	}
 
-	blackPanel = new SvgPanel;
-	blackPanel->setBackground(bSvg);
-	for (NSVGshape *shape = blackPanel->sw->svg->handle->shapes; shape != NULL; shape = shape->next) {
-		std::string sId (shape->id);
-		std::string sScreen ("screen");
-		bool isScreen = sId.find(sScreen)!=std::string::npos;
+	if (svg) {
+		const ThemeColors& colors = themeColors[theme-1];
+		for (NSVGshape *shape = svg->handle->shapes; shape != NULL; shape = shape->next) {
+			std::string sId (shape->id);
+			std::string sScreen ("screen");
+			bool isScreen = sId.find(sScreen)!=std::string::npos;
 
-		if ((shape->fill.color == packedColor(205, 31, 0, 255)) || (shape->stroke.color == packedColor(205, 31, 0, 255))) {
-			shape->fill.color = packedColor(150, 0, 0, 255);
-			shape->stroke.color = packedColor(150, 0, 0, 255);
-		}
-		if (((shape->fill.color == packedColor(0, 0, 0, 255)) || (shape->stroke.color == packedColor(0, 0, 0, 255))) && (!isScreen)) {
-			shape->fill.color = packedColor(180, 180, 180, 255);
-			shape->stroke.color = packedColor(180, 180, 180, 255);
-		}
-		if ((shape->fill.color == packedColor(230, 230, 230, 255)) || (shape->stroke.color == packedColor(230, 230, 230, 255))) {
-			shape->fill.color = packedColor(0, 0, 0, 255);
-			shape->stroke.color = packedColor(0, 0, 0, 255);
-		}
-		if ((shape->fill.color == packedColor(255, 255, 255, 255)) || (shape->stroke.color == packedColor(255, 255, 255, 255))) {
-			shape->fill.color = packedColor(40, 40, 40, 255);
-			shape->stroke.color = packedColor(40, 40, 40, 255);
-		}
-		if (shape->opacity<1) {
-			shape->fill.color = packedColor(60, 60, 60, 255);
-			shape->stroke.color = packedColor(60, 60, 60, 255);
-			shape->opacity = 0.6f;
+			if ((shape->fill.color == packedColor(205, 31, 0, 255)) || (shape->stroke.color == packedColor(205, 31, 0, 255))) {
+				shape->fill.color = packedColor(150, 0, 0, 255);
+				shape->stroke.color = packedColor(150, 0, 0, 255);
+			}
+			if (((shape->fill.color == packedColor(0, 0, 0, 255)) || (shape->stroke.color == packedColor(0, 0, 0, 255))) && (!isScreen)) {
+				shape->fill.color = packedColor(180, 180, 180, 255);
+				shape->stroke.color = packedColor(180, 180, 180, 255);
+			}
+			if ((shape->fill.color == packedColor(230, 230, 230, 255)) || (shape->stroke.color == packedColor(230, 230, 230, 255))) {
+				shape->fill.color = colors.background;
+				shape->stroke.color = colors.background;
+			}
+			if ((shape->fill.color == packedColor(255, 255, 255, 255)) || (shape->stroke.color == packedColor(255, 255, 255, 255))) {
+				shape->fill.color = packedColor(40, 40, 40, 255);
+				shape->stroke.color = packedColor(40, 40, 40, 255);
+			}
+			if (shape->opacity<1) {
+				shape->fill.color = colors.translucent;
+				shape->stroke.color = colors.translucent;
+				shape->opacity = colors.translucentOpacity;
+			}
 		}
 	}
-	blackPanel->setVisible(false);
-	addChild(blackPanel);
 
-	std::shared_ptr<Svg> buSvg;
-	try {
-		buSvg = std::make_shared<Svg>();
-		buSvg->loadFile(filename);
-	}
-	catch (Exception& e) {
-		WARN("%s", e.what());
-		buSvg = NULL;
-	}
+	themedSvgs[key] = svg;
+	return svg;
+}
 
-	bluePanel = new SvgPanel;
-	bluePanel->setBackground(buSvg);
-	for (NSVGshape *shape = bluePanel->sw->svg->handle->shapes; shape != NULL; shape = shape->next) {
-		std::string sId (shape->id);
-		std::string sScreen ("screen");
-		bool isScreen = sId.find(sScreen)!=std::string::npos;
+void BidooWidget::prepareThemes(const std::string& filename) {
+	readThemeAndContrastFromDefault();
 
-		if ((shape->fill.color == packedColor(205, 31, 0, 255)) || (shape->stroke.color == packedColor(205, 31, 0, 255))) {
-			shape->fill.color = packedColor(150, 0, 0, 255);
-			shape->stroke.color = packedColor(150, 0, 0, 255);
-		}
-		if (((shape->fill.color == packedColor(0, 0, 0, 255)) || (shape->stroke.color == packedColor(0, 0, 0, 255))) && (!isScreen)) {
-			shape->fill.color = packedColor(180, 180, 180, 255);
-			shape->stroke.color = packedColor(180, 180, 180, 255);
-		}
-		if ((shape->fill.color == packedColor(230, 230, 230, 255)) || (shape->stroke.color == packedColor(230, 230, 230, 255))) {
-			shape->fill.color = packedColor(19, 63, 84, 255);
-			shape->stroke.color = packedColor(19, 63, 84, 255);
-		}
-		if ((shape->fill.color == packedColor(255, 255, 255, 255)) || (shape->stroke.color == packedColor(255, 255, 255, 255))) {
-			shape->fill.color = packedColor(40, 40, 40, 255);
-			shape->stroke.color = packedColor(40, 40, 40, 255);
-		}
-		if (shape->opacity<1) {
-			shape->fill.color = packedColor(60, 60, 60, 255);
-			shape->stroke.color = packedColor(60, 60, 60, 255);
-			shape->opacity = 0.6f;
-		}
-	}
-	bluePanel->setVisible(false);
-	addChild(bluePanel);
+	themeFilename = filename;
+	setPanel(APP->window->loadSvg(filename));
+	themePanels[0] = dynamic_cast<SvgPanel*>(getPanel());
+}
 
-	std::shared_ptr<Svg> gSvg;
-	try {
-		gSvg = std::make_shared<Svg>();
-		gSvg->loadFile(filename);
+void BidooWidget::showTheme(int theme) {
+	if ((theme < 0) || (theme > 4)) {
+		theme = 4;
 	}
-	catch (Exception& e) {
-		WARN("%s", e.what());
-		gSvg = NULL;
-	}
-
-	greenPanel = new SvgPanel;
-	greenPanel->setBackground(gSvg);
-	for (NSVGshape *shape = greenPanel->sw->svg->handle->shapes; shape != NULL; shape = shape->next) {
-		std::string sId (shape->id);
-		std::string sScreen ("screen");
-		bool isScreen = sId.find(sScreen)!=std::string::npos;
 
-		if ((shape->fill.color == packedColor(205, 31, 0, 255)) || (shape->stroke.color == packedColor(205, 31, 0, 255))) {
-			shape->fill.color = packedColor(150, 0, 0, 255);
-			shape->stroke.color = packedColor(150, 0, 0, 255);
+	if (!themePanels[theme] && (theme > 0)) {
+		std::shared_ptr<Svg> svg = loadThemedSvg(themeFilename, theme);
+		if (!svg) {
+			theme = 0;
 		}
-		if (((shape->fill.color == packedColor(0, 0, 0, 255)) || (shape->stroke.color == packedColor(0, 0, 0, 255))) && (!isScreen)) {
-			shape->fill.color = packedColor(180, 180, 180, 255);
-			shape->stroke.color = packedColor(180, 180, 180, 255);
-		}
-		if ((shape->fill.color == packedColor(230, 230, 230, 255)) || (shape->stroke.color == packedColor(230, 230, 230, 255))) {
-			shape->fill.color = packedColor(19, 107, 80, 255);
-			shape->stroke.color = packedColor(19, 107, 80, 255);
-		}
-		if ((shape->fill.color == packedColor(255, 255, 255, 255)) || (shape->stroke.color == packedColor(255, 255, 255, 255))) {
-			shape->fill.color = packedColor(40, 40, 40, 255);
-			shape->stroke.color = packedColor(40, 40, 40, 255);
+		else {
+			themePanels[theme] = new SvgPanel;
+			themePanels[theme]->setBackground(svg);
+			addChildAbove(themePanels[theme], themePanels[0]);
 		}
-		if (shape->opacity<1) {
-			shape->fill.color = packedColor(60, 60, 60, 255);
-			shape->stroke.color = packedColor(60, 60, 60, 255);
-			shape->opacity = 0.6f;
+	}
+
+	for (int i = 0; i < 5; i++) {
+		if (themePanels[i]) {
+			themePanels[i]->setVisible(i == theme);
 		}
 	}
-	greenPanel->setVisible(false);
-	addChild(greenPanel);
 }
 
 void BidooWidget::step() {
 	if (module) {
-		if ((dynamic_cast<BidooModule*>(module)->loadDefault) && (dynamic_cast<BidooModule*>(module)->themeId == -1)) {
-			dynamic_cast<BidooModule*>(module)->loadDefault = false;
+		BidooModule *bModule = dynamic_cast<BidooModule*>(module);
+		if ((bModule->loadDefault) && (bModule->themeId == -1)) {
+			bModule->loadDefault = false;
 			readThemeAndContrastFromDefault();
-			dynamic_cast<BidooModule*>(module)->themeId = defaultPanelTheme;
-			if (defaultPanelTheme == 0) {
-				lightPanel->setVisible(true);
-				darkPanel->setVisible(false);
-				blackPanel->setVisible(false);
-				bluePanel->setVisible(false);
-				greenPanel->setVisible(false);
-			}
-			else if (defaultPanelTheme == 1) {
-				lightPanel->setVisible(false);
-				darkPanel->setVisible(true);
-				blackPanel->setVisible(false);
-				bluePanel->setVisible(false);
-				greenPanel->setVisible(false);
-			}
-			else if (defaultPanelTheme == 2){
-				lightPanel->setVisible(false);
-				darkPanel->setVisible(false);
-				blackPanel->setVisible(true);
-				bluePanel->setVisible(false);
-				greenPanel->setVisible(false);
-			}
-			else if (defaultPanelTheme == 3){
-				lightPanel->setVisible(false);
-				darkPanel->setVisible(false);
-				blackPanel->setVisible(false);
-				bluePanel->setVisible(true);
-				greenPanel->setVisible(false);
-			}
-			else {
-				lightPanel->setVisible(false);
-				darkPanel->setVisible(false);
-				blackPanel->setVisible(false);
-				bluePanel->setVisible(false);
-				greenPanel->setVisible(true);
-			}
+			bModule->themeId = defaultPanelTheme;
+			showTheme(defaultPanelTheme);
 		}
-		else if (dynamic_cast<BidooModule*>(module)->themeChanged) {
-			dynamic_cast<BidooModule*>(module)->themeChanged = false;
-			if (dynamic_cast<BidooModule*>(module)->themeId == 0) {
-				lightPanel->setVisible(true);
-				darkPanel->setVisible(false);
-				blackPanel->setVisible(false);
-				bluePanel->setVisible(false);
-				greenPanel->setVisible(false);
-			}
-			else if (dynamic_cast<BidooModule*>(module)->themeId == 1) {
-				lightPanel->setVisible(false);
-				darkPanel->setVisible(true);
-				blackPanel->setVisible(false);
-				bluePanel->setVisible(false);
-				greenPanel->setVisible(false);
-			}
-			else if (dynamic_cast<BidooModule*>(module)->themeId == 2){
-				lightPanel->setVisible(false);
-				darkPanel->setVisible(false);
-				blackPanel->setVisible(true);
-				bluePanel->setVisible(false);
-				greenPanel->setVisible(false);
-			}
-			else if (dynamic_cast<BidooModule*>(module)->themeId == 3){
-				lightPanel->setVisible(false);
-				darkPanel->setVisible(false);
-				blackPanel->setVisible(false);
-				bluePanel->setVisible(true);
-				greenPanel->setVisible(false);
-			}
-			else {
-				lightPanel->setVisible(false);
-				darkPanel->setVisible(false);
-				blackPanel->setVisible(false);
-				bluePanel->setVisible(false);
-				greenPanel->setVisible(true);
-			}
+		else if (bModule->themeChanged) {
+			bModule->themeChanged = false;
+			showTheme(bModule->themeId);
 		}
 	}
 	else {
 		readThemeAndContrastFromDefault();
-		if (defaultPanelTheme == 0) {
-			lightPanel->setVisible(true);
-			darkPanel->setVisible(false);
-			blackPanel->setVisible(false);
-			bluePanel->setVisible(false);
-			greenPanel->setVisible(false);
-		}
-		else if (defaultPanelTheme == 1) {
-			lightPanel->setVisible(false);
-			darkPanel->setVisible(true);
-			blackPanel->setVisible(false);
-			bluePanel->setVisible(false);
-			greenPanel->setVisible(false);
-		}
-		else if (defaultPanelTheme == 2){
-			lightPanel->setVisible(false);
-			darkPanel->setVisible(false);
-			blackPanel->setVisible(true);
-			bluePanel->setVisible(false);
-			greenPanel->setVisible(false);
-		}
-		else if (defaultPanelTheme == 3){
-			lightPanel->setVisible(false);
-			darkPanel->setVisible(false);
-			blackPanel->setVisible(false);
-			bluePanel->setVisible(true);
-			greenPanel->setVisible(false);
-		}
-		else {
-			lightPanel->setVisible(false);
-			darkPanel->setVisible(false);
-			blackPanel->setVisible(false);
-			bluePanel->setVisible(false);
-			greenPanel->setVisible(true);
-		}
+		showTheme(defaultPanelTheme);
 	}
 	ModuleWidget::step();
 }
@@ -1,4 +1,5 @@
 #include "rack.hpp"
+#include "dep/profiler.hpp"
 
 using namespace rack;
 
@@ -75,16 +76,33 @@ struct BidooModule : Module {
 	int themeId = -1;
 	bool themeChanged = true;
 	bool loadDefault = true;
+	profiler::ProcessProfile processProfile;
 	json_t *dataToJson() override;
 	void dataFromJson(json_t *rootJ) override;
+
+	// Times the enclosing process() call, a relaxed load and a branch when off.
+	struct ProfileScope {
+		profiler::ProcessProfile *profile = NULL;
+		int64_t frame = 0;
+		std::chrono::steady_clock::time_point start;
+
+		ProfileScope(BidooModule *module, const ProcessArgs &args) {
+			if (module->processProfile.enabled.load(std::memory_order_relaxed)) {
+				profile = &module->processProfile;
+				frame = args.frame;
+				start = std::chrono::steady_clock::now();
+			}
+		}
+
+		~ProfileScope() {
+			if (profile) profile->record(std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count(), frame);
+		}
+	};
 };
 
 struct BidooWidget : ModuleWidget {
-	SvgPanel* lightPanel;
-	SvgPanel* darkPanel;
-	SvgPanel* blackPanel;
-	SvgPanel* bluePanel;
-	SvgPanel* greenPanel;
+	SvgPanel* themePanels[5] = {NULL, NULL, NULL, NULL, NULL};
+	std::string themeFilename;
 	int defaultPanelTheme = 0;
 
 	BidooWidget() {
@@ -149,6 +167,7 @@ struct BidooWidget : ModuleWidget {
 	void writeThemeAndContrastAsDefault();
 	void readThemeAndContrastFromDefault();
 	void prepareThemes(const std::string& filename);
+	void showTheme(int theme);
 	void appendContextMenu(Menu *menu) override;
 	void step() override;
 };
@@ -0,0 +1,140 @@
+// Counts heap allocations made from process() while a sequencer plays and
+// its pattern is edited, which runs Pattern::Update in DTROY and
+// PatternExtended::Update in BORDL, and while LIMONADE records takes and
+// posts wavetable edits. The audio thread must not allocate, only the rig's
+// thread is counted.
+#include "rig.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+namespace {
+  thread_local bool counting = false;
+  long allocations = 0;
+}
+
+void *operator new(std::size_t size) {
+  if (counting) allocations++;
+  void *p = std::malloc(size ? size : 1);
+  if (!p) throw std::bad_alloc();
+  return p;
+}
+
+void *operator new[](std::size_t size) {
+  return operator new(size);
+}
+
+void operator delete(void *p) noexcept {
+  std::free(p);
+}
+
+void operator delete[](void *p) noexcept {
+  std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept {
+  std::free(p);
+}
+
+void operator delete[](void *p, std::size_t) noexcept {
+  std::free(p);
+}
+
+using namespace rig;
+using namespace rig::stimulus;
+
+namespace {
+
+  const int FRAMES = 10 * 44100;
+
+  // Param ids shared by DTROY and BORDL.
+  const int STEPS = 3, PLAY_MODE = 8, COUNT_MODE = 9, PATTERN = 10;
+  const int TRIG_PITCH = 35, TRIG_SLIDE = 43, TRIG_SKIP = 51;
+
+  struct Case {
+    const char *name;
+    plugin::Model *model;
+    int left, right, up, down;
+  };
+
+  // One edit every 50ms: cycles the play modes through random and brownian,
+  // toggles skips and slides, moves pitches and step counts, shifts the
+  // pattern and switches the edited pattern. Buttons are released on the
+  // next frame.
+  void editPattern(Rig &r, const Case &c, int n, bool press) {
+    float v = press ? 1.f : 0.f;
+    switch (n % 8) {
+      case 0: r.param(PLAY_MODE, v); break;
+      case 1: r.param(TRIG_SKIP + n % 5, v); break;
+      case 2: r.param(TRIG_SLIDE + n % 7, v); break;
+      case 3: if (press) r.param(TRIG_PITCH + n % 8, (n % 13) / 6.f - 1.f); break;
+      case 4: if (press) r.param(STEPS, 1 + n % 16); break;
+      case 5: r.param(n % 16 < 8 ? c.left : c.right, v); break;
+      case 6: r.param(n % 16 < 8 ? c.up : c.down, v); break;
+      case 7:
+        if (press) r.param(PATTERN, 1 + n / 8 % 3);
+        r.param(COUNT_MODE, v);
+        break;
+    }
+  }
+
+  // Every 50ms a frame take, then a wavetable edit from the buttons.
+  void editWavetable(Rig &r, int n, bool press) {
+    const int RECFRAME = 11, MORPHWT = 16, NORMALIZEFRAME = 21, WINDOWWT = 24, ADDFRAME = 28, REMOVEFRAME = 29;
+    const int buttons[] = {RECFRAME, ADDFRAME, RECFRAME, MORPHWT, RECFRAME, NORMALIZEFRAME, RECFRAME, WINDOWWT, RECFRAME, REMOVEFRAME};
+    int button = buttons[n % 10];
+    r.param(button, press ? (button == RECFRAME ? 10.f : 1.f) : 0.f);
+  }
+
+  bool report(const char *name, int edits) {
+    bool ok = allocations == 0;
+    std::printf("%-16s %s  %ld allocations over %d edits\n", name, ok ? "ok  " : "FAIL", allocations, edits);
+    return ok;
+  }
+
+}
+
+int main() {
+  const Case cases[] = {
+    {"dtroy", modelDTROY, 59, 60, 61, 62},
+    {"bordl", modelBORDL, 91, 92, 93, 94},
+  };
+
+  int failures = 0;
+  for (const Case &c : cases) {
+    Rig r(c.model);
+    r.input(1 /* EXT_CLOCK */, gate(0.02f, 0.005f)).listen(0).listen(1);
+    r.run(4410);
+
+    const int period = 2205;
+    int edits = 0;
+    allocations = 0;
+    counting = true;
+    for (int i = 0; i < FRAMES; i++) {
+      if (i % period == 0) editPattern(r, c, edits, true);
+      else if (i % period == 1) editPattern(r, c, edits++, false);
+      r.step();
+    }
+    counting = false;
+    failures += !report(c.name, edits);
+  }
+
+  {
+    Rig r(modelLIMONADE);
+    r.input(0 /* PITCH */, constant(0.f)).input(5 /* IN */, sweep(20.f, 2000.f, 10.f)).listen(0);
+    r.run(4410);
+
+    const int period = 2205;
+    int edits = 0;
+    allocations = 0;
+    counting = true;
+    for (int i = 0; i < FRAMES; i++) {
+      if (i % period == 0) editWavetable(r, edits, true);
+      else if (i % period == 1) editWavetable(r, edits++, false);
+      r.step();
+    }
+    counting = false;
+    failures += !report("limonade", edits);
+  }
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,63 @@
+// CPU per module on silence after a loud burst, with flush to zero and
+// denormals are zero cleared as on a host thread that does not set them.
+// Recursive states that decay into denormals show as silent seconds costing
+// many times the loud one.
+#include "rig.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <xmmintrin.h>
+
+using namespace rig;
+using namespace rig::stimulus;
+
+namespace {
+
+  const int RATE = 44100;
+  const int SILENT_SECONDS = 30;
+
+  // One second of noise, then silence.
+  Signal burst(uint32_t seed) {
+    Signal loud = noise(seed);
+    return [=](int64_t frame, float sampleTime) mutable {
+      return frame < RATE ? loud(frame, sampleTime) : 0.f;
+    };
+  }
+
+  struct Case {
+    const char *name;
+    plugin::Model *model;
+    std::vector<int> inputs;
+    std::vector<int> outputs;
+  };
+
+  void bench(const Case &c) {
+    Rig r(c.model, RATE);
+    for (int id : c.inputs) r.input(id, burst(id + 1));
+    for (int id : c.outputs) r.listen(id);
+    double loud = timeIt([&] { r.run(RATE); }) / RATE * 1e9;
+    double worst = 0., last = 0.;
+    for (int s = 0; s < SILENT_SECONDS; s++) {
+      last = timeIt([&] { r.run(RATE); }) / RATE * 1e9;
+      worst = std::max(worst, last);
+    }
+    std::printf("%-8s %9.1f %9.1f %9.1f %7.2fx\n", c.name, loud, worst, last, worst / loud);
+  }
+
+}
+
+int main() {
+  _mm_setcsr(_mm_getcsr() & ~0x8040);
+  const Case cases[] = {
+    {"REI", modelREI, {0, 1}, {0, 1}},
+    {"DFUZE", modelDFUZE, {0}, {0, 1}},
+    {"LIMBO", modelLIMBO, {0, 1}, {0, 1}},
+    {"PERCO", modelPERCO, {0}, {0, 1, 2}},
+    {"BAFIS", modelBAFIS, {0}, {0}},
+    {"ZINC", modelZINC, {0, 1}, {0}},
+    {"HCTIP", modelHCTIP, {0}, {0}},
+  };
+  std::printf("ns/sample, FTZ and DAZ off, 1 s loud then %d s silent\n", SILENT_SECONDS);
+  std::printf("module        loud    silent      last   silent/loud\n");
+  for (const Case &c : cases) bench(c);
+  return 0;
+}
@@ -0,0 +1,89 @@
+// Time per call of the fastmath functions against libm, scalar and per lane
+// of float_4, over 4096 arguments in the range the modules feed them. The
+// stub's float_4 exp and log go lane by lane through libm, so the float_4
+// column of exp2, exp, log2 and the dB conversions says little about Rack's
+// sse_mathfun.
+#include "fastmath.hpp"
+#include "rig.hpp"
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+using rack::simd::float_4;
+
+namespace {
+
+  const int ARGS = 4096;
+  const int REPEATS = 500;
+
+  std::vector<float> arguments(float lo, float hi) {
+    std::vector<float> x(ARGS);
+    uint32_t state = 1;
+    for (float &v : x) {
+      state ^= state << 13;
+      state ^= state >> 17;
+      state ^= state << 5;
+      v = lo + (hi - lo) * ((state >> 8) * (1.f / 16777216.f));
+    }
+    return x;
+  }
+
+  volatile float sink;
+
+  template <typename F>
+  double scalar(const std::vector<float> &x, F f) {
+    return rig::timeIt([&] {
+      float sum = 0.f;
+      for (float v : x) sum += f(v);
+      sink = sum;
+    }, REPEATS) / ARGS * 1e9;
+  }
+
+  template <typename F>
+  double lanes(const std::vector<float> &x, F f) {
+    return rig::timeIt([&] {
+      float_4 sum = 0.f;
+      for (size_t i = 0; i < x.size(); i += 4) sum += f(float_4::load(&x[i]));
+      sink = sum[0] + sum[1] + sum[2] + sum[3];
+    }, REPEATS) / ARGS * 1e9;
+  }
+
+  void row(const char *name, double libm, double fast, double fast4) {
+    std::printf("%-8s %8.2f %8.2f %8.2f\n", name, libm, fast, fast4);
+  }
+
+}
+
+int main() {
+  std::printf("ns per value  libm     fast  float_4\n");
+  std::vector<float> x = arguments(0.01f, 1.4f);
+  row("tan", scalar(x, [](float v) { return std::tan(v); }), scalar(x, [](float v) { return fastmath::tan(v); }),
+    lanes(x, [](float_4 v) { return fastmath::tan(v); }));
+
+  x = arguments(-5.f, 5.f);
+  row("tanh", scalar(x, [](float v) { return std::tanh(v); }), scalar(x, [](float v) { return fastmath::tanh(v); }),
+    lanes(x, [](float_4 v) { return fastmath::tanh(v); }));
+
+  x = arguments(-3.14159f, 3.14159f);
+  row("sin", scalar(x, [](float v) { return std::sin(v); }), scalar(x, [](float v) { return fastmath::sin(v); }),
+    lanes(x, [](float_4 v) { return fastmath::sin(v); }));
+  row("atan2", scalar(x, [](float v) { return std::atan2(v, 0.5f); }), scalar(x, [](float v) { return fastmath::atan2(v, 0.5f); }),
+    lanes(x, [](float_4 v) { return fastmath::atan2(v, float_4(0.5f)); }));
+
+  x = arguments(-10.f, 10.f);
+  row("exp2", scalar(x, [](float v) { return std::exp2(v); }), scalar(x, [](float v) { return fastmath::exp2(v); }),
+    lanes(x, [](float_4 v) { return fastmath::exp2(v); }));
+  row("exp", scalar(x, [](float v) { return std::exp(v); }), scalar(x, [](float v) { return fastmath::exp(v); }),
+    lanes(x, [](float_4 v) { return fastmath::exp(v); }));
+
+  x = arguments(1e-4f, 2.f);
+  row("log2", scalar(x, [](float v) { return std::log2(v); }), scalar(x, [](float v) { return fastmath::log2(v); }),
+    lanes(x, [](float_4 v) { return fastmath::log2(v); }));
+  row("ampToDb", scalar(x, [](float v) { return 20.f * std::log10(v); }), scalar(x, [](float v) { return fastmath::ampToDb(v); }),
+    lanes(x, [](float_4 v) { return fastmath::ampToDb(v); }));
+
+  x = arguments(-60.f, 12.f);
+  row("dbToAmp", scalar(x, [](float v) { return std::pow(10.f, v / 20.f); }), scalar(x, [](float v) { return fastmath::dbToAmp(v); }),
+    lanes(x, [](float_4 v) { return fastmath::dbToAmp(v); }));
+  return 0;
+}
@@ -0,0 +1,123 @@
+// Transient detection on a 300 s stereo take with 578 synthetic onsets,
+// decaying tones of random pitch, level and length over low noise. The
+// detection is CANARD's detectTransients without the lock and version
+// checks: mono mix, spectral flux, peak picking, then the snap back to the
+// preceding zero crossing. An onset is found when a marker lies within one
+// frame of it.
+#include "onsets.hpp"
+#include "rig.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace rig;
+
+namespace {
+
+  const int RATE = 44100;
+  const int SECONDS = 300;
+  const int ONSETS = 578;
+  const int HOP = 256;
+  const int MIN_GAP = 8;
+  const int TOLERANCE = 4 * HOP;
+
+  struct Take {
+    std::vector<dsp::Frame<2>> buffer;
+    std::vector<int> onsets;
+  };
+
+  uint32_t state = 1;
+
+  float uniform(float lo, float hi) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return lo + (hi - lo) * ((state >> 8) * (1.f / 16777216.f));
+  }
+
+  // Onsets spread evenly with up to a quarter of the spacing of jitter.
+  Take makeTake() {
+    Take take;
+    take.buffer.resize(SECONDS * RATE);
+    for (dsp::Frame<2> &f : take.buffer) {
+      f.samples[0] = uniform(-0.01f, 0.01f);
+      f.samples[1] = uniform(-0.01f, 0.01f);
+    }
+    double spacing = (double)take.buffer.size() / (ONSETS + 1);
+    for (int n = 1; n <= ONSETS; n++) {
+      int onset = (int)(n * spacing + uniform(-0.25f, 0.25f) * spacing);
+      float freq = uniform(80.f, 3000.f);
+      float level = uniform(0.2f, 0.8f);
+      float decay = std::exp(-1.f / (uniform(0.03f, 0.2f) * RATE));
+      float pan = uniform(0.3f, 0.7f);
+      float gain = level;
+      for (size_t i = onset; i < take.buffer.size() && gain > 1e-4f; i++) {
+        float s = gain * std::sin(2.f * M_PI * freq * (i - onset) / RATE);
+        take.buffer[i].samples[0] += (1.f - pan) * s;
+        take.buffer[i].samples[1] += pan * s;
+        gain *= decay;
+      }
+      take.onsets.push_back(onset);
+    }
+    return take;
+  }
+
+  std::vector<int> detect(const std::vector<dsp::Frame<2>> &buffer, float threshold) {
+    const int block = 16 * HOP;
+    onsets::SpectralFlux detector(4 * HOP, HOP);
+    std::vector<float> mono(block);
+    std::vector<float> flux;
+    flux.reserve(buffer.size() / HOP + 1);
+    for (size_t pos = 0; pos < buffer.size(); pos += block) {
+      for (int i = 0; i < block; i++) {
+        size_t idx = pos + i;
+        mono[i] = idx < buffer.size() ? 0.5f * (buffer[idx].samples[0] + buffer[idx].samples[1]) : 0.f;
+      }
+      for (int i = 0; (i < block) && (pos + i < buffer.size()); i += HOP) flux.push_back(detector.process(&mono[i]));
+    }
+
+    std::vector<int> result;
+    for (int p : onsets::pickPeaks(flux, threshold, MIN_GAP)) {
+      if (p < MIN_GAP) continue;
+      int onset = p * HOP;
+      for (int k = onset; k > std::max(onset - HOP, 0); k--) {
+        float a = buffer[k-1].samples[0] + buffer[k-1].samples[1];
+        float b = buffer[k].samples[0] + buffer[k].samples[1];
+        if (a * b <= 0.f) {
+          onset = k;
+          break;
+        }
+      }
+      if (result.empty() || onset > result.back()) result.push_back(onset);
+    }
+    return result;
+  }
+
+  void report(const Take &take, float knob) {
+    std::vector<int> markers;
+    double t = timeIt([&] { markers = detect(take.buffer, knob * 0.05f); }, 1);
+    int found = 0;
+    double error = 0.;
+    for (int onset : take.onsets) {
+      std::vector<int>::iterator it = std::lower_bound(markers.begin(), markers.end(), onset);
+      int nearest = TOLERANCE + 1;
+      if (it != markers.end()) nearest = *it - onset;
+      if (it != markers.begin() && onset - *(it - 1) < std::abs(nearest)) nearest = *(it - 1) - onset;
+      if (std::abs(nearest) <= TOLERANCE) {
+        found++;
+        error += std::abs(nearest);
+      }
+    }
+    std::printf("%5.2f %8.0f %5d/%d %9.1f %8d\n", knob, t * 1e3, found, ONSETS, found ? error / found : 0., (int)markers.size());
+  }
+
+}
+
+int main() {
+  Take take = makeTake();
+  std::printf("%d s stereo at %d Hz, %d onsets, found within %d samples\n", SECONDS, RATE, ONSETS, TOLERANCE);
+  std::printf(" knob       ms  found  mean error  markers\n");
+  for (float knob : {0.5f, 1.f, 2.f, 4.f}) report(take, knob);
+  return 0;
+}
@@ -0,0 +1,76 @@
+// Save and load time of a full ZOUMAI and ENCORE pattern bank, legacy
+// per-trig JSON against the compact base64 blob.
+#include "rig.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+using namespace rig;
+
+namespace {
+
+  // All 8 patterns, 8 tracks of 64 active trigs with varied attributes.
+  std::string fullBank() {
+    std::string json = "{";
+    for (int i = 0; i < 8; i++) {
+      json += std::string(i ? ", " : "") + "\"pattern" + std::to_string(i) + "\": {";
+      for (int j = 0; j < 8; j++) {
+        json += std::string(j ? ", " : "") + "\"track" + std::to_string(j) + "\": {\"isActive\": true, \"length\": 64, \"speed\": 2, \"readMode\": 1, \"rootNote\": 3, \"scale\": 2";
+        for (int k = 0; k < 64; k++) {
+          json += ", \"trig" + std::to_string(k) + "\": {\"isActive\": " + (k % 3 ? "true" : "false")
+            + ", \"slide\": 0.25, \"trigType\": 1, \"index\": " + std::to_string(k) + ", \"trim\": 0.1, \"length\": 0.75"
+            + ", \"pulseCount\": 2, \"pulseDistance\": 0.5, \"proba\": 1, \"count\": 3, \"countReset\": 4, \"octave\": 1"
+            + ", \"semitones\": " + std::to_string(k % 12) + ", \"CV1\": 1.5, \"CV2\": -2.5, \"trigSlideType\": true}";
+        }
+        json += "}";
+      }
+      json += "}";
+    }
+    return json + "}";
+  }
+
+  std::string legacyText(Rig &r) {
+    r.data("{\"compactStorage\": false}");
+    json_t *rootJ = r.module->dataToJson();
+    char *s = json_dumps(rootJ, 0);
+    std::string text = s;
+    std::free(s);
+    json_decref(rootJ);
+    return text;
+  }
+
+  bool bench(const char *name, plugin::Model *model, bool compact) {
+    Rig r(model);
+    r.data(fullBank());
+    r.data(compact ? "{\"compactStorage\": true}" : "{\"compactStorage\": false}");
+    std::string text;
+    double save = timeIt([&] {
+      json_t *rootJ = r.module->dataToJson();
+      char *s = json_dumps(rootJ, JSON_INDENT(2) | JSON_REAL_PRECISION(9));
+      text = s;
+      std::free(s);
+      json_decref(rootJ);
+    }, 10);
+    double load = timeIt([&] {
+      json_t *rootJ = json_loads(text.c_str(), 0, NULL);
+      r.module->dataFromJson(rootJ);
+      json_decref(rootJ);
+    }, 10);
+    // The bank must survive the round trip.
+    Rig fresh(model);
+    fresh.data(fullBank());
+    bool same = legacyText(r) == legacyText(fresh);
+    std::printf("%-7s %-7s %9zu bytes  save %8.3f ms  load %8.3f ms  %s\n", name, compact ? "compact" : "legacy",
+      text.size(), save * 1e3, load * 1e3, same ? "round trip ok" : "ROUND TRIP MISMATCH");
+    return same;
+  }
+
+}
+
+int main() {
+  bool ok = bench("ZOUMAI", modelZOUMAI, false);
+  ok &= bench("ZOUMAI", modelZOUMAI, true);
+  ok &= bench("ENCORE", modelENCORE, false);
+  ok &= bench("ENCORE", modelENCORE, true);
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,56 @@
+// Time per closestVoltageInScale call, grid lookup against the binary search
+// it replaced, over random voltages in every root and scale.
+#include "legacy/quantizer.hpp"
+#include "rig.hpp"
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+using namespace quantizer;
+
+namespace {
+
+  const int CALLS = 1 << 20;
+
+  struct Call {
+    float volts;
+    int root;
+    int scale;
+  };
+
+  std::vector<Call> inputs() {
+    std::vector<Call> in(CALLS);
+    uint32_t state = 1;
+    for (int i = 0; i < CALLS; i++) {
+      state ^= state << 13;
+      state ^= state >> 17;
+      state ^= state << 5;
+      in[i] = {-5.f + 12.f * ((state >> 8) * (1.f / 16777216.f)), i % 12, 1 + (i / 12) % (numScales - 1)};
+    }
+    return in;
+  }
+
+}
+
+int main() {
+  std::vector<Call> in = inputs();
+  Quantizer q;
+  std::unique_ptr<legacy::Quantizer> old(new legacy::Quantizer());
+  volatile float sink = 0.f;
+
+  double tNew = rig::timeIt([&] {
+    float sum = 0.f;
+    for (const Call &i : in) sum += std::get<0>(q.closestVoltageInScale(i.volts, i.root, i.scale));
+    sink = sum;
+  }, 5);
+  double tOld = rig::timeIt([&] {
+    float sum = 0.f;
+    for (const Call &i : in) sum += std::get<0>(old->closestVoltageInScale(i.volts, i.root, i.scale));
+    sink = sum;
+  }, 5);
+
+  std::printf("binary search  %6.1f ns per call\n", tOld / CALLS * 1e9);
+  std::printf("grid lookup    %6.1f ns per call\n", tNew / CALLS * 1e9);
+  (void)sink;
+  return 0;
+}
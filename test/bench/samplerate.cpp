@@ -0,0 +1,66 @@
+// Time to follow an engine sample rate change with a pooled ten minute
+// sample, decoding the file again against resampling the kept source. The
+// stub's converter is a windowed sinc like speexdsp's at the quality waves
+// asks for, so the resampling share of the time is close to Rack's.
+#include "rig.hpp"
+#include "waves.hpp"
+#include <cmath>
+#include <cstdio>
+
+using namespace rig;
+
+namespace {
+
+  const char *PATH = "build/samplerate.wav";
+  const int SECONDS = 600;
+
+  bool writeSample() {
+    std::vector<dsp::Frame<2>> sample(SECONDS * 44100);
+    for (size_t i = 0; i < sample.size(); i++) {
+      sample[i].samples[0] = 0.5f * std::sin(i * 0.01f);
+      sample[i].samples[1] = 0.5f * std::sin(i * 0.013f);
+    }
+    return waves::saveWave(sample, 44100, PATH);
+  }
+
+  waves::StereoSample acquire(float rate, int storage, bool keepSource) {
+    std::string name, extension;
+    int channels, sampleRate, count;
+    return waves::acquireStereoWav(PATH, rate, name, extension, channels, sampleRate, count, storage, keepSource);
+  }
+
+  // Largest difference between the kept source and the file path at 48 kHz.
+  float maxDifference(int storage) {
+    waves::StereoSample a = acquire(48000.f, storage, false);
+    waves::StereoSample b = acquire(48000.f, storage, true);
+    if (a.size() != b.size()) return INFINITY;
+    float e = 0.f;
+    for (size_t i = 0; i < a.size(); i++) {
+      for (int c = 0; c < 2; c++) e = std::fmax(e, std::fabs(a[i].samples[c] - b[i].samples[c]));
+    }
+    return e;
+  }
+
+}
+
+int main() {
+  if (!writeSample()) {
+    std::printf("could not write %s\n", PATH);
+    return 1;
+  }
+  const char *storages[] = {"float", "int16", "half"};
+  std::printf("%d s stereo at 44.1 kHz, switching between 44.1 and 48 kHz\n", SECONDS);
+  for (int storage = 0; storage < 3; storage++) {
+    for (bool keepSource : {false, true}) {
+      // The module still holds its buffer while it acquires the next one.
+      waves::StereoSample held = acquire(44100.f, storage, keepSource);
+      int k = 0;
+      double t = timeIt([&] {
+        held = acquire(++k % 2 ? 48000.f : 44100.f, storage, keepSource);
+      }, 4);
+      std::printf("%-6s %-12s %8.1f ms per change\n", storages[storage], keepSource ? "kept source" : "from disk", t * 1e3);
+    }
+    std::printf("%-6s max difference %.3g\n", storages[storage], maxDifference(storage));
+  }
+  return 0;
+}
@@ -0,0 +1,81 @@
+// Memory and read speed of a pooled stereo sample in each storage: block
+// reads as the players do them, frame by frame through operator[], and
+// frames at random positions as a scrubbing or granular read would.
+#include "rig.hpp"
+#include "waves.hpp"
+#include <cmath>
+#include <cstdio>
+
+using namespace rig;
+
+namespace {
+
+  const char *PATH = "build/storagespeed.wav";
+  const int SECONDS = 60;
+  const int BLOCK = 256;
+  const int RANDOM_READS = 1 << 20;
+
+  bool writeSample() {
+    std::vector<dsp::Frame<2>> sample(SECONDS * 44100);
+    for (size_t i = 0; i < sample.size(); i++) {
+      sample[i].samples[0] = 0.5f * std::sin(i * 0.01f);
+      sample[i].samples[1] = 0.5f * std::sin(i * 0.013f);
+    }
+    return waves::saveWave(sample, 44100, PATH);
+  }
+
+  volatile float sink;
+
+  void bench(const char *name, int storage) {
+    std::string fileName, extension;
+    int channels, sampleRate, count;
+    waves::StereoSample s = waves::acquireStereoWav(PATH, 44100.f, fileName, extension, channels, sampleRate, count, storage, false);
+    const waves::SampleBuffer<2> &b = *s.buffer;
+    double mb = (b.frames.capacity() * sizeof(dsp::Frame<2>) + b.packed.capacity() * sizeof(uint16_t)) / 1048576.;
+    size_t n = s.size() / BLOCK * BLOCK;
+
+    std::vector<dsp::Frame<2>> block(BLOCK);
+    double blocks = timeIt([&] {
+      float sum = 0.f;
+      for (size_t i = 0; i < n; i += BLOCK) {
+        s.read(i, BLOCK, block.data());
+        sum += block[BLOCK - 1].samples[0];
+      }
+      sink = sum;
+    }, 5) / n * 1e9;
+
+    double frames = timeIt([&] {
+      float sum = 0.f;
+      for (size_t i = 0; i < n; i++) sum += s[i].samples[1];
+      sink = sum;
+    }, 5) / n * 1e9;
+
+    double random = timeIt([&] {
+      uint32_t state = 1;
+      float sum = 0.f;
+      for (int i = 0; i < RANDOM_READS; i++) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        sum += s[state % n].samples[0];
+      }
+      sink = sum;
+    }, 5) / RANDOM_READS * 1e9;
+
+    std::printf("%-6s %8.1f %10.2f %10.2f %10.2f %10.2f\n", name, mb, blocks, 8. / blocks, frames, random);
+  }
+
+}
+
+int main() {
+  if (!writeSample()) {
+    std::printf("could not write %s\n", PATH);
+    return 1;
+  }
+  std::printf("%d s stereo at 44.1 kHz, ns per frame\n", SECONDS);
+  std::printf("storage    MB     blocks  GB/s out   frames     random\n");
+  bench("float", waves::STORAGE_FLOAT);
+  bench("int16", waves::STORAGE_INT16);
+  bench("half", waves::STORAGE_HALF);
+  return 0;
+}
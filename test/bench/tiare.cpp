@@ -0,0 +1,86 @@
+// TIARE at 1x, 2x and 4x oversampling: CPU time per frame for 1 and 16
+// voices, and the aliased share of each waveform at a 3kHz pitch.
+#include "rig.hpp"
+#include "pffft.h"
+#include <cmath>
+#include <cstdio>
+
+using namespace rig;
+using namespace rig::stimulus;
+
+namespace {
+
+  const int N = 16384;
+  const float SAMPLE_RATE = 44100.f;
+  // 2^3.52 * C4, about 3kHz: seven harmonics below Nyquist, the rest folds.
+  const float PITCH = 3.52f;
+  const char *WAVES[4] = {"sin", "tri", "saw", "sqr"};
+
+  Rig &oversampled(Rig &r, int oversample) {
+    return r.data("{\"oversample\": " + std::to_string(oversample) + "}");
+  }
+
+  double nsPerFrame(int oversample, int voices) {
+    Rig r(modelTIARE);
+    oversampled(r, oversample).input(0 /* PITCH */, constant(1.f), voices);
+    for (int o = 0; o < 4; o++) r.listen(o);
+    r.run(4410);
+    return timeIt([&] { r.run(44100); }, 3) / 44100 * 1e9;
+  }
+
+  // Power outside the harmonics of f0 against the power in them, in dB, from
+  // a Blackman-Harris windowed spectrum.
+  double aliasing(const std::vector<float> &x, double f0) {
+    PFFFT_Setup *setup = pffft_new_setup(N, PFFFT_REAL);
+    float *in = (float*)pffft_aligned_malloc(N * sizeof(float));
+    float *out = (float*)pffft_aligned_malloc(N * sizeof(float));
+    for (int i = 0; i < N; i++) {
+      double p = 2.0 * M_PI * i / N;
+      double w = 0.35875 - 0.48829 * std::cos(p) + 0.14128 * std::cos(2 * p) - 0.01168 * std::cos(3 * p);
+      in[i] = x[i] * w;
+    }
+    pffft_transform_ordered(setup, in, out, NULL, PFFFT_FORWARD);
+
+    const int lobe = 4;
+    double binHz = SAMPLE_RATE / N;
+    double harmonic = 0.0, alias = 0.0;
+    for (int k = lobe + 1; k < N / 2; k++) {
+      double power = (double)out[2 * k] * out[2 * k] + (double)out[2 * k + 1] * out[2 * k + 1];
+      double h = std::round(k * binHz / f0);
+      bool onHarmonic = h >= 1.0 && std::fabs(k - h * f0 / binHz) <= lobe;
+      (onHarmonic ? harmonic : alias) += power;
+    }
+    pffft_aligned_free(in);
+    pffft_aligned_free(out);
+    pffft_destroy_setup(setup);
+    return 10.0 * std::log10(alias / harmonic);
+  }
+
+}
+
+int main() {
+  double f0 = dsp::FREQ_C4 * std::pow(2.0, PITCH);
+  std::printf("ns per frame for 1 and 16 voices, aliased against harmonic power in dB at %.0fHz\n", f0);
+  std::printf("%10s %8s %8s", "oversample", "1 voice", "16");
+  for (const char *w : WAVES) std::printf(" %6s", w);
+  std::printf("\n");
+
+  for (int oversample = 1; oversample <= 4; oversample *= 2) {
+    Rig r(modelTIARE);
+    // Digital mode, the analog drift would smear the harmonics.
+    r.param(2 /* MODE */, 0.f);
+    oversampled(r, oversample).input(0 /* PITCH */, constant(PITCH));
+    for (int o = 0; o < 4; o++) r.listen(o);
+    r.run(4410);
+    std::vector<float> frames = r.render(N);
+
+    std::printf("%9dx %8.1f %8.1f", oversample, nsPerFrame(oversample, 1), nsPerFrame(oversample, 16));
+    for (int w = 0; w < 4; w++) {
+      std::vector<float> wave(N);
+      for (int i = 0; i < N; i++) wave[i] = frames[4 * i + w];
+      std::printf(" %6.1f", aliasing(wave, f0));
+    }
+    std::printf("\n");
+  }
+  return 0;
+}
@@ -0,0 +1,84 @@
+// Accuracy of fastmath against double precision libm, swept over the domain
+// each function documents, scalar and float_4. Fails when a function goes
+// past the error bound its comment in fastmath.hpp states.
+#include "fastmath.hpp"
+#include <cmath>
+#include <cstdio>
+#include <functional>
+
+using rack::simd::float_4;
+
+namespace {
+
+  const int POINTS = 2000000;
+
+  struct Sweep {
+    const char *name;
+    double lo, hi;
+    // Relative error where set, absolute otherwise.
+    bool relative;
+    double bound;
+    std::function<float(float)> fast;
+    std::function<double(double)> exact;
+  };
+
+  float lane(float_4 v) {
+    return v[2];
+  }
+
+  const Sweep sweeps[] = {
+    {"exp2", -126., 126., true, 3e-7, [](float x) { return fastmath::exp2(x); }, [](double x) { return std::exp2(x); }},
+    {"exp2 x4", -126., 126., true, 5e-6, [](float x) { return lane(fastmath::exp2(float_4(x))); }, [](double x) { return std::exp2(x); }},
+    {"log2", 1e-6, 2., false, 1e-6, [](float x) { return fastmath::log2(x); }, [](double x) { return std::log2(x); }},
+    {"log2 wide", 2., 1e30, true, 1e-7, [](float x) { return fastmath::log2(x); }, [](double x) { return std::log2(x); }},
+    {"log2 x4", 1e-6, 2., false, 1.5e-6, [](float x) { return lane(fastmath::log2(float_4(x))); }, [](double x) { return std::log2(x); }},
+    {"exp", -80., 80., true, 4e-6, [](float x) { return fastmath::exp(x); }, [](double x) { return std::exp(x); }},
+    {"ampToDb", 1e-6, 2., false, 1.2e-5, [](float x) { return fastmath::ampToDb(x); }, [](double x) { return 20. * std::log10(x); }},
+    {"dbToAmp", -120., 24., true, 4e-6, [](float x) { return fastmath::dbToAmp(x); }, [](double x) { return std::pow(10., x / 20.); }},
+    {"tan", 0., 1.2, true, 3e-7, [](float x) { return fastmath::tan(x); }, [](double x) { return std::tan(x); }},
+    {"tan high", 1.2, 1.5, true, 1.5e-6, [](float x) { return fastmath::tan(x); }, [](double x) { return std::tan(x); }},
+    {"tan x4", 0., 1.5, true, 1.5e-6, [](float x) { return lane(fastmath::tan(float_4(x))); }, [](double x) { return std::tan(x); }},
+    {"tanh", -9., 9., false, 2e-7, [](float x) { return fastmath::tanh(x); }, [](double x) { return std::tanh(x); }},
+    {"tanh x4", -9., 9., false, 2e-7, [](float x) { return lane(fastmath::tanh(float_4(x))); }, [](double x) { return std::tanh(x); }},
+    {"sin", -10., 10., false, 4e-7, [](float x) { return fastmath::sin(x); }, [](double x) { return std::sin(x); }},
+    {"cos", -10., 10., false, 4e-7, [](float x) { return fastmath::cos(x); }, [](double x) { return std::cos(x); }},
+    {"sin x4", -10., 10., false, 4e-7, [](float x) { return lane(fastmath::sin(float_4(x))); }, [](double x) { return std::sin(x); }},
+    {"cos x4", -10., 10., false, 4e-7, [](float x) { return lane(fastmath::cos(float_4(x))); }, [](double x) { return std::cos(x); }},
+    // atan2 around the circle of radius 0.7, the argument is the angle.
+    {"atan2", -3.14159, 3.14159, false, 6e-7, [](float t) { return fastmath::atan2(0.7f * std::sin(t), 0.7f * std::cos(t)); },
+      [](double t) { return std::atan2((double)(0.7f * std::sin((float)t)), (double)(0.7f * std::cos((float)t))); }},
+    {"atan2 x4", -3.14159, 3.14159, false, 6e-7, [](float t) { return lane(fastmath::atan2(float_4(0.7f * std::sin(t)), float_4(0.7f * std::cos(t)))); },
+      [](double t) { return std::atan2((double)(0.7f * std::sin((float)t)), (double)(0.7f * std::cos((float)t))); }},
+    {"atan2 y/x", -1e3, 1e3, false, 6e-7, [](float y) { return fastmath::atan2(y, -1.5f); }, [](double y) { return std::atan2(y, -1.5); }},
+  };
+
+}
+
+int main() {
+  int failures = 0;
+  for (const Sweep &s : sweeps) {
+    double worst = 0., at = s.lo;
+    for (int i = 0; i <= POINTS; i++) {
+      float x = (float)(s.lo + (s.hi - s.lo) * i / POINTS);
+      double exact = s.exact(x);
+      double e = std::fabs(s.fast(x) - exact);
+      if (s.relative) e /= std::fabs(exact);
+      if (!(e <= worst)) {
+        worst = e;
+        at = x;
+      }
+    }
+    bool ok = worst <= s.bound;
+    std::printf("%-10s %s  [%g, %g] %s error %.3g at %.7g (bound %.3g)\n", s.name, ok ? "ok  " : "FAIL", s.lo, s.hi,
+      s.relative ? "relative" : "absolute", worst, at, s.bound);
+    failures += !ok;
+  }
+
+  // Edge cases the comments promise.
+  float origin = fastmath::atan2(0.f, 0.f);
+  bool ok = origin == 0.f && fastmath::exp2(200.f) == fastmath::exp2(126.f) && fastmath::flushDenormal(1e-20f) == 0.f
+    && fastmath::flushDenormal(1e-10f) == 1e-10f;
+  std::printf("%-10s %s  atan2(0, 0) = %g, exp2 clamp, flushDenormal\n", "edges", ok ? "ok  " : "FAIL", origin);
+  failures += !ok;
+  return failures ? 1 : 0;
+}
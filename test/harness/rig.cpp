@@ -0,0 +1,156 @@
+#include "rig.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+
+namespace rig {
+
+  Rig::Rig(plugin::Model *model, float sampleRate) : sampleRate(sampleRate) {
+    random::init();
+    module = model->createModule();
+  }
+
+  Rig::~Rig() {
+    engine::Module::RemoveEvent e;
+    module->onRemove(e);
+    delete module;
+  }
+
+  Rig &Rig::param(int paramId, float value) {
+    module->params[paramId].setValue(value);
+    return *this;
+  }
+
+  Rig &Rig::input(int inputId, Signal signal, int channels) {
+    module->inputs[inputId].channels = channels;
+    sources.push_back({inputId, signal});
+    return *this;
+  }
+
+  Rig &Rig::listen(int outputId) {
+    module->outputs[outputId].channels = 1;
+    listened.push_back(outputId);
+    return *this;
+  }
+
+  Rig &Rig::data(const std::string &json) {
+    json_error_t error;
+    json_t *rootJ = json_loads(json.c_str(), 0, &error);
+    if (rootJ) {
+      module->dataFromJson(rootJ);
+      json_decref(rootJ);
+    }
+    return *this;
+  }
+
+  std::string Rig::save() {
+    json_t *rootJ = module->dataToJson();
+    if (!rootJ) return "";
+    char *s = json_dumps(rootJ, 0);
+    std::string text = s;
+    std::free(s);
+    json_decref(rootJ);
+    return text;
+  }
+
+  void Rig::start() {
+    started = true;
+    engine::Module::AddEvent add;
+    module->onAdd(add);
+    engine::Module::SampleRateChangeEvent e;
+    e.sampleRate = sampleRate;
+    e.sampleTime = 1.f / sampleRate;
+    module->onSampleRateChange(e);
+  }
+
+  void Rig::step() {
+    if (!started) start();
+    float sampleTime = 1.f / sampleRate;
+    for (const Source &s : sources) {
+      engine::Input &in = module->inputs[s.inputId];
+      float v = s.signal(frame, sampleTime);
+      for (int c = 0; c < in.channels; c++) in.voltages[c] = v;
+    }
+    engine::Module::ProcessArgs args;
+    args.sampleRate = sampleRate;
+    args.sampleTime = sampleTime;
+    args.frame = frame;
+    module->process(args);
+    for (engine::Module::Expander *x : {&module->leftExpander, &module->rightExpander}) {
+      if (x->messageFlipRequested) {
+        std::swap(x->producerMessage, x->consumerMessage);
+        x->messageFlipRequested = false;
+      }
+    }
+    frame++;
+  }
+
+  void Rig::run(int frames) {
+    for (int i = 0; i < frames; i++) step();
+  }
+
+  std::vector<float> Rig::render(int frames, int stride) {
+    std::vector<float> out;
+    out.reserve((size_t)(frames / stride + 1) * listened.size());
+    for (int i = 0; i < frames; i++) {
+      step();
+      if (i % stride != 0) continue;
+      for (int id : listened) out.push_back(module->outputs[id].getVoltage(0));
+    }
+    return out;
+  }
+
+  namespace stimulus {
+
+    Signal constant(float v) {
+      return [=](int64_t, float) { return v; };
+    }
+
+    Signal impulse(float a, int64_t n) {
+      return [=](int64_t frame, float) { return frame == n ? a : 0.f; };
+    }
+
+    Signal sweep(float f0, float f1, float seconds, float a) {
+      double k = std::log((double)f1 / f0) / seconds;
+      return [=](int64_t frame, float sampleTime) {
+        double t = std::fmin(frame * (double)sampleTime, seconds);
+        double phase = 2.0 * M_PI * f0 * (std::exp(k * t) - 1.0) / k;
+        return (float)(a * std::sin(phase));
+      };
+    }
+
+    Signal noise(uint32_t seed, float a) {
+      uint32_t state = seed ? seed : 1;
+      return [=](int64_t, float) mutable {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return a * ((state >> 8) * (2.f / 16777216.f) - 1.f);
+      };
+    }
+
+    Signal gate(float period, float width, float delay, float a) {
+      return [=](int64_t frame, float sampleTime) {
+        double t = frame * (double)sampleTime - delay;
+        if (t < 0.0) return 0.f;
+        return std::fmod(t, (double)period) < width ? a : 0.f;
+      };
+    }
+
+    Signal ramp(float v0, float v1, float seconds) {
+      return [=](int64_t frame, float sampleTime) {
+        float t = std::fmin(frame * sampleTime / seconds, 1.f);
+        return v0 + (v1 - v0) * t;
+      };
+    }
+
+  }
+
+  double timeIt(std::function<void()> f, int repeats) {
+    auto begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < repeats; i++) f();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - begin).count() / repeats;
+  }
+
+}
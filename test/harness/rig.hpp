@@ -0,0 +1,69 @@
+#pragma once
+#include "plugin.hpp"
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace rig {
+
+  // A signal is sampled once per frame, frame counts from 0.
+  typedef std::function<float(int64_t frame, float sampleTime)> Signal;
+
+  // One module driven the way Rack's engine drives it: add and sample rate
+  // events first, then process() per frame with the inputs written before
+  // and the listened outputs read after. Expander messages are flipped at the
+  // end of each frame.
+  struct Rig {
+    engine::Module *module;
+    float sampleRate;
+    int64_t frame = 0;
+
+    Rig(plugin::Model *model, float sampleRate = 44100.f);
+    ~Rig();
+
+    Rig &param(int paramId, float value);
+    // Connects the input, every channel gets the same signal.
+    Rig &input(int inputId, Signal signal, int channels = 1);
+    // Connects the output so the module sets its channel count.
+    Rig &listen(int outputId);
+    // Calls dataFromJson() with the given text, as a patch load does.
+    Rig &data(const std::string &json);
+    // The text of dataToJson(), as a patch save writes it.
+    std::string save();
+
+    void step();
+    void run(int frames);
+    // Runs and returns channel 0 of the listened outputs, interleaved in the
+    // order they were listened, keeping one frame in every stride.
+    std::vector<float> render(int frames, int stride = 1);
+
+  private:
+    struct Source {
+      int inputId;
+      Signal signal;
+    };
+    std::vector<Source> sources;
+    std::vector<int> listened;
+    bool started = false;
+    void start();
+  };
+
+  namespace stimulus {
+    Signal constant(float v);
+    // One sample of amplitude a at frame n.
+    Signal impulse(float a = 10.f, int64_t n = 0);
+    // Exponential sine sweep from f0 to f1 Hz over the given seconds.
+    Signal sweep(float f0, float f1, float seconds, float a = 5.f);
+    // Uniform white noise in [-a, a], a fixed seed per call site.
+    Signal noise(uint32_t seed, float a = 5.f);
+    // Gates of the given period and width in seconds, a first rising edge
+    // after the given delay.
+    Signal gate(float period, float width, float delay = 0.f, float a = 10.f);
+    // Linear ramp from v0 to v1 over the given seconds, then held.
+    Signal ramp(float v0, float v1, float seconds);
+  }
+
+  // Seconds per call of f averaged over the given repeats.
+  double timeIt(std::function<void()> f, int repeats = 1);
+
+}
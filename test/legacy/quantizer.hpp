@@ -0,0 +1,22 @@
+#pragma once
+#include "dep/quantizer.hpp"
+
+// The quantizer before the shared grid tables: one map per instance and a
+// binary search per call. Kept to check and time the current one against.
+namespace legacy {
+
+  struct Quantizer {
+
+    float map[12][quantizer::numScales][121] = {{{0.0f}}};
+
+    Quantizer();
+
+    std::tuple<float, int> quantize(float voltsIn);
+
+    std::tuple<float, int> closestVoltageInScale(const float inVolts, const int rootNote, const int scale);
+
+    quantizer::Chord closestChordInScale(const float inVolts, const int rootNote, const int scale);
+
+  };
+
+}
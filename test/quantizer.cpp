@@ -0,0 +1,84 @@
+// The grid lookup quantizer against the binary search it replaced, on 2M
+// random voltages spread over every root and scale, then on every cell edge
+// of the grid and the floats next to it, where the midpoints between notes
+// lie and the rounding of the table pitches decides. Results must be equal.
+#include "legacy/quantizer.hpp"
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+using namespace quantizer;
+
+namespace {
+
+  const int INPUTS = 2000000;
+
+  struct Random {
+    uint32_t state = 1;
+    float uniform(float lo, float hi) {
+      state ^= state << 13;
+      state ^= state >> 17;
+      state ^= state << 5;
+      return lo + (hi - lo) * ((state >> 8) * (1.f / 16777216.f));
+    }
+  };
+
+  // Every edge of the 1/24V grid and the floats either side, a little past
+  // both ends of the range.
+  std::vector<float> edges() {
+    std::vector<float> in;
+    for (int k = -100; k <= 148; k++) {
+      float edge = k / 24.0f;
+      in.push_back(std::nextafter(edge, -INFINITY));
+      in.push_back(edge);
+      in.push_back(std::nextafter(edge, INFINITY));
+    }
+    return in;
+  }
+
+}
+
+int main() {
+  Quantizer q;
+  std::unique_ptr<legacy::Quantizer> old(new legacy::Quantizer());
+  Random random;
+  std::vector<float> edge = edges();
+  int edgeInputs = edge.size() * 13 * numScales;
+
+  int failures = 0;
+  for (int i = 0; i < INPUTS + edgeInputs; i++) {
+    int root, scale;
+    float in;
+    if (i < INPUTS) {
+      in = random.uniform(-5.f, 7.f);
+      root = i % 13 - 1;
+      scale = (i / 13) % numScales;
+    }
+    else {
+      int j = i - INPUTS;
+      in = edge[j % edge.size()];
+      root = (j / edge.size()) % 13 - 1;
+      scale = j / edge.size() / 13;
+    }
+
+    float a = std::get<0>(q.closestVoltageInScale(in, root, scale));
+    float b = std::get<0>(old->closestVoltageInScale(in, root, scale));
+    Chord c = q.closestChordInScale(in, root, scale);
+    Chord d = old->closestChordInScale(in, root, scale);
+    rack::simd::float_4 lanes = q.closestVoltageInScale(rack::simd::float_4(in), root, scale);
+
+    bool same = a == b && c.tonic == d.tonic && c.third == d.third && c.fifth == d.fifth && c.seventh == d.seventh
+      && c.ninth == d.ninth && c.eleventh == d.eleventh && c.thirteenth == d.thirteenth;
+    if (lanes[0] != a || lanes[3] != a) {
+      std::printf("FAIL  float_4 lane %g, scalar %g for %.9g root %d scale %d\n", lanes[0], a, in, root, scale);
+      failures++;
+    }
+    else if (!same) {
+      std::printf("FAIL  %.9g root %d scale %d: %.9g, was %.9g\n", in, root, scale, a, b);
+      failures++;
+    }
+  }
+  std::printf("%d random inputs, %d on and around cell edges, %d failures\n", INPUTS, edgeInputs, failures);
+  return failures ? 1 : 0;
+}
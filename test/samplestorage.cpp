@@ -0,0 +1,145 @@
+// Conversions of the compact sample storages. Every half code goes through
+// fromHalf and back, and both directions are checked bit for bit against the
+// F16C instructions where the CPU has them, with flush to zero on and off.
+// int16 is checked for its round trip, rounding and clip, and a float file
+// past full scale is loaded in each storage.
+#include "waves.hpp"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <immintrin.h>
+
+namespace {
+
+  const char *PATH = "build/samplestorage.wav";
+
+  __attribute__((target("f16c"))) float f16cFromHalf(uint16_t h) {
+    return _cvtsh_ss(h);
+  }
+
+  __attribute__((target("f16c"))) uint16_t f16cToHalf(float x) {
+    return _cvtss_sh(x, _MM_FROUND_TO_NEAREST_INT);
+  }
+
+  uint32_t bits(float x) {
+    uint32_t u;
+    std::memcpy(&u, &x, 4);
+    return u;
+  }
+
+  float fromBits(uint32_t u) {
+    float x;
+    std::memcpy(&x, &u, 4);
+    return x;
+  }
+
+  bool finite(uint16_t h) {
+    return (h & 0x7c00) != 0x7c00;
+  }
+
+  int row(const char *name, int errors, const char *what) {
+    std::printf("%-12s %s  %s", name, errors ? "FAIL" : "ok  ", what);
+    if (errors) std::printf(", %d wrong", errors);
+    std::printf("\n");
+    return errors ? 1 : 0;
+  }
+
+  // All finite codes back to the same code, and the reference on every code
+  // and on the floats around each rounding boundary. The reference overflows
+  // to infinity from 65520 where toHalf saturates, those are left out.
+  int half(bool f16c) {
+    int failures = 0, trip = 0, decode = 0, encode = 0;
+    for (uint32_t h = 0; h < 0x10000; h++) {
+      if (!finite(h)) continue;
+      float x = waves::fromHalf(h);
+      trip += waves::toHalf(x) != h;
+      if (!f16c) continue;
+      decode += bits(x) != bits(f16cFromHalf(h));
+      if ((h & 0x7fff) == 0x7bff) continue;
+      // Halfway to the next code, and one float ulp either side of it.
+      uint32_t mid = (bits(x) & 0x80000000) | ((bits(std::fabs(x)) + bits(std::fabs(waves::fromHalf(h + 1)))) / 2);
+      if ((h & 0x7fff) == 0) mid = (bits(x) & 0x80000000) | (bits(waves::fromHalf(1)) / 2);
+      for (uint32_t u : {mid - 1, mid, mid + 1, bits(x) + 1, bits(x) - 1}) {
+        float y = fromBits(u);
+        if (!std::isfinite(y)) continue;
+        encode += waves::toHalf(y) != f16cToHalf(y);
+      }
+    }
+    failures += row("half trip", trip, "63488 finite codes through fromHalf and toHalf");
+    if (f16c) {
+      failures += row("half decode", decode, "fromHalf against vcvtph2ps on 63488 finite codes");
+      failures += row("half encode", encode, "toHalf against vcvtps2ph around every rounding boundary");
+    }
+    int saturate = (waves::toHalf(1e6f) != 0x7bff) + (waves::toHalf(-INFINITY) != 0xfbff) + (waves::toHalf(65520.f) != 0x7bff)
+      + ((waves::toHalf(NAN) & 0x7c00) == 0x7c00);
+    failures += row("half range", saturate, "saturates at 65504, no infinity or NaN");
+    return failures;
+  }
+
+  // Every code from its exact float, rounding to nearest even halfway
+  // between codes, and the clip at full scale.
+  int int16() {
+    int failures = 0, trip = 0, rounding = 0;
+    for (int c = -32768; c <= 32767; c++) {
+      trip += (int16_t)waves::toInt16(c / 32768.f) != c;
+      if (c == 32767) continue;
+      float mid = (c + 0.5f) / 32768.f;
+      int even = (c & 1) ? c + 1 : c;
+      rounding += (int16_t)waves::toInt16(mid) != even;
+      rounding += (int16_t)waves::toInt16(std::nextafter(mid, -2.f)) != c;
+      rounding += (int16_t)waves::toInt16(std::nextafter(mid, 2.f)) != c + 1;
+    }
+    failures += row("int16 trip", trip, "65536 codes from their exact float");
+    failures += row("int16 round", rounding, "nearest, ties to even");
+    int clip = ((int16_t)waves::toInt16(1.f) != 32767) + ((int16_t)waves::toInt16(3.f) != 32767) + ((int16_t)waves::toInt16(-1.f) != -32768)
+      + ((int16_t)waves::toInt16(-3.f) != -32768) + ((int16_t)waves::toInt16(INFINITY) != 32767);
+    failures += row("int16 clip", clip, "full scale clips to 32767/32768 and -1");
+    return failures;
+  }
+
+  // A float file past full scale, read back in each storage.
+  int loaded() {
+    const float values[] = {-3.f, -1.f, -0.25f, 0.f, 1e-6f, 0.5f, 1.f, 1.5f, 70000.f};
+    std::vector<rack::dsp::Frame<2>> sample;
+    for (float v : values) {
+      rack::dsp::Frame<2> f;
+      f.samples[0] = v;
+      f.samples[1] = -v;
+      sample.push_back(f);
+    }
+    if (!waves::saveWave(sample, 44100, PATH)) return row("loaded", 1, "could not write the file");
+    int errors = 0;
+    for (int storage : {waves::STORAGE_FLOAT, waves::STORAGE_INT16, waves::STORAGE_HALF}) {
+      std::string name, extension;
+      int channels, sampleRate, count;
+      waves::StereoSample s = waves::acquireStereoWav(PATH, 44100.f, name, extension, channels, sampleRate, count, storage, false);
+      if (s.size() != sample.size()) {
+        errors++;
+        continue;
+      }
+      for (size_t i = 0; i < s.size(); i++) {
+        for (int c = 0; c < 2; c++) {
+          float v = sample[i].samples[c], expected = v;
+          if (storage == waves::STORAGE_INT16) expected = (int16_t)waves::toInt16(v) / 32768.f;
+          if (storage == waves::STORAGE_HALF) expected = waves::fromHalf(waves::toHalf(v));
+          errors += s[i].samples[c] != expected;
+        }
+      }
+    }
+    return row("loaded", errors, "float file past full scale in the three storages");
+  }
+
+}
+
+int main() {
+  bool f16c = __builtin_cpu_supports("f16c");
+  if (!f16c) std::printf("no F16C on this CPU, half is only checked for its round trip\n");
+  int failures = 0;
+  for (bool ftz : {false, true}) {
+    _mm_setcsr(ftz ? _mm_getcsr() | 0x8040 : _mm_getcsr() & ~0x8040);
+    std::printf("flush to zero %s\n", ftz ? "on" : "off");
+    failures += half(f16c) + int16();
+  }
+  failures += loaded();
+  return failures ? 1 : 0;
+}
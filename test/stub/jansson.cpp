@@ -0,0 +1,505 @@
+#include <jansson.h>
+#include <cmath>
+#include <cstdarg>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct json_t {
+  json_type type;
+  size_t refcount = 1;
+  std::string string;
+  json_int_t integer = 0;
+  double real = 0.0;
+  std::vector<std::pair<std::string, json_t *>> object;
+  std::vector<json_t *> array;
+
+  explicit json_t(json_type type) : type(type) {}
+};
+
+json_type json_typeof(const json_t *json) {
+  return json->type;
+}
+
+json_t *json_object(void) {
+  return new json_t(JSON_OBJECT);
+}
+
+json_t *json_array(void) {
+  return new json_t(JSON_ARRAY);
+}
+
+json_t *json_stringn(const char *value, size_t len) {
+  if (!value) return NULL;
+  json_t *json = new json_t(JSON_STRING);
+  json->string.assign(value, len);
+  return json;
+}
+
+json_t *json_string(const char *value) {
+  return value ? json_stringn(value, std::strlen(value)) : NULL;
+}
+
+json_t *json_integer(json_int_t value) {
+  json_t *json = new json_t(JSON_INTEGER);
+  json->integer = value;
+  return json;
+}
+
+json_t *json_real(double value) {
+  if (!std::isfinite(value)) return NULL;
+  json_t *json = new json_t(JSON_REAL);
+  json->real = value;
+  return json;
+}
+
+json_t *json_true(void) {
+  return new json_t(JSON_TRUE);
+}
+
+json_t *json_false(void) {
+  return new json_t(JSON_FALSE);
+}
+
+json_t *json_null(void) {
+  return new json_t(JSON_NULL);
+}
+
+json_t *json_incref(json_t *json) {
+  if (json) json->refcount++;
+  return json;
+}
+
+void json_decref(json_t *json) {
+  if (!json || --json->refcount > 0) return;
+  for (auto &entry : json->object) json_decref(entry.second);
+  for (json_t *item : json->array) json_decref(item);
+  delete json;
+}
+
+size_t json_object_size(const json_t *object) {
+  return json_is_object(object) ? object->object.size() : 0;
+}
+
+json_t *json_object_get(const json_t *object, const char *key) {
+  if (!json_is_object(object) || !key) return NULL;
+  for (auto &entry : object->object) {
+    if (entry.first == key) return entry.second;
+  }
+  return NULL;
+}
+
+int json_object_set_new(json_t *object, const char *key, json_t *value) {
+  if (!value) return -1;
+  if (!json_is_object(object) || !key) {
+    json_decref(value);
+    return -1;
+  }
+  for (auto &entry : object->object) {
+    if (entry.first == key) {
+      json_decref(entry.second);
+      entry.second = value;
+      return 0;
+    }
+  }
+  object->object.emplace_back(key, value);
+  return 0;
+}
+
+int json_object_set(json_t *object, const char *key, json_t *value) {
+  return json_object_set_new(object, key, json_incref(value));
+}
+
+int json_object_del(json_t *object, const char *key) {
+  if (!json_is_object(object)) return -1;
+  for (auto it = object->object.begin(); it != object->object.end(); ++it) {
+    if (it->first == key) {
+      json_decref(it->second);
+      object->object.erase(it);
+      return 0;
+    }
+  }
+  return -1;
+}
+
+size_t json_array_size(const json_t *array) {
+  return json_is_array(array) ? array->array.size() : 0;
+}
+
+json_t *json_array_get(const json_t *array, size_t index) {
+  return (json_is_array(array) && index < array->array.size()) ? array->array[index] : NULL;
+}
+
+int json_array_set_new(json_t *array, size_t index, json_t *value) {
+  if (!value) return -1;
+  if (!json_is_array(array) || index >= array->array.size()) {
+    json_decref(value);
+    return -1;
+  }
+  json_decref(array->array[index]);
+  array->array[index] = value;
+  return 0;
+}
+
+int json_array_append_new(json_t *array, json_t *value) {
+  if (!value) return -1;
+  if (!json_is_array(array)) {
+    json_decref(value);
+    return -1;
+  }
+  array->array.push_back(value);
+  return 0;
+}
+
+int json_array_append(json_t *array, json_t *value) {
+  return json_array_append_new(array, json_incref(value));
+}
+
+int json_array_insert_new(json_t *array, size_t index, json_t *value) {
+  if (!value) return -1;
+  if (!json_is_array(array) || index > array->array.size()) {
+    json_decref(value);
+    return -1;
+  }
+  array->array.insert(array->array.begin() + index, value);
+  return 0;
+}
+
+int json_array_remove(json_t *array, size_t index) {
+  if (!json_is_array(array) || index >= array->array.size()) return -1;
+  json_decref(array->array[index]);
+  array->array.erase(array->array.begin() + index);
+  return 0;
+}
+
+int json_array_clear(json_t *array) {
+  if (!json_is_array(array)) return -1;
+  for (json_t *item : array->array) json_decref(item);
+  array->array.clear();
+  return 0;
+}
+
+const char *json_string_value(const json_t *string) {
+  return json_is_string(string) ? string->string.c_str() : NULL;
+}
+
+size_t json_string_length(const json_t *string) {
+  return json_is_string(string) ? string->string.size() : 0;
+}
+
+json_int_t json_integer_value(const json_t *integer) {
+  return json_is_integer(integer) ? integer->integer : 0;
+}
+
+double json_real_value(const json_t *real) {
+  return json_is_real(real) ? real->real : 0.0;
+}
+
+double json_number_value(const json_t *json) {
+  if (json_is_integer(json)) return (double)json->integer;
+  if (json_is_real(json)) return json->real;
+  return 0.0;
+}
+
+json_t *json_deep_copy(const json_t *json) {
+  if (!json) return NULL;
+  json_t *copy = new json_t(json->type);
+  copy->string = json->string;
+  copy->integer = json->integer;
+  copy->real = json->real;
+  for (auto &entry : json->object) copy->object.emplace_back(entry.first, json_deep_copy(entry.second));
+  for (json_t *item : json->array) copy->array.push_back(json_deep_copy(item));
+  return copy;
+}
+
+json_t *json_pack(const char *fmt, ...) {
+  va_list args;
+  va_start(args, fmt);
+  json_t *array = json_array();
+  for (const char *f = fmt; *f; f++) {
+    switch (*f) {
+      case 'f': json_array_append_new(array, json_real(va_arg(args, double))); break;
+      case 'i': json_array_append_new(array, json_integer(va_arg(args, int))); break;
+      case 'b': json_array_append_new(array, json_boolean(va_arg(args, int))); break;
+      case 's': json_array_append_new(array, json_string(va_arg(args, const char *))); break;
+      default: break;
+    }
+  }
+  va_end(args);
+  return array;
+}
+
+int json_unpack(json_t *root, const char *fmt, ...) {
+  if (!json_is_array(root)) return -1;
+  va_list args;
+  va_start(args, fmt);
+  size_t index = 0;
+  int result = 0;
+  for (const char *f = fmt; *f && result == 0; f++) {
+    if (!std::strchr("fibs", *f)) continue;
+    json_t *value = json_array_get(root, index++);
+    if (!value) {
+      result = -1;
+      break;
+    }
+    switch (*f) {
+      case 'f': *va_arg(args, double *) = json_number_value(value); break;
+      case 'i': *va_arg(args, int *) = (int)json_integer_value(value); break;
+      case 'b': *va_arg(args, int *) = json_is_true(value); break;
+      case 's': *va_arg(args, const char **) = json_string_value(value); break;
+    }
+  }
+  va_end(args);
+  return result;
+}
+
+static void dumpString(const std::string &s, std::string &out) {
+  out += '"';
+  for (unsigned char c : s) {
+    switch (c) {
+      case '"': out += "\\\""; break;
+      case '\\': out += "\\\\"; break;
+      case '\n': out += "\\n"; break;
+      case '\r': out += "\\r"; break;
+      case '\t': out += "\\t"; break;
+      default:
+        if (c < 0x20) {
+          char buf[8];
+          std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+          out += buf;
+        }
+        else {
+          out += (char)c;
+        }
+    }
+  }
+  out += '"';
+}
+
+static void dump(const json_t *json, size_t flags, int depth, std::string &out) {
+  int indent = flags & 0x1F;
+  int precision = (flags >> 11) & 0x1F;
+  auto newline = [&](int d) {
+    if (indent == 0) return;
+    out += '\n';
+    out.append(d * indent, ' ');
+  };
+  switch (json->type) {
+    case JSON_OBJECT: {
+      out += '{';
+      for (size_t i = 0; i < json->object.size(); i++) {
+        if (i > 0) out += ',';
+        newline(depth + 1);
+        dumpString(json->object[i].first, out);
+        out += indent ? ": " : ":";
+        dump(json->object[i].second, flags, depth + 1, out);
+      }
+      if (!json->object.empty()) newline(depth);
+      out += '}';
+    } break;
+    case JSON_ARRAY: {
+      out += '[';
+      for (size_t i = 0; i < json->array.size(); i++) {
+        if (i > 0) out += ',';
+        newline(depth + 1);
+        dump(json->array[i], flags, depth + 1, out);
+      }
+      if (!json->array.empty()) newline(depth);
+      out += ']';
+    } break;
+    case JSON_STRING: dumpString(json->string, out); break;
+    case JSON_INTEGER: out += std::to_string(json->integer); break;
+    case JSON_REAL: {
+      char buf[48];
+      std::snprintf(buf, sizeof(buf), "%.*g", precision ? precision : 17, json->real);
+      out += buf;
+      if (!std::strpbrk(buf, ".eE")) out += ".0";
+    } break;
+    case JSON_TRUE: out += "true"; break;
+    case JSON_FALSE: out += "false"; break;
+    case JSON_NULL: out += "null"; break;
+  }
+}
+
+char *json_dumps(const json_t *json, size_t flags) {
+  if (!json) return NULL;
+  std::string out;
+  dump(json, flags, 0, out);
+  char *text = (char *)std::malloc(out.size() + 1);
+  std::memcpy(text, out.c_str(), out.size() + 1);
+  return text;
+}
+
+int json_dumpf(const json_t *json, FILE *output, size_t flags) {
+  char *text = json_dumps(json, flags);
+  if (!text) return -1;
+  std::fputs(text, output);
+  std::free(text);
+  return 0;
+}
+
+namespace {
+
+  struct Parser {
+    const char *p;
+    const char *end;
+    bool failed = false;
+
+    void skip() {
+      while (p < end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')) p++;
+    }
+
+    bool literal(const char *word) {
+      size_t n = std::strlen(word);
+      if ((size_t)(end - p) < n || std::strncmp(p, word, n) != 0) return false;
+      p += n;
+      return true;
+    }
+
+    bool parseString(std::string &s) {
+      if (p >= end || *p != '"') return false;
+      p++;
+      while (p < end && *p != '"') {
+        char c = *p++;
+        if (c == '\\' && p < end) {
+          char e = *p++;
+          switch (e) {
+            case 'n': s += '\n'; break;
+            case 'r': s += '\r'; break;
+            case 't': s += '\t'; break;
+            case 'b': s += '\b'; break;
+            case 'f': s += '\f'; break;
+            case 'u': {
+              if (end - p < 4) return false;
+              unsigned code = std::strtoul(std::string(p, 4).c_str(), NULL, 16);
+              p += 4;
+              if (code < 0x80) {
+                s += (char)code;
+              }
+              else if (code < 0x800) {
+                s += (char)(0xC0 | (code >> 6));
+                s += (char)(0x80 | (code & 0x3F));
+              }
+              else {
+                s += (char)(0xE0 | (code >> 12));
+                s += (char)(0x80 | ((code >> 6) & 0x3F));
+                s += (char)(0x80 | (code & 0x3F));
+              }
+            } break;
+            default: s += e;
+          }
+        }
+        else {
+          s += c;
+        }
+      }
+      if (p >= end) return false;
+      p++;
+      return true;
+    }
+
+    json_t *parse() {
+      skip();
+      if (p >= end) return NULL;
+      if (*p == '{') {
+        p++;
+        json_t *object = json_object();
+        skip();
+        if (p < end && *p == '}') {
+          p++;
+          return object;
+        }
+        while (true) {
+          skip();
+          std::string key;
+          if (!parseString(key)) break;
+          skip();
+          if (p >= end || *p != ':') break;
+          p++;
+          json_t *value = parse();
+          if (!value) break;
+          json_object_set_new(object, key.c_str(), value);
+          skip();
+          if (p < end && *p == ',') {
+            p++;
+            continue;
+          }
+          if (p < end && *p == '}') {
+            p++;
+            return object;
+          }
+          break;
+        }
+        json_decref(object);
+        return NULL;
+      }
+      if (*p == '[') {
+        p++;
+        json_t *array = json_array();
+        skip();
+        if (p < end && *p == ']') {
+          p++;
+          return array;
+        }
+        while (true) {
+          json_t *value = parse();
+          if (!value) break;
+          json_array_append_new(array, value);
+          skip();
+          if (p < end && *p == ',') {
+            p++;
+            continue;
+          }
+          if (p < end && *p == ']') {
+            p++;
+            return array;
+          }
+          break;
+        }
+        json_decref(array);
+        return NULL;
+      }
+      if (*p == '"') {
+        std::string s;
+        if (!parseString(s)) return NULL;
+        return json_stringn(s.data(), s.size());
+      }
+      if (literal("true")) return json_true();
+      if (literal("false")) return json_false();
+      if (literal("null")) return json_null();
+      const char *start = p;
+      bool real = false;
+      while (p < end && std::strchr("+-0123456789.eE", *p)) {
+        if (std::strchr(".eE", *p)) real = true;
+        p++;
+      }
+      if (p == start) return NULL;
+      std::string number(start, p);
+      return real ? json_real(std::strtod(number.c_str(), NULL)) : json_integer(std::strtoll(number.c_str(), NULL, 10));
+    }
+  };
+
+}
+
+json_t *json_loads(const char *input, size_t flags, json_error_t *error) {
+  if (!input) return NULL;
+  Parser parser;
+  parser.p = input;
+  parser.end = input + std::strlen(input);
+  json_t *json = parser.parse();
+  if (!json && error) {
+    error->position = parser.p - input;
+    std::snprintf(error->text, sizeof(error->text), "parse error");
+  }
+  return json;
+}
+
+json_t *json_loadf(FILE *input, size_t flags, json_error_t *error) {
+  std::string text;
+  char buf[4096];
+  size_t n;
+  while ((n = std::fread(buf, 1, sizeof(buf), input)) > 0) text.append(buf, n);
+  return json_loads(text.c_str(), flags, error);
+}
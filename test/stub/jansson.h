@@ -0,0 +1,94 @@
+#pragma once
+// Small subset of jansson for the headless builds: the value types, object
+// and array access, and dump/load of compact or indented text.
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+typedef enum {
+  JSON_OBJECT,
+  JSON_ARRAY,
+  JSON_STRING,
+  JSON_INTEGER,
+  JSON_REAL,
+  JSON_TRUE,
+  JSON_FALSE,
+  JSON_NULL
+} json_type;
+
+typedef long long json_int_t;
+
+struct json_t;
+
+typedef struct {
+  int line;
+  int column;
+  int position;
+  char source[80];
+  char text[160];
+} json_error_t;
+
+#define JSON_INDENT(n) ((n) & 0x1F)
+#define JSON_COMPACT 0x20
+#define JSON_REAL_PRECISION(n) (((n) & 0x1F) << 11)
+
+json_type json_typeof(const json_t *json);
+#define json_is_object(json) ((json) && json_typeof(json) == JSON_OBJECT)
+#define json_is_array(json) ((json) && json_typeof(json) == JSON_ARRAY)
+#define json_is_string(json) ((json) && json_typeof(json) == JSON_STRING)
+#define json_is_integer(json) ((json) && json_typeof(json) == JSON_INTEGER)
+#define json_is_real(json) ((json) && json_typeof(json) == JSON_REAL)
+#define json_is_number(json) (json_is_integer(json) || json_is_real(json))
+#define json_is_true(json) ((json) && json_typeof(json) == JSON_TRUE)
+#define json_is_false(json) ((json) && json_typeof(json) == JSON_FALSE)
+#define json_is_boolean(json) (json_is_true(json) || json_is_false(json))
+#define json_is_null(json) ((json) && json_typeof(json) == JSON_NULL)
+
+json_t *json_object(void);
+json_t *json_array(void);
+json_t *json_string(const char *value);
+json_t *json_stringn(const char *value, size_t len);
+json_t *json_integer(json_int_t value);
+json_t *json_real(double value);
+json_t *json_true(void);
+json_t *json_false(void);
+json_t *json_null(void);
+#define json_boolean(val) ((val) ? json_true() : json_false())
+
+json_t *json_incref(json_t *json);
+void json_decref(json_t *json);
+
+size_t json_object_size(const json_t *object);
+json_t *json_object_get(const json_t *object, const char *key);
+int json_object_set_new(json_t *object, const char *key, json_t *value);
+int json_object_set(json_t *object, const char *key, json_t *value);
+int json_object_del(json_t *object, const char *key);
+
+size_t json_array_size(const json_t *array);
+json_t *json_array_get(const json_t *array, size_t index);
+int json_array_set_new(json_t *array, size_t index, json_t *value);
+int json_array_append_new(json_t *array, json_t *value);
+int json_array_append(json_t *array, json_t *value);
+int json_array_insert_new(json_t *array, size_t index, json_t *value);
+int json_array_remove(json_t *array, size_t index);
+int json_array_clear(json_t *array);
+#define json_array_foreach(array, index, value) \
+  for (index = 0; index < json_array_size(array) && (value = json_array_get(array, index)); index++)
+
+const char *json_string_value(const json_t *string);
+size_t json_string_length(const json_t *string);
+json_int_t json_integer_value(const json_t *integer);
+double json_real_value(const json_t *real);
+double json_number_value(const json_t *json);
+#define json_boolean_value json_is_true
+
+json_t *json_deep_copy(const json_t *json);
+
+// Flat formats only: "[...]" of f, i, b and s.
+json_t *json_pack(const char *fmt, ...);
+int json_unpack(json_t *root, const char *fmt, ...);
+
+char *json_dumps(const json_t *json, size_t flags);
+int json_dumpf(const json_t *json, FILE *output, size_t flags);
+json_t *json_loads(const char *input, size_t flags, json_error_t *error);
+json_t *json_loadf(FILE *input, size_t flags, json_error_t *error);
@@ -0,0 +1,458 @@
+#include "rack.hpp"
+#include <chrono>
+#include <sys/stat.h>
+#include <dirent.h>
+
+#ifndef STUB_PLUGIN_DIR
+#define STUB_PLUGIN_DIR ".."
+#endif
+
+namespace rack {
+
+  namespace string {
+
+    static const char base64Chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    std::string toBase64(const uint8_t *data, size_t dataLen) {
+      std::string s;
+      s.reserve((dataLen + 2) / 3 * 4);
+      size_t i = 0;
+      for (; i + 2 < dataLen; i += 3) {
+        uint32_t n = (data[i] << 16) | (data[i + 1] << 8) | data[i + 2];
+        s += base64Chars[(n >> 18) & 63];
+        s += base64Chars[(n >> 12) & 63];
+        s += base64Chars[(n >> 6) & 63];
+        s += base64Chars[n & 63];
+      }
+      if (i < dataLen) {
+        uint32_t n = data[i] << 16;
+        if (i + 1 < dataLen) n |= data[i + 1] << 8;
+        s += base64Chars[(n >> 18) & 63];
+        s += base64Chars[(n >> 12) & 63];
+        s += (i + 1 < dataLen) ? base64Chars[(n >> 6) & 63] : '=';
+        s += '=';
+      }
+      return s;
+    }
+
+    std::string toBase64(const std::vector<uint8_t> &data) {
+      return toBase64(data.data(), data.size());
+    }
+
+    std::vector<uint8_t> fromBase64(const std::string &str) {
+      std::vector<uint8_t> data;
+      data.reserve(str.size() / 4 * 3);
+      uint32_t n = 0;
+      int bits = 0;
+      for (char c : str) {
+        const char *pos = std::strchr(base64Chars, c);
+        if (c == '=' || c == '\0') break;
+        if (!pos) continue;
+        n = (n << 6) | (uint32_t)(pos - base64Chars);
+        bits += 6;
+        if (bits >= 8) {
+          bits -= 8;
+          data.push_back((n >> bits) & 0xff);
+        }
+      }
+      return data;
+    }
+
+  }
+
+  namespace system {
+
+    std::string getFilename(const std::string &path) {
+      size_t i = path.find_last_of("/\\");
+      return i == std::string::npos ? path : path.substr(i + 1);
+    }
+
+    std::string getStem(const std::string &path) {
+      std::string filename = getFilename(path);
+      size_t i = filename.find_last_of('.');
+      return i == std::string::npos ? filename : filename.substr(0, i);
+    }
+
+    std::string getExtension(const std::string &path) {
+      std::string filename = getFilename(path);
+      size_t i = filename.find_last_of('.');
+      return i == std::string::npos ? "" : filename.substr(i);
+    }
+
+    std::string getDirectory(const std::string &path) {
+      size_t i = path.find_last_of("/\\");
+      return i == std::string::npos ? "" : path.substr(0, i);
+    }
+
+    std::string join(const std::string &a, const std::string &b) {
+      return a.empty() ? b : a + "/" + b;
+    }
+
+    bool exists(const std::string &path) {
+      struct stat st;
+      return stat(path.c_str(), &st) == 0;
+    }
+
+    bool isFile(const std::string &path) {
+      struct stat st;
+      return stat(path.c_str(), &st) == 0 && S_ISREG(st.st_mode);
+    }
+
+    bool isDirectory(const std::string &path) {
+      struct stat st;
+      return stat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+    }
+
+    bool createDirectories(const std::string &path) {
+      return mkdir(path.c_str(), 0755) == 0;
+    }
+
+    bool rename(const std::string &a, const std::string &b) {
+      return std::rename(a.c_str(), b.c_str()) == 0;
+    }
+
+    bool remove(const std::string &path) {
+      return std::remove(path.c_str()) == 0;
+    }
+
+    std::vector<std::string> getEntries(const std::string &dirPath, int depth) {
+      std::vector<std::string> entries;
+      DIR *dir = opendir(dirPath.c_str());
+      if (!dir) return entries;
+      while (struct dirent *entry = readdir(dir)) {
+        std::string name = entry->d_name;
+        if (name == "." || name == "..") continue;
+        entries.push_back(join(dirPath, name));
+      }
+      closedir(dir);
+      std::sort(entries.begin(), entries.end());
+      return entries;
+    }
+
+    double getTime() {
+      return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void setThreadName(const std::string &name) {}
+
+  }
+
+  namespace random {
+
+    // xoroshiro128+ with a fixed seed so renders repeat exactly.
+    static uint64_t state[2] = {0x9E3779B97F4A7C15ull, 0xD1B54A32D192ED03ull};
+
+    void init() {
+      state[0] = 0x9E3779B97F4A7C15ull;
+      state[1] = 0xD1B54A32D192ED03ull;
+    }
+
+    uint64_t u64() {
+      uint64_t s0 = state[0];
+      uint64_t s1 = state[1];
+      uint64_t result = s0 + s1;
+      s1 ^= s0;
+      state[0] = ((s0 << 55) | (s0 >> 9)) ^ s1 ^ (s1 << 14);
+      state[1] = (s1 << 36) | (s1 >> 28);
+      return result;
+    }
+
+    uint32_t u32() {
+      return u64() >> 32;
+    }
+
+    float uniform() {
+      return (u32() >> 8) * (1.f / 16777216.f);
+    }
+
+    float normal() {
+      const float radius = std::sqrt(-2.f * std::log(1.f - uniform()));
+      const float theta = 2.f * M_PI * uniform();
+      return radius * std::sin(theta);
+    }
+
+  }
+
+  namespace asset {
+
+    std::string system(std::string filename) {
+      return filename;
+    }
+
+    std::string user(std::string filename) {
+      return "/tmp/" + filename;
+    }
+
+    std::string plugin(plugin::Plugin *plugin, std::string filename) {
+      return std::string(STUB_PLUGIN_DIR) + "/" + filename;
+    }
+
+  }
+
+  namespace settings {
+    float sampleRate = 44100.f;
+    bool tooltips = true;
+    float cableOpacity = 0.5f;
+    int threadCount = 1;
+  }
+
+  namespace plugin {
+
+    void Plugin::addModel(Model *model) {
+      if (!model) return;
+      model->plugin = this;
+      models.push_back(model);
+    }
+
+  }
+
+  namespace engine {
+
+    Param *ParamQuantity::getParam() {
+      return module ? &module->params[paramId] : NULL;
+    }
+
+    void ParamQuantity::setValue(float value) {
+      if (module) module->params[paramId].setValue(math::clampSafe(value, getMinValue(), getMaxValue()));
+    }
+
+    float ParamQuantity::getValue() {
+      return module ? module->params[paramId].getValue() : getDefaultValue();
+    }
+
+    float ParamQuantity::getDisplayValue() {
+      float v = getValue();
+      if (displayBase == 0.f) {
+      }
+      else if (displayBase < 0.f) {
+        v = std::log(v) / -displayBase;
+      }
+      else {
+        v = std::pow(displayBase, v);
+      }
+      return v * displayMultiplier + displayOffset;
+    }
+
+    void ParamQuantity::setDisplayValue(float displayValue) {
+      float v = (displayValue - displayOffset) / displayMultiplier;
+      if (displayBase < 0.f) {
+        v = std::exp(v * -displayBase);
+      }
+      else if (displayBase > 0.f) {
+        v = std::log(v) / std::log(displayBase);
+      }
+      setValue(v);
+    }
+
+    std::string ParamQuantity::getDisplayValueString() {
+      return string::f("%.*g", displayPrecision, getDisplayValue());
+    }
+
+    void ParamQuantity::setDisplayValueString(std::string s) {
+      setDisplayValue(std::strtof(s.c_str(), NULL));
+    }
+
+    std::string SwitchQuantity::getDisplayValueString() {
+      int index = (int)std::floor(getValue() - getMinValue());
+      if (index < 0 || index >= (int)labels.size()) return ParamQuantity::getDisplayValueString();
+      return labels[index];
+    }
+
+    Module::~Module() {
+      for (ParamQuantity *q : paramQuantities) delete q;
+      for (PortInfo *info : inputInfos) delete info;
+      for (PortInfo *info : outputInfos) delete info;
+      for (LightInfo *info : lightInfos) delete info;
+    }
+
+    void Module::config(int numParams, int numInputs, int numOutputs, int numLights) {
+      params.resize(numParams);
+      inputs.resize(numInputs);
+      outputs.resize(numOutputs);
+      lights.resize(numLights);
+      paramQuantities.resize(numParams, NULL);
+      for (int i = 0; i < numParams; i++) configParam(i, 0.f, 1.f, 0.f);
+      inputInfos.resize(numInputs, NULL);
+      outputInfos.resize(numOutputs, NULL);
+      lightInfos.resize(numLights, NULL);
+    }
+
+    std::string Module::createPatchStorageDirectory() {
+      return "/tmp";
+    }
+
+    std::string Module::getPatchStorageDirectory() {
+      return "/tmp";
+    }
+
+    json_t *Module::paramsToJson() {
+      json_t *paramsJ = json_array();
+      for (size_t i = 0; i < params.size(); i++) {
+        json_t *paramJ = json_object();
+        json_object_set_new(paramJ, "value", json_real(params[i].getValue()));
+        json_object_set_new(paramJ, "id", json_integer(i));
+        json_array_append_new(paramsJ, paramJ);
+      }
+      return paramsJ;
+    }
+
+    void Module::paramsFromJson(json_t *rootJ) {
+      for (size_t i = 0; i < json_array_size(rootJ); i++) {
+        json_t *paramJ = json_array_get(rootJ, i);
+        size_t id = json_integer_value(json_object_get(paramJ, "id"));
+        if (id < params.size()) params[id].setValue(json_number_value(json_object_get(paramJ, "value")));
+      }
+    }
+
+    json_t *Module::toJson() {
+      json_t *rootJ = json_object();
+      json_object_set_new(rootJ, "id", json_integer(id));
+      json_object_set_new(rootJ, "params", paramsToJson());
+      json_t *dataJ = dataToJson();
+      if (dataJ) json_object_set_new(rootJ, "data", dataJ);
+      return rootJ;
+    }
+
+    void Module::fromJson(json_t *rootJ) {
+      json_t *paramsJ = json_object_get(rootJ, "params");
+      if (paramsJ) paramsFromJson(paramsJ);
+      json_t *dataJ = json_object_get(rootJ, "data");
+      if (dataJ) dataFromJson(dataJ);
+    }
+
+    void Module::onReset(const ResetEvent &e) {
+      for (ParamQuantity *q : paramQuantities) {
+        if (q && q->resetEnabled) q->reset();
+      }
+      onReset();
+    }
+
+    void Module::onRandomize(const RandomizeEvent &e) {
+      onRandomize();
+    }
+
+  }
+
+  namespace window {
+
+    std::shared_ptr<Svg> Svg::load(const std::string &filename) {
+      return std::make_shared<Svg>();
+    }
+
+  }
+
+  namespace widget {
+
+    Widget::~Widget() {
+      clearChildren();
+    }
+
+    void Widget::addChild(Widget *child) {
+      child->parent = this;
+      children.push_back(child);
+    }
+
+    void Widget::addChildBottom(Widget *child) {
+      child->parent = this;
+      children.push_front(child);
+    }
+
+    void Widget::removeChild(Widget *child) {
+      children.remove(child);
+      child->parent = NULL;
+    }
+
+    void Widget::clearChildren() {
+      for (Widget *child : children) {
+        child->parent = NULL;
+        delete child;
+      }
+      children.clear();
+    }
+
+  }
+
+  namespace app {
+
+    SvgKnob::SvgKnob() {
+      fb = new widget::FramebufferWidget;
+      addChild(fb);
+      shadow = new CircularShadow;
+      fb->addChild(shadow);
+      tw = new widget::TransformWidget;
+      fb->addChild(tw);
+      sw = new widget::SvgWidget;
+      tw->addChild(sw);
+    }
+
+    SvgSlider::SvgSlider() {
+      fb = new widget::FramebufferWidget;
+      addChild(fb);
+      background = new widget::SvgWidget;
+      fb->addChild(background);
+      handle = new widget::SvgWidget;
+      fb->addChild(handle);
+    }
+
+    SvgSwitch::SvgSwitch() {
+      fb = new widget::FramebufferWidget;
+      addChild(fb);
+      shadow = new CircularShadow;
+      fb->addChild(shadow);
+      sw = new widget::SvgWidget;
+      fb->addChild(sw);
+    }
+
+    void ModuleWidget::setPanel(widget::Widget *panel) {
+      if (this->panel) {
+        removeChild(this->panel);
+        delete this->panel;
+      }
+      this->panel = panel;
+      if (panel) addChildBottom(panel);
+    }
+
+    void ModuleWidget::setPanel(std::shared_ptr<window::Svg> svg) {
+      app::SvgPanel *panel = new app::SvgPanel;
+      panel->setBackground(svg);
+      setPanel(panel);
+    }
+
+  }
+
+  namespace componentlibrary {
+
+    RoundKnob::RoundKnob() {
+      bg = new widget::SvgWidget;
+      fb->addChildBottom(bg);
+    }
+
+    Trimpot::Trimpot() {
+      bg = new widget::SvgWidget;
+      fb->addChildBottom(bg);
+    }
+
+  }
+
+  Context *contextGet() {
+    static window::Window window;
+    static app::RackWidget rackWidget;
+    static app::RackScrollWidget rackScroll;
+    static widget::ZoomWidget zoomWidget;
+    static app::Scene scene;
+    static engine::Engine engine;
+    static history::State history;
+    static Context context;
+    if (!context.engine) {
+      scene.rack = &rackWidget;
+      scene.rackScroll = &rackScroll;
+      rackScroll.zoomWidget = &zoomWidget;
+      context.window = &window;
+      context.scene = &scene;
+      context.engine = &engine;
+      context.history = &history;
+    }
+    return &context;
+  }
+
+}
@@ -0,0 +1,2371 @@
+#pragma once
+// Minimal stand-in for the Rack SDK headers, enough to compile the module
+// sources and run their process() headless. The engine side (ports, params,
+// simd, dsp helpers) follows Rack 2 closely, the widget side only has to
+// compile: nothing here draws or handles events.
+#include <algorithm>
+#include <cassert>
+#include <atomic>
+#include <cmath>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <nmmintrin.h>
+#include <jansson.h>
+#include <pffft.h>
+
+#define RACK_GRID_WIDTH 15
+#define CHECKMARK_STRING "✔"
+#define RIGHT_ARROW "▸"
+#define RACK_GRID_HEIGHT 380
+#define SPEEX_RESAMPLER_QUALITY_DESKTOP 5
+#define GLFW_MOUSE_BUTTON_LEFT 0
+#define GLFW_MOUSE_BUTTON_RIGHT 1
+#define GLFW_PRESS 1
+#define GLFW_RELEASE 0
+#define GLFW_REPEAT 2
+#define GLFW_MOD_SHIFT 0x0001
+#define GLFW_MOD_CONTROL 0x0002
+#define GLFW_MOD_ALT 0x0004
+#define GLFW_KEY_A 65
+#define GLFW_KEY_B 66
+#define GLFW_KEY_C 67
+#define GLFW_KEY_D 68
+#define GLFW_KEY_E 69
+#define GLFW_KEY_F 70
+#define GLFW_KEY_G 71
+#define GLFW_KEY_H 72
+#define GLFW_KEY_I 73
+#define GLFW_KEY_J 74
+#define GLFW_KEY_K 75
+#define GLFW_KEY_L 76
+#define GLFW_KEY_M 77
+#define GLFW_KEY_N 78
+#define GLFW_KEY_O 79
+#define GLFW_KEY_P 80
+#define GLFW_KEY_Q 81
+#define GLFW_KEY_R 82
+#define GLFW_KEY_S 83
+#define GLFW_KEY_T 84
+#define GLFW_KEY_U 85
+#define GLFW_KEY_V 86
+#define GLFW_KEY_W 87
+#define GLFW_KEY_X 88
+#define GLFW_KEY_Y 89
+#define GLFW_KEY_Z 90
+#define GLFW_KEY_0 48
+#define GLFW_KEY_1 49
+#define GLFW_KEY_2 50
+#define GLFW_KEY_3 51
+#define GLFW_KEY_4 52
+#define GLFW_KEY_5 53
+#define GLFW_KEY_6 54
+#define GLFW_KEY_7 55
+#define GLFW_KEY_8 56
+#define GLFW_KEY_9 57
+#define GLFW_KEY_LEFT 263
+#define GLFW_KEY_RIGHT 262
+#define GLFW_KEY_UP 265
+#define GLFW_KEY_DOWN 264
+#define GLFW_KEY_ENTER 257
+#define GLFW_KEY_KP_ENTER 335
+#define GLFW_KEY_DELETE 261
+#define GLFW_KEY_BACKSPACE 259
+#define GLFW_KEY_ESCAPE 256
+#define GLFW_KEY_TAB 258
+#define GLFW_KEY_SPACE 32
+#define GLFW_KEY_HOME 268
+#define GLFW_KEY_END 269
+#define GLFW_KEY_PAGE_UP 266
+#define GLFW_KEY_PAGE_DOWN 267
+#define RACK_MOD_CTRL GLFW_MOD_CONTROL
+#define RACK_MOD_MASK (GLFW_MOD_SHIFT | GLFW_MOD_CONTROL | GLFW_MOD_ALT)
+#define DEBUG(...) do {} while (0)
+#define INFO(...) do {} while (0)
+#define WARN(...) do {} while (0)
+
+struct GLFWwindow;
+inline void glfwSetClipboardString(GLFWwindow *, const char *) {}
+inline const char *glfwGetClipboardString(GLFWwindow *) { return ""; }
+
+// nanovg, drawing calls are swallowed
+struct NVGcontext;
+struct NVGcolor {
+  union {
+    float rgba[4];
+    struct {
+      float r, g, b, a;
+    };
+  };
+};
+struct NVGpaint {
+  float xform[6];
+  float extent[2];
+  float radius, feather;
+  NVGcolor innerColor, outerColor;
+  int image;
+};
+enum NVGalign {
+  NVG_ALIGN_LEFT = 1 << 0, NVG_ALIGN_CENTER = 1 << 1, NVG_ALIGN_RIGHT = 1 << 2,
+  NVG_ALIGN_TOP = 1 << 3, NVG_ALIGN_MIDDLE = 1 << 4, NVG_ALIGN_BOTTOM = 1 << 5, NVG_ALIGN_BASELINE = 1 << 6
+};
+enum NVGsolidity { NVG_SOLID = 1, NVG_HOLE = 2 };
+enum NVGwinding { NVG_CCW = 1, NVG_CW = 2 };
+enum NVGlineCap { NVG_BUTT, NVG_ROUND, NVG_SQUARE, NVG_BEVEL, NVG_MITER };
+enum NVGcompositeOperation { NVG_SOURCE_OVER, NVG_LIGHTER = 9 };
+inline NVGcolor nvgRGBAf(float r, float g, float b, float a) {
+  NVGcolor c;
+  c.r = r;
+  c.g = g;
+  c.b = b;
+  c.a = a;
+  return c;
+}
+inline NVGcolor nvgRGBA(unsigned char r, unsigned char g, unsigned char b, unsigned char a) {
+  return nvgRGBAf(r / 255.f, g / 255.f, b / 255.f, a / 255.f);
+}
+inline NVGcolor nvgRGB(unsigned char r, unsigned char g, unsigned char b) { return nvgRGBA(r, g, b, 255); }
+inline NVGcolor nvgRGBf(float r, float g, float b) { return nvgRGBAf(r, g, b, 1.f); }
+inline NVGcolor nvgHSLA(float, float, float, unsigned char a) { return nvgRGBA(0, 0, 0, a); }
+inline NVGcolor nvgHSL(float h, float s, float l) { return nvgHSLA(h, s, l, 255); }
+inline NVGcolor nvgTransRGBA(NVGcolor c, unsigned char a) { c.a = a / 255.f; return c; }
+inline NVGcolor nvgTransRGBAf(NVGcolor c, float a) { c.a = a; return c; }
+inline NVGcolor nvgLerpRGBA(NVGcolor c0, NVGcolor c1, float u) {
+  NVGcolor c;
+  for (int i = 0; i < 4; i++) c.rgba[i] = c0.rgba[i] + (c1.rgba[i] - c0.rgba[i]) * u;
+  return c;
+}
+#define NVG_STUB(name) template <typename... A> inline void name(A &&...) {}
+NVG_STUB(nvgSave) NVG_STUB(nvgRestore) NVG_STUB(nvgReset) NVG_STUB(nvgBeginPath) NVG_STUB(nvgClosePath)
+NVG_STUB(nvgMoveTo) NVG_STUB(nvgLineTo) NVG_STUB(nvgBezierTo) NVG_STUB(nvgQuadTo) NVG_STUB(nvgArcTo) NVG_STUB(nvgArc)
+NVG_STUB(nvgRect) NVG_STUB(nvgRoundedRect) NVG_STUB(nvgEllipse) NVG_STUB(nvgCircle) NVG_STUB(nvgPathWinding)
+NVG_STUB(nvgFill) NVG_STUB(nvgStroke) NVG_STUB(nvgFillColor) NVG_STUB(nvgStrokeColor) NVG_STUB(nvgFillPaint)
+NVG_STUB(nvgStrokePaint) NVG_STUB(nvgStrokeWidth) NVG_STUB(nvgLineCap) NVG_STUB(nvgLineJoin) NVG_STUB(nvgGlobalAlpha)
+NVG_STUB(nvgFontSize) NVG_STUB(nvgFontFaceId) NVG_STUB(nvgFontFace) NVG_STUB(nvgTextAlign) NVG_STUB(nvgTextLetterSpacing)
+NVG_STUB(nvgTextLineHeight) NVG_STUB(nvgFontBlur) NVG_STUB(nvgTextBox) NVG_STUB(nvgScissor) NVG_STUB(nvgResetScissor)
+NVG_STUB(nvgIntersectScissor) NVG_STUB(nvgTranslate) NVG_STUB(nvgRotate) NVG_STUB(nvgScale) NVG_STUB(nvgResetTransform)
+NVG_STUB(nvgGlobalCompositeOperation) NVG_STUB(nvgUpdateImage) NVG_STUB(nvgDeleteImage) NVG_STUB(nvgTextBoxBounds)
+NVG_STUB(nvgMiterLimit) NVG_STUB(nvgGlobalTint) NVG_STUB(nvgShapeAntiAlias)
+#undef NVG_STUB
+template <typename... A> inline float nvgText(A &&...) { return 0.f; }
+template <typename... A> inline float nvgTextBounds(A &&...) { return 0.f; }
+template <typename... A> inline int nvgCreateImageRGBA(A &&...) { return 0; }
+template <typename... A> inline int nvgCreateImage(A &&...) { return 0; }
+template <typename... A> inline NVGpaint nvgLinearGradient(A &&...) { return NVGpaint(); }
+template <typename... A> inline NVGpaint nvgRadialGradient(A &&...) { return NVGpaint(); }
+template <typename... A> inline NVGpaint nvgBoxGradient(A &&...) { return NVGpaint(); }
+template <typename... A> inline NVGpaint nvgImagePattern(A &&...) { return NVGpaint(); }
+
+// nanosvg, only the shape list the knobs recolour
+struct NSVGgradient;
+struct NSVGpaint {
+  char type;
+  union {
+    unsigned int color;
+    NSVGgradient *gradient;
+  };
+};
+struct NSVGshape {
+  char id[64];
+  NSVGpaint fill;
+  NSVGpaint stroke;
+  float opacity;
+  float strokeWidth;
+  unsigned char flags;
+  NSVGshape *next;
+};
+struct NSVGimage {
+  float width, height;
+  NSVGshape *shapes;
+};
+
+namespace rack {
+
+  namespace plugin {
+    struct Plugin;
+    struct Model;
+  }
+
+  struct Exception : std::exception {
+    std::string msg;
+    Exception(const std::string &msg) : msg(msg) {}
+    const char *what() const noexcept override { return msg.c_str(); }
+  };
+
+  namespace simd {
+
+    template <typename T, int N>
+    struct Vector;
+
+    template <>
+    struct Vector<int32_t, 4>;
+
+    template <>
+    struct Vector<float, 4> {
+      using type = float;
+      constexpr static int size = 4;
+      union {
+        __m128 v;
+        float s[4];
+      };
+
+      Vector() = default;
+      Vector(__m128 v) : v(v) {}
+      Vector(float x) { v = _mm_set1_ps(x); }
+      Vector(float x1, float x2, float x3, float x4) { v = _mm_setr_ps(x1, x2, x3, x4); }
+      inline Vector(Vector<int32_t, 4> a);
+      static Vector zero() { return Vector(_mm_setzero_ps()); }
+      static Vector mask() { return Vector(_mm_castsi128_ps(_mm_cmpeq_epi32(_mm_setzero_si128(), _mm_setzero_si128()))); }
+      static Vector load(const float *x) { return Vector(_mm_loadu_ps(x)); }
+      void store(float *x) const { _mm_storeu_ps(x, v); }
+      float &operator[](int i) { return s[i]; }
+      const float &operator[](int i) const { return s[i]; }
+    };
+
+    template <>
+    struct Vector<int32_t, 4> {
+      using type = int32_t;
+      constexpr static int size = 4;
+      union {
+        __m128i v;
+        int32_t s[4];
+      };
+
+      Vector() = default;
+      Vector(__m128i v) : v(v) {}
+      Vector(int32_t x) { v = _mm_set1_epi32(x); }
+      Vector(int32_t x1, int32_t x2, int32_t x3, int32_t x4) { v = _mm_setr_epi32(x1, x2, x3, x4); }
+      Vector(Vector<float, 4> a) { v = _mm_cvttps_epi32(a.v); }
+      static Vector zero() { return Vector(_mm_setzero_si128()); }
+      static Vector load(const int32_t *x) { return Vector(_mm_loadu_si128((const __m128i *)x)); }
+      void store(int32_t *x) const { _mm_storeu_si128((__m128i *)x, v); }
+      int32_t &operator[](int i) { return s[i]; }
+      const int32_t &operator[](int i) const { return s[i]; }
+    };
+
+    inline Vector<float, 4>::Vector(Vector<int32_t, 4> a) { v = _mm_cvtepi32_ps(a.v); }
+
+    typedef Vector<float, 4> float_4;
+    typedef Vector<int32_t, 4> int32_4;
+
+#define FLOAT_4_BINARY(op, fn) \
+    inline float_4 operator op(const float_4 &a, const float_4 &b) { return float_4(fn(a.v, b.v)); } \
+    inline float_4 &operator op##=(float_4 &a, const float_4 &b) { a = a op b; return a; }
+    FLOAT_4_BINARY(+, _mm_add_ps)
+    FLOAT_4_BINARY(-, _mm_sub_ps)
+    FLOAT_4_BINARY(*, _mm_mul_ps)
+    FLOAT_4_BINARY(/, _mm_div_ps)
+    FLOAT_4_BINARY(&, _mm_and_ps)
+    FLOAT_4_BINARY(|, _mm_or_ps)
+    FLOAT_4_BINARY(^, _mm_xor_ps)
+#undef FLOAT_4_BINARY
+#define FLOAT_4_COMPARE(op, fn) \
+    inline float_4 operator op(const float_4 &a, const float_4 &b) { return float_4(fn(a.v, b.v)); }
+    FLOAT_4_COMPARE(==, _mm_cmpeq_ps)
+    FLOAT_4_COMPARE(!=, _mm_cmpneq_ps)
+    FLOAT_4_COMPARE(<, _mm_cmplt_ps)
+    FLOAT_4_COMPARE(<=, _mm_cmple_ps)
+    FLOAT_4_COMPARE(>, _mm_cmpgt_ps)
+    FLOAT_4_COMPARE(>=, _mm_cmpge_ps)
+#undef FLOAT_4_COMPARE
+    inline float_4 operator+(const float_4 &a) { return a; }
+    inline float_4 operator-(const float_4 &a) { return float_4(0.f) - a; }
+    inline float_4 operator~(const float_4 &a) { return a ^ float_4::mask(); }
+    inline float_4 &operator++(float_4 &a) { a += 1.f; return a; }
+    inline float_4 &operator--(float_4 &a) { a -= 1.f; return a; }
+
+#define INT32_4_BINARY(op, fn) \
+    inline int32_4 operator op(const int32_4 &a, const int32_4 &b) { return int32_4(fn(a.v, b.v)); } \
+    inline int32_4 &operator op##=(int32_4 &a, const int32_4 &b) { a = a op b; return a; }
+    INT32_4_BINARY(+, _mm_add_epi32)
+    INT32_4_BINARY(-, _mm_sub_epi32)
+    INT32_4_BINARY(*, _mm_mullo_epi32)
+    INT32_4_BINARY(&, _mm_and_si128)
+    INT32_4_BINARY(|, _mm_or_si128)
+    INT32_4_BINARY(^, _mm_xor_si128)
+#undef INT32_4_BINARY
+    inline int32_4 operator==(const int32_4 &a, const int32_4 &b) { return int32_4(_mm_cmpeq_epi32(a.v, b.v)); }
+    inline int32_4 operator<(const int32_4 &a, const int32_4 &b) { return int32_4(_mm_cmplt_epi32(a.v, b.v)); }
+    inline int32_4 operator>(const int32_4 &a, const int32_4 &b) { return int32_4(_mm_cmpgt_epi32(a.v, b.v)); }
+    inline int32_4 operator<<(const int32_4 &a, int b) { return int32_4(_mm_slli_epi32(a.v, b)); }
+    inline int32_4 operator>>(const int32_4 &a, int b) { return int32_4(_mm_srai_epi32(a.v, b)); }
+
+    // Scalar versions live in the same namespace, as in Rack.
+    using std::fmax;
+    using std::fmin;
+    using std::fabs;
+    using std::floor;
+    using std::ceil;
+    using std::trunc;
+    using std::round;
+    using std::sqrt;
+    using std::exp;
+    using std::log;
+    using std::log10;
+    using std::log2;
+    using std::sin;
+    using std::cos;
+    using std::tan;
+    using std::atan;
+    using std::atan2;
+    using std::tanh;
+    using std::pow;
+
+    inline float ifelse(bool mask, float a, float b) { return mask ? a : b; }
+    inline int movemask(bool mask) { return mask ? 1 : 0; }
+    inline float sgn(float x) { return x > 0.f ? 1.f : (x < 0.f ? -1.f : 0.f); }
+    inline float rcp(float x) { return 1.f / x; }
+    inline float rsqrt(float x) { return 1.f / std::sqrt(x); }
+    inline float clamp(float x, float a = 0.f, float b = 1.f) { return std::fmax(std::fmin(x, b), a); }
+    inline float rescale(float x, float a, float b, float c, float d) { return c + (x - a) / (b - a) * (d - c); }
+    inline float crossfade(float a, float b, float p) { return a + (b - a) * p; }
+
+    inline float_4 ifelse(float_4 mask, float_4 a, float_4 b) { return float_4(_mm_blendv_ps(b.v, a.v, mask.v)); }
+    inline int movemask(float_4 a) { return _mm_movemask_ps(a.v); }
+    template <typename T>
+    T movemaskInverse(int x);
+    template <>
+    inline float_4 movemaskInverse<float_4>(int x) {
+      __m128i msk8421 = _mm_set_epi32(8, 4, 2, 1);
+      __m128i x_bc = _mm_set1_epi32(x);
+      __m128i t = _mm_and_si128(x_bc, msk8421);
+      return float_4(_mm_castsi128_ps(_mm_cmpeq_epi32(t, msk8421)));
+    }
+    inline float_4 fmax(float_4 a, float_4 b) { return float_4(_mm_max_ps(a.v, b.v)); }
+    inline float_4 fmin(float_4 a, float_4 b) { return float_4(_mm_min_ps(a.v, b.v)); }
+    inline float_4 fabs(float_4 a) { return float_4(_mm_andnot_ps(_mm_set1_ps(-0.f), a.v)); }
+    inline float_4 abs(float_4 a) { return fabs(a); }
+    inline float_4 floor(float_4 a) { return float_4(_mm_floor_ps(a.v)); }
+    inline float_4 ceil(float_4 a) { return float_4(_mm_ceil_ps(a.v)); }
+    inline float_4 trunc(float_4 a) { return float_4(_mm_round_ps(a.v, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC)); }
+    inline float_4 round(float_4 a) { return float_4(_mm_round_ps(a.v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC)); }
+    inline float_4 sqrt(float_4 a) { return float_4(_mm_sqrt_ps(a.v)); }
+    inline float_4 rsqrt(float_4 a) { return float_4(_mm_rsqrt_ps(a.v)); }
+    inline float_4 rcp(float_4 a) { return float_4(_mm_rcp_ps(a.v)); }
+    inline float_4 sgn(float_4 x) {
+      float_4 signbit = x & -0.f;
+      float_4 nonzero = (x != 0.f);
+      return signbit | (nonzero & 1.f);
+    }
+    inline float_4 clamp(float_4 x, float_4 a = 0.f, float_4 b = 1.f) { return fmax(fmin(x, b), a); }
+    inline float_4 rescale(float_4 x, float_4 a, float_4 b, float_4 c, float_4 d) { return c + (x - a) / (b - a) * (d - c); }
+    inline float_4 crossfade(float_4 a, float_4 b, float_4 p) { return a + (b - a) * p; }
+
+    // Rack uses sse_mathfun here, the stub goes lane by lane.
+#define FLOAT_4_LANES(name) \
+    inline float_4 name(float_4 a) { \
+      float_4 r; \
+      for (int i = 0; i < 4; i++) r.s[i] = std::name(a.s[i]); \
+      return r; \
+    }
+    FLOAT_4_LANES(exp)
+    FLOAT_4_LANES(log)
+    FLOAT_4_LANES(log10)
+    FLOAT_4_LANES(log2)
+    FLOAT_4_LANES(sin)
+    FLOAT_4_LANES(cos)
+    FLOAT_4_LANES(tan)
+    FLOAT_4_LANES(atan)
+    FLOAT_4_LANES(tanh)
+#undef FLOAT_4_LANES
+    inline float_4 atan2(float_4 a, float_4 b) {
+      float_4 r;
+      for (int i = 0; i < 4; i++) r.s[i] = std::atan2(a.s[i], b.s[i]);
+      return r;
+    }
+    inline float_4 pow(float_4 a, float_4 b) { return exp(b * log(a)); }
+    inline float_4 pow(float a, float_4 b) { return exp(b * std::log(a)); }
+    template <typename T>
+    T pow(T a, int b) {
+      // Exponentiation by squaring
+      if (b < 0) return 1.f / pow(a, -b);
+      T p = 1.f;
+      while (b) {
+        if (b & 1) p *= a;
+        a *= a;
+        b >>= 1;
+      }
+      return p;
+    }
+
+  }
+
+  using simd::float_4;
+  using simd::int32_4;
+
+  namespace math {
+
+    inline int clamp(int x, int a, int b) { return std::max(std::min(x, b), a); }
+    inline float clamp(float x, float a = 0.f, float b = 1.f) { return std::fmax(std::fmin(x, b), a); }
+    inline float clampSafe(float x, float a = 0.f, float b = 1.f) { return (a <= b) ? clamp(x, a, b) : clamp(x, b, a); }
+    inline int clampSafe(int x, int a, int b) { return (a <= b) ? clamp(x, a, b) : clamp(x, b, a); }
+    inline int eucMod(int a, int b) {
+      int mod = a % b;
+      if (mod < 0) mod += b;
+      return mod;
+    }
+    inline float eucMod(float a, float b) {
+      float mod = std::fmod(a, b);
+      if (mod < 0.f) mod += b;
+      return mod;
+    }
+    inline int eucDiv(int a, int b) {
+      int div = a / b;
+      int mod = a % b;
+      if (mod < 0) div -= 1;
+      return div;
+    }
+    inline bool isEven(int x) { return x % 2 == 0; }
+    inline bool isOdd(int x) { return x % 2 != 0; }
+    inline bool isNear(float a, float b, float epsilon = 1e-6f) { return std::fabs(a - b) <= epsilon; }
+    inline float chop(float x, float epsilon = 1e-6f) { return isNear(x, 0.f, epsilon) ? 0.f : x; }
+    inline float rescale(float x, float xMin, float xMax, float yMin, float yMax) { return yMin + (x - xMin) / (xMax - xMin) * (yMax - yMin); }
+    inline float crossfade(float a, float b, float p) { return a + (b - a) * p; }
+    inline float interpolateLinear(const float *p, float x) {
+      int xi = x;
+      float xf = x - xi;
+      return crossfade(p[xi], p[xi + 1], xf);
+    }
+    inline float sgn(float x) { return x > 0.f ? 1.f : (x < 0.f ? -1.f : 0.f); }
+    inline float normalizeZero(float x) { return x + 0.f; }
+    inline int log2(int n) {
+      int i = 0;
+      while (n >>= 1) i++;
+      return i;
+    }
+    inline bool isPow2(int n) { return n > 0 && (n & (n - 1)) == 0; }
+
+    struct Vec {
+      float x = 0.f;
+      float y = 0.f;
+      Vec() {}
+      Vec(float xy) : x(xy), y(xy) {}
+      Vec(float x, float y) : x(x), y(y) {}
+      float &operator[](int i) { return i == 0 ? x : y; }
+      Vec neg() const { return Vec(-x, -y); }
+      Vec plus(Vec b) const { return Vec(x + b.x, y + b.y); }
+      Vec minus(Vec b) const { return Vec(x - b.x, y - b.y); }
+      Vec mult(float s) const { return Vec(x * s, y * s); }
+      Vec mult(Vec b) const { return Vec(x * b.x, y * b.y); }
+      Vec div(float s) const { return Vec(x / s, y / s); }
+      Vec div(Vec b) const { return Vec(x / b.x, y / b.y); }
+      float dot(Vec b) const { return x * b.x + y * b.y; }
+      float norm() const { return std::hypot(x, y); }
+      float square() const { return x * x + y * y; }
+      float area() const { return x * y; }
+      Vec round() const { return Vec(std::round(x), std::round(y)); }
+      Vec floor() const { return Vec(std::floor(x), std::floor(y)); }
+      Vec ceil() const { return Vec(std::ceil(x), std::ceil(y)); }
+      bool equals(Vec b) const { return x == b.x && y == b.y; }
+      bool isZero() const { return x == 0.f && y == 0.f; }
+      bool isFinite() const { return std::isfinite(x) && std::isfinite(y); }
+      Vec operator+(const Vec &b) const { return plus(b); }
+      Vec operator-(const Vec &b) const { return minus(b); }
+      Vec operator-() const { return neg(); }
+      Vec operator*(float s) const { return mult(s); }
+      Vec operator/(float s) const { return div(s); }
+      Vec &operator+=(const Vec &b) { return *this = plus(b); }
+      Vec &operator-=(const Vec &b) { return *this = minus(b); }
+      bool operator==(const Vec &b) const { return equals(b); }
+      bool operator!=(const Vec &b) const { return !equals(b); }
+    };
+
+    struct Rect {
+      Vec pos;
+      Vec size;
+      Rect() {}
+      Rect(Vec pos, Vec size) : pos(pos), size(size) {}
+      Rect(float posX, float posY, float sizeX, float sizeY) : pos(Vec(posX, posY)), size(Vec(sizeX, sizeY)) {}
+      static Rect fromMinMax(Vec a, Vec b) { return Rect(a, b.minus(a)); }
+      bool contains(Vec v) const { return pos.x <= v.x && v.x < pos.x + size.x && pos.y <= v.y && v.y < pos.y + size.y; }
+      bool intersects(Rect r) const { return pos.x < r.pos.x + r.size.x && r.pos.x < pos.x + size.x && pos.y < r.pos.y + r.size.y && r.pos.y < pos.y + size.y; }
+      Vec getCenter() const { return pos.plus(size.mult(0.5f)); }
+      Vec getTopLeft() const { return pos; }
+      Vec getBottomRight() const { return pos.plus(size); }
+      float getLeft() const { return pos.x; }
+      float getRight() const { return pos.x + size.x; }
+      float getTop() const { return pos.y; }
+      float getBottom() const { return pos.y + size.y; }
+      Rect zeroPos() const { return Rect(Vec(), size); }
+      Rect grow(Vec d) const { return Rect(pos.minus(d), size.plus(d.mult(2.f))); }
+      Rect shrink(Vec d) const { return Rect(pos.plus(d), size.minus(d.mult(2.f))); }
+    };
+
+  }
+
+  using math::Vec;
+  using math::Rect;
+
+  inline math::Vec mm2px(math::Vec mm) {
+    return mm.mult(75.f / 25.4f);
+  }
+  using math::clamp;
+  using math::clampSafe;
+  using math::rescale;
+  using math::crossfade;
+  using math::isNear;
+  using math::eucMod;
+
+  namespace string {
+    inline std::string f(const char *format, ...) __attribute__((format(printf, 1, 2)));
+    inline std::string f(const char *format, ...) {
+      va_list args;
+      va_start(args, format);
+      char buf[4096];
+      vsnprintf(buf, sizeof(buf), format, args);
+      va_end(args);
+      return buf;
+    }
+    inline std::string lowercase(std::string s) {
+      for (char &c : s) c = std::tolower(c);
+      return s;
+    }
+    inline std::string uppercase(std::string s) {
+      for (char &c : s) c = std::toupper(c);
+      return s;
+    }
+    inline std::string trim(const std::string &s) {
+      size_t a = s.find_first_not_of(" \t\n\r");
+      if (a == std::string::npos) return "";
+      return s.substr(a, s.find_last_not_of(" \t\n\r") - a + 1);
+    }
+    inline bool startsWith(const std::string &s, const std::string &p) { return s.compare(0, p.size(), p) == 0; }
+    inline bool endsWith(const std::string &s, const std::string &p) { return s.size() >= p.size() && s.compare(s.size() - p.size(), p.size(), p) == 0; }
+    inline std::string ellipsize(const std::string &s, size_t len) { return s.size() <= len ? s : s.substr(0, len - 1) + "…"; }
+    std::string toBase64(const uint8_t *data, size_t dataLen);
+    std::string toBase64(const std::vector<uint8_t> &data);
+    std::vector<uint8_t> fromBase64(const std::string &str);
+  }
+
+  namespace system {
+    std::string getFilename(const std::string &path);
+    std::string getStem(const std::string &path);
+    std::string getExtension(const std::string &path);
+    std::string getDirectory(const std::string &path);
+    std::string join(const std::string &a, const std::string &b);
+    bool exists(const std::string &path);
+    bool isFile(const std::string &path);
+    bool isDirectory(const std::string &path);
+    bool createDirectories(const std::string &path);
+    bool rename(const std::string &a, const std::string &b);
+    bool remove(const std::string &path);
+    std::vector<std::string> getEntries(const std::string &dirPath, int depth = 0);
+    double getTime();
+    void setThreadName(const std::string &name);
+  }
+
+  namespace random {
+    void init();
+    uint32_t u32();
+    uint64_t u64();
+    float uniform();
+    float normal();
+  }
+
+  namespace asset {
+    std::string system(std::string filename = "");
+    std::string user(std::string filename = "");
+    std::string plugin(plugin::Plugin *plugin, std::string filename = "");
+  }
+
+  namespace color {
+    static const NVGcolor BLACK_TRANSPARENT = nvgRGBA(0x00, 0x00, 0x00, 0x00);
+    static const NVGcolor BLACK = nvgRGBf(0.f, 0.f, 0.f);
+    static const NVGcolor WHITE = nvgRGBf(1.f, 1.f, 1.f);
+    static const NVGcolor WHITE_TRANSPARENT = nvgRGBA(0xff, 0xff, 0xff, 0x00);
+    static const NVGcolor RED = nvgRGBf(1.f, 0.f, 0.f);
+    static const NVGcolor GREEN = nvgRGBf(0.f, 1.f, 0.f);
+    static const NVGcolor BLUE = nvgRGBf(0.f, 0.f, 1.f);
+    static const NVGcolor YELLOW = nvgRGBf(1.f, 1.f, 0.f);
+    static const NVGcolor MAGENTA = nvgRGBf(1.f, 0.f, 1.f);
+    static const NVGcolor CYAN = nvgRGBf(0.f, 1.f, 1.f);
+    inline NVGcolor mult(NVGcolor a, float x) {
+      for (int i = 0; i < 3; i++) a.rgba[i] *= x;
+      return a;
+    }
+    inline NVGcolor alpha(NVGcolor a, float alpha) {
+      a.a *= alpha;
+      return a;
+    }
+    inline NVGcolor lerp(NVGcolor a, NVGcolor b, float p) { return nvgLerpRGBA(a, b, p); }
+    inline NVGcolor fromHexString(std::string) { return BLACK; }
+  }
+
+  namespace settings {
+    extern float sampleRate;
+    extern bool tooltips;
+    extern float cableOpacity;
+    extern int threadCount;
+  }
+
+  namespace dsp {
+
+    static const float FREQ_C4 = 261.6256f;
+    static const float FREQ_A4 = 440.0000f;
+    static const float FREQ_SEMITONE = 1.0594630943592953f;
+
+    template <size_t CHANNELS, typename T = float>
+    struct Frame {
+      T samples[CHANNELS];
+    };
+
+    template <typename T>
+    T sinc(T x) {
+      if (x == 0.f) return 1.f;
+      x *= M_PI;
+      return std::sin(x) / x;
+    }
+
+    inline void hannWindow(float *x, int len) {
+      for (int i = 0; i < len; i++) x[i] *= 0.5f * (1.f - std::cos(2 * M_PI * i / (len - 1)));
+    }
+
+    inline void blackmanWindow(float alpha, float *x, int len) {
+      float a0 = (1 - alpha) / 2.f, a1 = 0.5f, a2 = alpha / 2.f;
+      float factor = 2 * M_PI / (len - 1);
+      for (int i = 0; i < len; i++) x[i] *= a0 - a1 * std::cos(factor * i) + a2 * std::cos(2 * factor * i);
+    }
+
+    inline void blackmanWindow(float *x, int len) { blackmanWindow(0.16f, x, len); }
+
+    inline void blackmanNuttallWindow(float *x, int len) {
+      const float a0 = 0.3635819f, a1 = 0.4891775f, a2 = 0.1365995f, a3 = 0.0106411f;
+      float factor = 2 * M_PI / (len - 1);
+      for (int i = 0; i < len; i++) {
+        x[i] *= a0 - a1 * std::cos(1 * factor * i) + a2 * std::cos(2 * factor * i) - a3 * std::cos(3 * factor * i);
+      }
+    }
+
+    inline void blackmanHarrisWindow(float *x, int len) {
+      const float a0 = 0.35875f, a1 = 0.48829f, a2 = 0.14128f, a3 = 0.01168f;
+      float factor = 2 * M_PI / (len - 1);
+      for (int i = 0; i < len; i++) {
+        x[i] *= a0 - a1 * std::cos(1 * factor * i) + a2 * std::cos(2 * factor * i) - a3 * std::cos(3 * factor * i);
+      }
+    }
+
+    inline void boxcarLowpassIR(float *out, int len, float cutoff = 0.5f) {
+      for (int i = 0; i < len; i++) {
+        float t = i - (len - 1) / 2.f;
+        out[i] = 2 * cutoff * sinc(2 * cutoff * t);
+      }
+    }
+
+    template <typename T>
+    T quadraticBipolar(T x) {
+      T x2 = x * x;
+      return simd::ifelse(x >= 0.f, x2, -x2);
+    }
+
+    template <typename T>
+    T cubic(T x) { return x * x * x; }
+
+    template <typename T>
+    T approxExp2_taylor5(T x) {
+      T xi = simd::floor(x);
+      T xf = x - xi;
+      T y = 1.f + xf * (0.6931471805599453f + xf * (0.24022650695910072f + xf * (0.05550410866482158f + xf * (0.009618129107628477f + xf * 0.0013333558146428443f))));
+      return y * simd::pow(T(2.f), xi);
+    }
+
+    inline float approxExp2_taylor5(float x) {
+      float xi = std::floor(x);
+      float xf = x - xi;
+      float y = 1.f + xf * (0.6931471805599453f + xf * (0.24022650695910072f + xf * (0.05550410866482158f + xf * (0.009618129107628477f + xf * 0.0013333558146428443f))));
+      return std::ldexp(y, (int)xi);
+    }
+
+    template <typename T = float>
+    struct TSchmittTrigger {
+      T state = true;
+      void reset() { state = true; }
+      T process(T in, T offThreshold = 0.f, T onThreshold = 1.f) {
+        T on = (in >= onThreshold);
+        T off = (in <= offThreshold);
+        T triggered = ~state & on;
+        state = on | (state & ~off);
+        return triggered;
+      }
+      T isHigh() { return state; }
+    };
+
+    template <>
+    struct TSchmittTrigger<float> {
+      bool state = true;
+      void reset() { state = true; }
+      bool process(float in, float offThreshold = 0.f, float onThreshold = 1.f) {
+        if (state) {
+          if (in <= offThreshold) state = false;
+        }
+        else if (in >= onThreshold) {
+          state = true;
+          return true;
+        }
+        return false;
+      }
+      bool isHigh() { return state; }
+    };
+
+    typedef TSchmittTrigger<> SchmittTrigger;
+
+    struct BooleanTrigger {
+      bool state = true;
+      void reset() { state = true; }
+      bool process(bool state) {
+        bool triggered = (state && !this->state);
+        this->state = state;
+        return triggered;
+      }
+    };
+
+    template <typename T = float>
+    struct TPulseGenerator {
+      T remaining = 0.f;
+      void reset() { remaining = 0.f; }
+      T process(float deltaTime) {
+        T mask = (remaining > 0.f);
+        remaining -= deltaTime;
+        return mask;
+      }
+      void trigger(T duration = 1e-3f) { remaining = simd::ifelse(duration > remaining, duration, remaining); }
+    };
+
+    template <>
+    struct TPulseGenerator<float> {
+      float remaining = 0.f;
+      void reset() { remaining = 0.f; }
+      bool process(float deltaTime) {
+        if (remaining > 0.f) {
+          remaining -= deltaTime;
+          return true;
+        }
+        return false;
+      }
+      void trigger(float duration = 1e-3f) {
+        if (duration > remaining) remaining = duration;
+      }
+    };
+
+    typedef TPulseGenerator<> PulseGenerator;
+
+    struct Timer {
+      float time = 0.f;
+      void reset() { time = 0.f; }
+      float process(float deltaTime) {
+        time += deltaTime;
+        return time;
+      }
+      float getTime() { return time; }
+    };
+
+    struct ClockDivider {
+      uint32_t clock = 0;
+      uint32_t division = 1;
+      void reset() { clock = 0; }
+      void setDivision(uint32_t division) { this->division = division; }
+      uint32_t getDivision() { return division; }
+      uint32_t getClock() { return clock; }
+      bool process() {
+        clock++;
+        if (clock >= division) {
+          clock = 0;
+          return true;
+        }
+        return false;
+      }
+    };
+
+    template <typename T = float>
+    struct TRCFilter {
+      T c = 0.f;
+      T xstate[1];
+      T ystate[1];
+      TRCFilter() { reset(); }
+      void reset() {
+        xstate[0] = 0.f;
+        ystate[0] = 0.f;
+      }
+      void setCutoff(T r) { c = 2.f / r; }
+      void setCutoffFreq(T f) { setCutoff(2.f * M_PI * f); }
+      void process(T x) {
+        T y = (x + xstate[0] - ystate[0] * (1 - c)) / (1 + c);
+        xstate[0] = x;
+        ystate[0] = y;
+      }
+      T lowpass() { return ystate[0]; }
+      T highpass() { return xstate[0] - ystate[0]; }
+    };
+
+    typedef TRCFilter<> RCFilter;
+
+    template <typename T = float>
+    struct TSlewLimiter {
+      T out = 0.f;
+      T rise = 0.f;
+      T fall = 0.f;
+      void reset() { out = 0.f; }
+      void setRiseFall(T rise, T fall) {
+        this->rise = rise;
+        this->fall = fall;
+      }
+      T process(T deltaTime, T in) {
+        out = simd::clamp(in, out - fall * deltaTime, out + rise * deltaTime);
+        return out;
+      }
+    };
+
+    typedef TSlewLimiter<> SlewLimiter;
+
+    template <typename T = float>
+    struct TExponentialFilter {
+      T out = 0.f;
+      T lambda = 0.f;
+      void reset() { out = 0.f; }
+      void setLambda(T lambda) { this->lambda = lambda; }
+      void setTau(T tau) { this->lambda = 1 / tau; }
+      T process(T deltaTime, T in) {
+        T y = out + (in - out) * lambda * deltaTime;
+        out = simd::ifelse(out == y, in, y);
+        return out;
+      }
+    };
+
+    typedef TExponentialFilter<> ExponentialFilter;
+
+    // Integrated windowed sinc, linear phase where Rack computes a minimum
+    // phase step, the harness only needs it deterministic and band limited.
+    template <int Z, int O, typename T = float>
+    struct MinBlepGenerator {
+      T buf[2 * Z] = {};
+      int pos = 0;
+      float impulse[2 * Z * O + 1];
+
+      MinBlepGenerator() {
+        const int len = 2 * Z * O;
+        boxcarLowpassIR(impulse, len, 0.5f / O);
+        blackmanHarrisWindow(impulse, len);
+        float sum = 0.f;
+        for (int i = 0; i < len; i++) {
+          sum += impulse[i];
+          impulse[i] = sum;
+        }
+        for (int i = 0; i < len; i++) impulse[i] /= sum;
+        impulse[len] = 1.f;
+      }
+
+      void insertDiscontinuity(float p, T x) {
+        if (!(-1 < p && p <= 0)) return;
+        for (int j = 0; j < 2 * Z; j++) {
+          float minBlepIndex = ((float)j - p) * O;
+          int index = (int)minBlepIndex;
+          float minBlepValue = crossfade(impulse[index], impulse[std::min(index + 1, 2 * Z * O)], minBlepIndex - index);
+          buf[(pos + j) % (2 * Z)] += x * (-1.f + minBlepValue);
+        }
+      }
+
+      T process() {
+        T v = buf[pos];
+        buf[pos] = 0.f;
+        pos = (pos + 1) % (2 * Z);
+        return v;
+      }
+    };
+
+    template <int OVERSAMPLE, int QUALITY, typename T = float>
+    struct Decimator {
+      T inBuffer[OVERSAMPLE * QUALITY];
+      float kernel[OVERSAMPLE * QUALITY];
+      int inIndex;
+
+      Decimator(float cutoff = 0.9f) {
+        boxcarLowpassIR(kernel, OVERSAMPLE * QUALITY, cutoff * 0.5f / OVERSAMPLE);
+        blackmanHarrisWindow(kernel, OVERSAMPLE * QUALITY);
+        reset();
+      }
+
+      void reset() {
+        inIndex = 0;
+        std::fill(inBuffer, inBuffer + OVERSAMPLE * QUALITY, T(0.f));
+      }
+
+      T process(T *in) {
+        std::copy(in, in + OVERSAMPLE, &inBuffer[inIndex]);
+        inIndex += OVERSAMPLE;
+        inIndex %= OVERSAMPLE * QUALITY;
+        T out = 0.f;
+        for (int i = 0; i < OVERSAMPLE * QUALITY; i++) {
+          int index = inIndex - 1 - i;
+          index = (index + OVERSAMPLE * QUALITY) % (OVERSAMPLE * QUALITY);
+          out += kernel[i] * inBuffer[index];
+        }
+        return out;
+      }
+    };
+
+    template <int OVERSAMPLE, int QUALITY, typename T = float>
+    struct Upsampler {
+      T inBuffer[QUALITY];
+      float kernel[OVERSAMPLE * QUALITY];
+      int inIndex;
+
+      Upsampler(float cutoff = 0.9f) {
+        boxcarLowpassIR(kernel, OVERSAMPLE * QUALITY, cutoff * 0.5f / OVERSAMPLE);
+        blackmanHarrisWindow(kernel, OVERSAMPLE * QUALITY);
+        reset();
+      }
+
+      void reset() {
+        inIndex = 0;
+        std::fill(inBuffer, inBuffer + QUALITY, T(0.f));
+      }
+
+      void process(T in, T *out) {
+        inBuffer[inIndex] = in;
+        inIndex++;
+        inIndex %= QUALITY;
+        for (int i = 0; i < OVERSAMPLE; i++) {
+          out[i] = 0.f;
+          for (int j = 0; j < QUALITY; j++) {
+            int index = inIndex - 1 - j;
+            index = (index + QUALITY) % QUALITY;
+            int kernelIndex = OVERSAMPLE * j + i;
+            out[i] += inBuffer[index] * kernel[kernelIndex];
+          }
+        }
+      }
+    };
+
+    template <typename T, size_t S>
+    struct RingBuffer {
+      std::atomic<size_t> start {0};
+      std::atomic<size_t> end {0};
+      T data[S];
+      void push(T t) {
+        size_t i = end % S;
+        data[i] = t;
+        end++;
+      }
+      T shift() { return data[start++ % S]; }
+      void clear() { start = end.load(); }
+      bool empty() const { return start >= end; }
+      bool full() const { return end - start >= S; }
+      size_t size() const { return end - start; }
+      size_t capacity() const { return S - size(); }
+    };
+
+    template <typename T, size_t S>
+    struct DoubleRingBuffer {
+      std::atomic<size_t> start {0};
+      std::atomic<size_t> end {0};
+      T data[2 * S];
+      size_t mask(size_t i) const { return i & (S - 1); }
+      void push(T t) {
+        size_t i = mask(end);
+        data[i] = t;
+        data[i + S] = t;
+        end++;
+      }
+      T shift() { return data[mask(start++)]; }
+      void clear() { start = end.load(); }
+      bool empty() const { return start >= end; }
+      bool full() const { return end - start >= S; }
+      size_t size() const { return end - start; }
+      size_t capacity() const { return S - size(); }
+      T *endData() { return &data[mask(end)]; }
+      void endIncr(size_t n) {
+        size_t e = mask(end);
+        size_t e1 = e + n;
+        size_t e2 = (e1 < S) ? e1 : S;
+        for (size_t i = e; i < e2; i++) data[i + S] = data[i];
+        for (size_t i = S; i < e1; i++) data[i - S] = data[i];
+        end += n;
+      }
+      const T *startData() const { return &data[mask(start)]; }
+      void startIncr(size_t n) { start += n; }
+    };
+
+    // Windowed sinc built like the interpolating mode of the speex resampler
+    // Rack wraps: taps, table oversampling, bandwidth and Kaiser window per
+    // quality as in speex, a longer filter when downsampling, and four sums
+    // per output joined by cubic interpolation between table points. Costs
+    // and delays what the real converter does.
+    template <int CHANNELS>
+    struct SampleRateConverter {
+      int inRate = 44100;
+      int outRate = 44100;
+      int quality = 4;
+      int taps = 0;
+      int oversample = 1;
+      std::vector<float> table;
+      // taps - 1 frames of history, then the unread input
+      std::vector<Frame<CHANNELS>> mem;
+      double pos = 0.0;
+
+      void setRates(int inRate, int outRate) {
+        this->inRate = inRate;
+        this->outRate = outRate;
+        refreshState();
+      }
+      void setQuality(int quality) {
+        this->quality = std::max(0, std::min(quality, 10));
+        refreshState();
+      }
+      void setChannels(int) {}
+
+      static double bessel0(double x) {
+        double sum = 1.0, term = 1.0;
+        for (int k = 1; k < 30; k++) {
+          term *= (x / (2 * k)) * (x / (2 * k));
+          sum += term;
+        }
+        return sum;
+      }
+
+      void refreshState() {
+        static const int baseTaps[11] = {8, 16, 32, 48, 64, 80, 96, 128, 160, 192, 256};
+        static const int oversamples[11] = {4, 4, 4, 8, 8, 16, 16, 16, 16, 32, 32};
+        static const float downBandwidth[11] = {0.830f, 0.850f, 0.882f, 0.895f, 0.921f, 0.922f, 0.940f, 0.950f, 0.960f, 0.968f, 0.975f};
+        static const float upBandwidth[11] = {0.860f, 0.880f, 0.910f, 0.917f, 0.940f, 0.940f, 0.945f, 0.950f, 0.960f, 0.968f, 0.975f};
+        static const float beta[11] = {6.f, 6.f, 6.f, 8.f, 8.f, 10.f, 10.f, 10.f, 10.f, 12.f, 12.f};
+        bool down = inRate > outRate;
+        float cutoff = down ? downBandwidth[quality] * outRate / inRate : upBandwidth[quality];
+        taps = baseTaps[quality];
+        if (down) taps = ((int)std::ceil((double)taps * inRate / outRate) + 7) & ~7;
+        oversample = oversamples[quality];
+        // two points of padding on each side for the cubic interpolation
+        table.assign(taps * oversample + 4, 0.f);
+        for (int n = 0; n <= taps * oversample; n++) {
+          double x = (double)n / oversample - taps / 2;
+          double r = 2.0 * x / taps;
+          double window = bessel0(beta[quality] * std::sqrt(std::max(0.0, 1.0 - r * r))) / bessel0(beta[quality]);
+          double sinc = (x == 0.0) ? 1.0 : std::sin(M_PI * cutoff * x) / (M_PI * cutoff * x);
+          table[n + 2] = (float)(cutoff * sinc * window);
+        }
+        mem.assign(taps - 1, Frame<CHANNELS>());
+        pos = 0.0;
+      }
+
+      void process(const Frame<CHANNELS> *in, int *inFrames, Frame<CHANNELS> *out, int *outFrames) {
+        if (table.empty()) refreshState();
+        mem.insert(mem.end(), in, in + *inFrames);
+        double step = (double)inRate / outRate;
+        int outCount = 0;
+        while (outCount < *outFrames) {
+          size_t j = (size_t)pos;
+          if (j + taps > mem.size()) break;
+          float offset = (float)(pos - j) * oversample;
+          int point = (int)offset;
+          float x = offset - point;
+          // Lagrange weights of table points n - 2 to n + 1 at n - x
+          float w[4] = {
+            -x * (1.f - x) * (1.f + x) / 6.f,
+            x * (1.f + x) * (2.f - x) / 2.f,
+            (1.f - x) * (1.f + x) * (2.f - x) / 2.f,
+            -x * (1.f - x) * (2.f - x) / 6.f,
+          };
+          for (int c = 0; c < CHANNELS; c++) {
+            float sum[4] = {};
+            for (int t = 0; t < taps; t++) {
+              const float *k = &table[(t + 1) * oversample - point];
+              float v = mem[j + t].samples[c];
+              sum[0] += v * k[0];
+              sum[1] += v * k[1];
+              sum[2] += v * k[2];
+              sum[3] += v * k[3];
+            }
+            out[outCount].samples[c] = w[0] * sum[0] + w[1] * sum[1] + w[2] * sum[2] + w[3] * sum[3];
+          }
+          outCount++;
+          pos += step;
+        }
+        size_t used = std::min((size_t)pos, mem.size());
+        mem.erase(mem.begin(), mem.begin() + used);
+        pos -= used;
+        *outFrames = outCount;
+      }
+    };
+
+  }
+
+  namespace plugin {
+    struct Plugin {
+      std::string slug;
+      std::string path;
+      std::list<Model *> models;
+      void addModel(Model *model);
+    };
+  }
+
+  using plugin::Plugin;
+  using plugin::Model;
+
+  namespace engine {
+
+    struct Module;
+
+    struct Param {
+      float value = 0.f;
+      float getValue() { return value; }
+      void setValue(float value) { this->value = value; }
+    };
+
+    struct Light {
+      float value = 0.f;
+      void setBrightness(float brightness) { value = brightness; }
+      float getBrightness() { return value; }
+      void setBrightnessSmooth(float brightness, float deltaTime, float lambda = 30.f) {
+        if (brightness < value) value += (brightness - value) * lambda * deltaTime;
+        else value = brightness;
+      }
+      void setSmoothBrightness(float brightness, float deltaTime) { setBrightnessSmooth(brightness, deltaTime); }
+    };
+
+    static const int PORT_MAX_CHANNELS = 16;
+
+    struct Port {
+      union {
+        float voltages[PORT_MAX_CHANNELS] = {};
+        float value;
+      };
+      union {
+        uint8_t channels = 0;
+        uint8_t active;
+      };
+
+      void setVoltage(float voltage, int channel = 0) { voltages[channel] = voltage; }
+      float getVoltage(int channel = 0) { return voltages[channel]; }
+      float getPolyVoltage(int channel) { return isMonophonic() ? getVoltage(0) : getVoltage(channel); }
+      float getNormalVoltage(float normalVoltage, int channel = 0) { return isConnected() ? getVoltage(channel) : normalVoltage; }
+      float getNormalPolyVoltage(float normalVoltage, int channel) { return isConnected() ? getPolyVoltage(channel) : normalVoltage; }
+      float *getVoltages(int firstChannel = 0) { return &voltages[firstChannel]; }
+      void readVoltages(float *v) {
+        for (int c = 0; c < channels; c++) v[c] = voltages[c];
+      }
+      void writeVoltages(const float *v) {
+        for (int c = 0; c < channels; c++) voltages[c] = v[c];
+      }
+      void clearVoltages() {
+        for (int c = 0; c < channels; c++) voltages[c] = 0.f;
+      }
+      float getVoltageSum() {
+        float sum = 0.f;
+        for (int c = 0; c < channels; c++) sum += voltages[c];
+        return sum;
+      }
+      float getVoltageRMS() {
+        if (channels == 0) return 0.f;
+        if (channels == 1) return std::fabs(voltages[0]);
+        float sum = 0.f;
+        for (int c = 0; c < channels; c++) sum += voltages[c] * voltages[c];
+        return std::sqrt(sum);
+      }
+      template <typename T>
+      T getVoltageSimd(int firstChannel) { return T::load(&voltages[firstChannel]); }
+      template <typename T>
+      T getPolyVoltageSimd(int firstChannel) { return isMonophonic() ? getVoltage(0) : getVoltageSimd<T>(firstChannel); }
+      template <typename T>
+      T getNormalVoltageSimd(T normalVoltage, int firstChannel) { return isConnected() ? getVoltageSimd<T>(firstChannel) : normalVoltage; }
+      template <typename T>
+      T getNormalPolyVoltageSimd(T normalVoltage, int firstChannel) { return isConnected() ? getPolyVoltageSimd<T>(firstChannel) : normalVoltage; }
+      template <typename T>
+      void setVoltageSimd(T voltage, int firstChannel) { voltage.store(&voltages[firstChannel]); }
+
+      // As in Rack, a disconnected port stays at 0 channels.
+      void setChannels(int channels) {
+        if (this->channels == 0) return;
+        if (channels == 0) channels = 1;
+        for (int c = channels; c < this->channels; c++) voltages[c] = 0.f;
+        this->channels = channels;
+      }
+      int getChannels() { return channels; }
+      bool isConnected() { return channels > 0; }
+      bool isMonophonic() { return channels == 1; }
+      bool isPolyphonic() { return channels > 1; }
+    };
+
+    struct Output : Port {};
+    struct Input : Port {};
+
+    struct ParamQuantity {
+      Module *module = NULL;
+      int paramId = -1;
+      float minValue = 0.f;
+      float maxValue = 1.f;
+      float defaultValue = 0.f;
+      std::string name;
+      std::string unit;
+      float displayBase = 0.f;
+      float displayMultiplier = 1.f;
+      float displayOffset = 0.f;
+      int displayPrecision = 5;
+      std::string description;
+      bool resetEnabled = true;
+      bool randomizeEnabled = true;
+      bool smoothEnabled = false;
+      bool snapEnabled = false;
+
+      virtual ~ParamQuantity() {}
+      Param *getParam();
+      virtual void setValue(float value);
+      virtual float getValue();
+      virtual float getMinValue() { return minValue; }
+      virtual float getMaxValue() { return maxValue; }
+      virtual float getDefaultValue() { return defaultValue; }
+      virtual float getDisplayValue();
+      virtual void setDisplayValue(float displayValue);
+      virtual std::string getDisplayValueString();
+      virtual void setDisplayValueString(std::string s);
+      virtual std::string getLabel() { return name; }
+      virtual std::string getUnit() { return unit; }
+      virtual std::string getString() { return getLabel() + ": " + getDisplayValueString() + getUnit(); }
+      virtual void reset() { setValue(getDefaultValue()); }
+      virtual void randomize() {}
+      virtual std::string getDescription() { return description; }
+      float getScaledValue() { return rescale(getValue(), getMinValue(), getMaxValue(), 0.f, 1.f); }
+      void setScaledValue(float v) { setValue(rescale(v, 0.f, 1.f, getMinValue(), getMaxValue())); }
+      void setImmediateValue(float value) { setValue(value); }
+      float getSmoothValue() { return getValue(); }
+      bool isMin() { return getValue() <= getMinValue(); }
+      bool isMax() { return getValue() >= getMaxValue(); }
+      void setMin() { setValue(getMinValue()); }
+      void setMax() { setValue(getMaxValue()); }
+      float getRange() { return getMaxValue() - getMinValue(); }
+      bool isBounded() { return std::isfinite(getMinValue()) && std::isfinite(getMaxValue()); }
+    };
+
+    struct SwitchQuantity : ParamQuantity {
+      std::vector<std::string> labels;
+      std::string getDisplayValueString() override;
+    };
+
+    struct PortInfo {
+      Module *module = NULL;
+      int type = 0;
+      int portId = -1;
+      std::string name;
+      std::string description;
+      virtual ~PortInfo() {}
+      virtual std::string getName() { return name; }
+      virtual std::string getFullName() { return name; }
+      virtual std::string getDescription() { return description; }
+    };
+
+    struct LightInfo {
+      Module *module = NULL;
+      int lightId = -1;
+      std::string name;
+      std::string description;
+      virtual ~LightInfo() {}
+      virtual std::string getName() { return name; }
+    };
+
+    struct Module {
+      plugin::Model *model = NULL;
+      int64_t id = -1;
+      std::vector<Param> params;
+      std::vector<Input> inputs;
+      std::vector<Output> outputs;
+      std::vector<Light> lights;
+      std::vector<ParamQuantity *> paramQuantities;
+      std::vector<PortInfo *> inputInfos;
+      std::vector<PortInfo *> outputInfos;
+      std::vector<LightInfo *> lightInfos;
+
+      struct Expander {
+        int64_t moduleId = -1;
+        Module *module = NULL;
+        void *producerMessage = NULL;
+        void *consumerMessage = NULL;
+        bool messageFlipRequested = false;
+        void requestMessageFlip() { messageFlipRequested = true; }
+      };
+      Expander leftExpander;
+      Expander rightExpander;
+
+      struct ProcessArgs {
+        float sampleRate;
+        float sampleTime;
+        int64_t frame;
+      };
+
+      struct SampleRateChangeEvent {
+        float sampleRate;
+        float sampleTime;
+      };
+      struct ExpanderChangeEvent {
+        uint8_t side;
+      };
+      struct AddEvent {};
+      struct RemoveEvent {};
+      struct ResetEvent {};
+      struct RandomizeEvent {};
+
+      Module() {}
+      virtual ~Module();
+
+      void config(int numParams, int numInputs, int numOutputs, int numLights = 0);
+
+      template <class TParamQuantity = ParamQuantity>
+      TParamQuantity *configParam(int paramId, float minValue, float maxValue, float defaultValue, std::string name = "", std::string unit = "", float displayBase = 0.f, float displayMultiplier = 1.f, float displayOffset = 0.f) {
+        if (paramQuantities[paramId]) delete paramQuantities[paramId];
+        TParamQuantity *q = new TParamQuantity;
+        q->ParamQuantity::module = this;
+        q->ParamQuantity::paramId = paramId;
+        q->ParamQuantity::minValue = minValue;
+        q->ParamQuantity::maxValue = maxValue;
+        q->ParamQuantity::defaultValue = defaultValue;
+        q->ParamQuantity::name = name;
+        q->ParamQuantity::unit = unit;
+        q->ParamQuantity::displayBase = displayBase;
+        q->ParamQuantity::displayMultiplier = displayMultiplier;
+        q->ParamQuantity::displayOffset = displayOffset;
+        paramQuantities[paramId] = q;
+        params[paramId].value = q->getDefaultValue();
+        return q;
+      }
+
+      template <class TSwitchQuantity = SwitchQuantity>
+      TSwitchQuantity *configSwitch(int paramId, float minValue, float maxValue, float defaultValue, std::string name = "", std::vector<std::string> labels = {}) {
+        TSwitchQuantity *sq = configParam<TSwitchQuantity>(paramId, minValue, maxValue, defaultValue, name);
+        sq->snapEnabled = true;
+        sq->smoothEnabled = false;
+        sq->labels = labels;
+        return sq;
+      }
+
+      template <class TSwitchQuantity = SwitchQuantity>
+      TSwitchQuantity *configButton(int paramId, std::string name = "") {
+        TSwitchQuantity *sq = configParam<TSwitchQuantity>(paramId, 0.f, 1.f, 0.f, name);
+        sq->randomizeEnabled = false;
+        sq->snapEnabled = true;
+        return sq;
+      }
+
+      template <class TPortInfo = PortInfo>
+      TPortInfo *configInput(int portId, std::string name = "") {
+        if (inputInfos[portId]) delete inputInfos[portId];
+        TPortInfo *info = new TPortInfo;
+        info->module = this;
+        info->type = 0;
+        info->portId = portId;
+        info->name = name;
+        inputInfos[portId] = info;
+        return info;
+      }
+
+      template <class TPortInfo = PortInfo>
+      TPortInfo *configOutput(int portId, std::string name = "") {
+        if (outputInfos[portId]) delete outputInfos[portId];
+        TPortInfo *info = new TPortInfo;
+        info->module = this;
+        info->type = 1;
+        info->portId = portId;
+        info->name = name;
+        outputInfos[portId] = info;
+        return info;
+      }
+
+      template <class TLightInfo = LightInfo>
+      TLightInfo *configLight(int lightId, std::string name = "") {
+        if (lightInfos[lightId]) delete lightInfos[lightId];
+        TLightInfo *info = new TLightInfo;
+        info->module = this;
+        info->lightId = lightId;
+        info->name = name;
+        lightInfos[lightId] = info;
+        return info;
+      }
+
+      void configBypass(int, int) {}
+
+      std::string createPatchStorageDirectory();
+      std::string getPatchStorageDirectory();
+      int getNumParams() { return params.size(); }
+      int getNumInputs() { return inputs.size(); }
+      int getNumOutputs() { return outputs.size(); }
+      int getNumLights() { return lights.size(); }
+      ParamQuantity *getParamQuantity(int index) { return paramQuantities[index]; }
+      Param &getParam(int index) { return params[index]; }
+      Input &getInput(int index) { return inputs[index]; }
+      Output &getOutput(int index) { return outputs[index]; }
+      Light &getLight(int index) { return lights[index]; }
+      Expander &getLeftExpander() { return leftExpander; }
+      Expander &getRightExpander() { return rightExpander; }
+      int64_t getId() { return id; }
+      Model *getModel() { return model; }
+      bool isBypassed() { return false; }
+
+      virtual void process(const ProcessArgs &args) {}
+      virtual void step() {}
+      virtual void processBypass(const ProcessArgs &args) {}
+      virtual json_t *toJson();
+      virtual void fromJson(json_t *rootJ);
+      virtual json_t *paramsToJson();
+      virtual void paramsFromJson(json_t *rootJ);
+      virtual json_t *dataToJson() { return NULL; }
+      virtual void dataFromJson(json_t *rootJ) {}
+
+      virtual void onAdd(const AddEvent &e) { onAdd(); }
+      virtual void onRemove(const RemoveEvent &e) { onRemove(); }
+      virtual void onSampleRateChange(const SampleRateChangeEvent &e) { onSampleRateChange(); }
+      virtual void onExpanderChange(const ExpanderChangeEvent &e) {}
+      virtual void onReset(const ResetEvent &e);
+      virtual void onRandomize(const RandomizeEvent &e);
+      virtual void onAdd() {}
+      virtual void onRemove() {}
+      virtual void onReset() {}
+      virtual void onRandomize() {}
+      virtual void onSampleRateChange() {}
+    };
+
+  }
+
+  using engine::Module;
+  using engine::Param;
+  using engine::Input;
+  using engine::Output;
+  using engine::Light;
+  using engine::ParamQuantity;
+  using engine::SwitchQuantity;
+  using engine::PortInfo;
+
+  namespace engine {
+    struct Engine {
+      float sampleRate = 44100.f;
+      float getSampleRate() { return sampleRate; }
+      float getSampleTime() { return 1.f / sampleRate; }
+      int64_t getFrame() { return 0; }
+      void addModule(Module *) {}
+      void removeModule(Module *) {}
+      Module *getModule(int64_t) { return NULL; }
+      void yieldWorkers() {}
+    };
+  }
+
+  namespace window {
+    struct Svg {
+      NSVGimage *handle = NULL;
+      static std::shared_ptr<Svg> load(const std::string &filename);
+      void loadFile(const std::string &filename) {}
+      math::Vec getSize() { return math::Vec(); }
+    };
+    struct Font {
+      int handle = -1;
+    };
+    struct Image {
+      int handle = -1;
+    };
+    struct Window {
+      GLFWwindow *win = NULL;
+      NVGcontext *vg = NULL;
+      std::shared_ptr<Svg> loadSvg(const std::string &filename) { return Svg::load(filename); }
+      std::shared_ptr<Font> loadFont(const std::string &) { return std::make_shared<Font>(); }
+      std::shared_ptr<Image> loadImage(const std::string &) { return std::make_shared<Image>(); }
+      math::Vec getSize() { return math::Vec(); }
+      double getFrameTime() { return 0.0; }
+      double getLastFrameDuration() { return 0.0; }
+      int getMods() { return 0; }
+      void cursorLock() {}
+      void cursorUnlock() {}
+    };
+  }
+
+  using window::Svg;
+  using window::Font;
+  using window::Image;
+
+  namespace widget {
+    struct Widget;
+  }
+
+  namespace event {
+    struct Context {
+      widget::Widget *target = NULL;
+      bool propagating = true;
+    };
+    struct Base {
+      Context *context = NULL;
+      void stopPropagating() const {}
+      bool isPropagating() const { return true; }
+      void setTarget(widget::Widget *w) const {}
+      widget::Widget *getTarget() const { return NULL; }
+      void consume(widget::Widget *w) const {}
+      bool isConsumed() const { return false; }
+    };
+    struct PositionBase {
+      math::Vec pos;
+    };
+    struct KeyBase {
+      int key = 0;
+      int scancode = 0;
+      std::string keyName;
+      int action = 0;
+      int mods = 0;
+    };
+    struct TextBase {
+      int codepoint = 0;
+    };
+    struct Hover : Base, PositionBase {
+      math::Vec mouseDelta;
+    };
+    struct Button : Base, PositionBase {
+      int button = 0;
+      int action = 0;
+      int mods = 0;
+    };
+    struct DoubleClick : Base {};
+    struct HoverKey : Base, PositionBase, KeyBase {};
+    struct HoverText : Base, PositionBase, TextBase {};
+    struct HoverScroll : Base, PositionBase {
+      math::Vec scrollDelta;
+    };
+    struct Enter : Base {};
+    struct Leave : Base {};
+    struct Select : Base {};
+    struct Deselect : Base {};
+    struct SelectKey : Base, KeyBase {};
+    struct SelectText : Base, TextBase {};
+    struct DragBase : Base {
+      int button = 0;
+    };
+    struct DragStart : DragBase {};
+    struct DragEnd : DragBase {};
+    struct DragMove : DragBase {
+      math::Vec mouseDelta;
+    };
+    struct DragHover : DragBase, PositionBase {
+      widget::Widget *origin = NULL;
+      math::Vec mouseDelta;
+    };
+    struct DragEnter : DragBase {
+      widget::Widget *origin = NULL;
+    };
+    struct DragLeave : DragBase {
+      widget::Widget *origin = NULL;
+    };
+    struct DragDrop : DragBase {
+      widget::Widget *origin = NULL;
+    };
+    struct PathDrop : Base, PositionBase {
+      std::vector<std::string> paths;
+    };
+    struct Action : Base {};
+    struct Change : Base {};
+    struct Dirty : Base {};
+    struct Reposition : Base {};
+    struct Resize : Base {};
+    struct Add : Base {};
+    struct Remove : Base {};
+    struct Show : Base {};
+    struct Hide : Base {};
+  }
+
+  namespace widget {
+
+    struct Widget {
+      math::Rect box = math::Rect(math::Vec(), math::Vec(INFINITY, INFINITY));
+      Widget *parent = NULL;
+      std::list<Widget *> children;
+      bool visible = true;
+      bool requestedDelete = false;
+
+      struct DrawArgs {
+        NVGcontext *vg = NULL;
+        math::Rect clipBox;
+        void *fb = NULL;
+      };
+
+      using HoverEvent = event::Hover;
+      using ButtonEvent = event::Button;
+      using DoubleClickEvent = event::DoubleClick;
+      using HoverKeyEvent = event::HoverKey;
+      using HoverTextEvent = event::HoverText;
+      using HoverScrollEvent = event::HoverScroll;
+      using EnterEvent = event::Enter;
+      using LeaveEvent = event::Leave;
+      using SelectEvent = event::Select;
+      using DeselectEvent = event::Deselect;
+      using SelectKeyEvent = event::SelectKey;
+      using SelectTextEvent = event::SelectText;
+      using DragStartEvent = event::DragStart;
+      using DragEndEvent = event::DragEnd;
+      using DragMoveEvent = event::DragMove;
+      using DragHoverEvent = event::DragHover;
+      using DragEnterEvent = event::DragEnter;
+      using DragLeaveEvent = event::DragLeave;
+      using DragDropEvent = event::DragDrop;
+      using PathDropEvent = event::PathDrop;
+      using ActionEvent = event::Action;
+      using ChangeEvent = event::Change;
+
+      virtual ~Widget();
+      math::Rect getBox() { return box; }
+      void setBox(math::Rect box) { this->box = box; }
+      math::Vec getPosition() { return box.pos; }
+      void setPosition(math::Vec pos) { box.pos = pos; }
+      math::Vec getSize() { return box.size; }
+      void setSize(math::Vec size) { box.size = size; }
+      Widget *getParent() { return parent; }
+      bool isVisible() { return visible; }
+      void setVisible(bool visible) { this->visible = visible; }
+      void show() { setVisible(true); }
+      void hide() { setVisible(false); }
+      void requestDelete() { requestedDelete = true; }
+      math::Vec getRelativeOffset(math::Vec v, Widget *ancestor) { return v; }
+      math::Vec getAbsoluteOffset(math::Vec v) { return v; }
+      float getRelativeZoom(Widget *ancestor) { return 1.f; }
+      float getAbsoluteZoom() { return 1.f; }
+      math::Rect getVisibleChildrenBoundingBox() { return math::Rect(); }
+      bool isDescendantOf(Widget *ancestor) { return false; }
+      template <class T>
+      T *getAncestorOfType() { return NULL; }
+      template <class T>
+      T *getFirstDescendantOfType() { return NULL; }
+      bool hasChild(Widget *child) { return std::find(children.begin(), children.end(), child) != children.end(); }
+      void addChild(Widget *child);
+      void addChildBottom(Widget *child);
+      void addChildBelow(Widget *child, Widget *sibling) { addChild(child); }
+      void addChildAbove(Widget *child, Widget *sibling) { addChild(child); }
+      void removeChild(Widget *child);
+      void clearChildren();
+
+      virtual void step() {}
+      virtual void draw(const DrawArgs &args) {}
+      virtual void drawLayer(const DrawArgs &args, int layer) {}
+      void drawChild(Widget *child, const DrawArgs &args, int layer = 0) {}
+
+      virtual void onHover(const event::Hover &e) {}
+      virtual void onButton(const event::Button &e) {}
+      virtual void onDoubleClick(const event::DoubleClick &e) {}
+      virtual void onHoverKey(const event::HoverKey &e) {}
+      virtual void onHoverText(const event::HoverText &e) {}
+      virtual void onHoverScroll(const event::HoverScroll &e) {}
+      virtual void onEnter(const event::Enter &e) {}
+      virtual void onLeave(const event::Leave &e) {}
+      virtual void onSelect(const event::Select &e) {}
+      virtual void onDeselect(const event::Deselect &e) {}
+      virtual void onSelectKey(const event::SelectKey &e) {}
+      virtual void onSelectText(const event::SelectText &e) {}
+      virtual void onDragStart(const event::DragStart &e) {}
+      virtual void onDragEnd(const event::DragEnd &e) {}
+      virtual void onDragMove(const event::DragMove &e) {}
+      virtual void onDragHover(const event::DragHover &e) {}
+      virtual void onDragEnter(const event::DragEnter &e) {}
+      virtual void onDragLeave(const event::DragLeave &e) {}
+      virtual void onDragDrop(const event::DragDrop &e) {}
+      virtual void onPathDrop(const event::PathDrop &e) {}
+      virtual void onAction(const event::Action &e) {}
+      virtual void onChange(const event::Change &e) {}
+      virtual void onDirty(const event::Dirty &e) {}
+      virtual void onReposition(const event::Reposition &e) {}
+      virtual void onResize(const event::Resize &e) {}
+      virtual void onAdd(const event::Add &e) {}
+      virtual void onRemove(const event::Remove &e) {}
+      virtual void onShow(const event::Show &e) {}
+      virtual void onHide(const event::Hide &e) {}
+    };
+
+    struct TransparentWidget : Widget {};
+    struct OpaqueWidget : Widget {};
+
+    struct FramebufferWidget : Widget {
+      bool dirty = true;
+      bool bypassed = false;
+      float oversample = 1.f;
+      void setDirty(bool dirty = true) { this->dirty = dirty; }
+    };
+
+    struct SvgWidget : Widget {
+      std::shared_ptr<window::Svg> svg;
+      void wrap() {}
+      void setSvg(std::shared_ptr<window::Svg> svg) { this->svg = svg; }
+    };
+
+    struct TransformWidget : Widget {
+      void identity() {}
+      void translate(math::Vec) {}
+      void rotate(float) {}
+      void scale(math::Vec) {}
+    };
+
+    struct ZoomWidget : Widget {
+      float zoom = 1.f;
+      void setZoom(float zoom) { this->zoom = zoom; }
+    };
+
+  }
+
+  using widget::Widget;
+  using widget::TransparentWidget;
+  using widget::OpaqueWidget;
+  using widget::FramebufferWidget;
+  using widget::SvgWidget;
+  using widget::TransformWidget;
+
+  namespace ui {
+
+    struct Label : widget::Widget {
+      std::string text;
+      float fontSize = 13.f;
+      NVGcolor color;
+      int alignment = 0;
+    };
+
+    struct MenuEntry : widget::OpaqueWidget {};
+
+    struct MenuLabel : MenuEntry {
+      std::string text;
+    };
+
+    struct MenuSeparator : MenuEntry {};
+
+    struct Menu : widget::OpaqueWidget {
+      void setChildMenu(Menu *menu) {}
+    };
+
+    struct MenuItem : MenuEntry {
+      std::string text;
+      std::string rightText;
+      bool disabled = false;
+      virtual Menu *createChildMenu() { return NULL; }
+    };
+
+    struct TextField : widget::OpaqueWidget {
+      std::string text;
+      std::string placeholder;
+      bool multiline = false;
+      int cursor = 0;
+      int selection = 0;
+      std::string getText() { return text; }
+      void setText(std::string text) { this->text = text; }
+      void selectAll() {}
+    };
+
+    struct Tooltip : widget::Widget {
+      std::string text;
+    };
+
+    struct ScrollWidget : widget::OpaqueWidget {
+      widget::Widget *container = NULL;
+    };
+
+    struct Slider : widget::OpaqueWidget {};
+
+    struct Button : widget::OpaqueWidget {
+      std::string text;
+    };
+  }
+
+  using ui::Menu;
+  using ui::MenuItem;
+  using ui::MenuLabel;
+  using ui::MenuSeparator;
+  using ui::MenuEntry;
+  using ui::TextField;
+  using ui::Label;
+  using ui::Tooltip;
+
+  namespace app {
+
+    struct ModuleWidget;
+
+    struct CircularShadow : widget::TransparentWidget {
+      float blurRadius = 0.f;
+      float opacity = 0.15f;
+    };
+
+    struct ParamWidget : widget::OpaqueWidget {
+      engine::Module *module = NULL;
+      int paramId = -1;
+      engine::ParamQuantity *getParamQuantity() {
+        return module ? module->paramQuantities[paramId] : NULL;
+      }
+      void createTooltip() {}
+      void destroyTooltip() {}
+      virtual void createContextMenu() {}
+      virtual void appendContextMenu(ui::Menu *menu) {}
+      void resetAction() {}
+      virtual void initParamQuantity() {}
+    };
+
+    struct Knob : ParamWidget {
+      bool horizontal = false;
+      bool smooth = true;
+      bool snap = false;
+      float speed = 1.f;
+      bool forceLinear = false;
+      float minAngle = -M_PI;
+      float maxAngle = M_PI;
+    };
+
+    struct SliderKnob : Knob {};
+
+    struct SvgKnob : Knob {
+      widget::FramebufferWidget *fb = NULL;
+      CircularShadow *shadow = NULL;
+      widget::TransformWidget *tw = NULL;
+      widget::SvgWidget *sw = NULL;
+      SvgKnob();
+      void setSvg(std::shared_ptr<window::Svg> svg) { sw->setSvg(svg); }
+    };
+
+    struct SvgSlider : SliderKnob {
+      widget::FramebufferWidget *fb = NULL;
+      widget::SvgWidget *background = NULL;
+      widget::SvgWidget *handle = NULL;
+      math::Vec minHandlePos, maxHandlePos;
+      SvgSlider();
+      void setBackgroundSvg(std::shared_ptr<window::Svg> svg) { background->setSvg(svg); }
+      void setHandleSvg(std::shared_ptr<window::Svg> svg) { handle->setSvg(svg); }
+      void setHandlePos(math::Vec minHandlePos, math::Vec maxHandlePos) {
+        this->minHandlePos = minHandlePos;
+        this->maxHandlePos = maxHandlePos;
+      }
+      void setHandlePosCentered(math::Vec minHandlePosCentered, math::Vec maxHandlePosCentered) {}
+    };
+
+    struct Switch : ParamWidget {
+      bool momentary = false;
+    };
+
+    struct SvgSwitch : Switch {
+      widget::FramebufferWidget *fb = NULL;
+      CircularShadow *shadow = NULL;
+      widget::SvgWidget *sw = NULL;
+      std::vector<std::shared_ptr<window::Svg>> frames;
+      bool latch = false;
+      SvgSwitch();
+      void addFrame(std::shared_ptr<window::Svg> svg) { frames.push_back(svg); }
+    };
+
+    struct SvgButton : widget::OpaqueWidget {
+      widget::FramebufferWidget *fb = NULL;
+      widget::SvgWidget *sw = NULL;
+      std::vector<std::shared_ptr<window::Svg>> frames;
+      void addFrame(std::shared_ptr<window::Svg> svg) { frames.push_back(svg); }
+    };
+
+    struct PortWidget : widget::OpaqueWidget {
+      engine::Module *module = NULL;
+      int type = 0;
+      int portId = -1;
+      engine::Port *getPort() { return NULL; }
+    };
+
+    struct SvgPort : PortWidget {
+      widget::FramebufferWidget *fb = NULL;
+      CircularShadow *shadow = NULL;
+      widget::SvgWidget *sw = NULL;
+      void setSvg(std::shared_ptr<window::Svg> svg) {}
+    };
+
+    struct LightWidget : widget::TransparentWidget {
+      NVGcolor bgColor = nvgRGBA(0, 0, 0, 0);
+      NVGcolor color = nvgRGBA(0, 0, 0, 0);
+      NVGcolor borderColor = nvgRGBA(0, 0, 0, 0);
+      virtual void drawBackground(const DrawArgs &args) {}
+      virtual void drawLight(const DrawArgs &args) {}
+      virtual void drawHalo(const DrawArgs &args) {}
+    };
+
+    struct MultiLightWidget : LightWidget {
+      std::vector<NVGcolor> baseColors;
+      int getNumColors() { return baseColors.size(); }
+      void addBaseColor(NVGcolor baseColor) { baseColors.push_back(baseColor); }
+      void setBrightnesses(const std::vector<float> &brightnesses) {}
+    };
+
+    struct ModuleLightWidget : MultiLightWidget {
+      engine::Module *module = NULL;
+      int firstLightId = -1;
+      engine::Light *getLight(int colorId) { return module ? &module->lights[firstLightId + colorId] : NULL; }
+    };
+
+    struct SvgScrew : widget::Widget {
+      widget::FramebufferWidget *fb = NULL;
+      widget::SvgWidget *sw = NULL;
+      void setSvg(std::shared_ptr<window::Svg> svg) {}
+    };
+
+    struct SvgPanel : widget::Widget {
+      widget::FramebufferWidget *fb = NULL;
+      widget::SvgWidget *sw = NULL;
+      std::shared_ptr<window::Svg> svg;
+      void setBackground(std::shared_ptr<window::Svg> svg) { this->svg = svg; }
+    };
+
+    struct ModuleWidget : widget::OpaqueWidget {
+      plugin::Model *model = NULL;
+      engine::Module *module = NULL;
+      widget::Widget *panel = NULL;
+
+      plugin::Model *getModel() { return model; }
+      engine::Module *getModule() { return module; }
+      template <class TModule>
+      TModule *getModule() { return dynamic_cast<TModule *>(module); }
+      void setModel(plugin::Model *model) { this->model = model; }
+      void setModule(engine::Module *module) { this->module = module; }
+      widget::Widget *getPanel() { return panel; }
+      void setPanel(widget::Widget *panel);
+      void setPanel(std::shared_ptr<window::Svg> svg);
+      void addParam(ParamWidget *param) { addChild(param); }
+      void addInput(PortWidget *input) { addChild(input); }
+      void addOutput(PortWidget *output) { addChild(output); }
+      std::vector<ParamWidget *> getParams() { return {}; }
+      std::vector<PortWidget *> getPorts() { return {}; }
+      virtual void appendContextMenu(ui::Menu *menu) {}
+      void createContextMenu() {}
+      json_t *toJson() { return NULL; }
+      void fromJson(json_t *rootJ) {}
+      void cloneAction(bool cloneCables = true) {}
+      void removeAction() {}
+    };
+
+    struct RackWidget : widget::OpaqueWidget {
+      math::Vec getMousePos() { return math::Vec(); }
+      void addModule(ModuleWidget *mw) {}
+      void addModuleAtMouse(ModuleWidget *mw) {}
+      void setModulePosNearest(ModuleWidget *mw, math::Vec pos) {}
+      bool requestModulePos(ModuleWidget *mw, math::Vec pos) { return true; }
+      ModuleWidget *getModule(int64_t moduleId) { return NULL; }
+    };
+
+    struct RackScrollWidget : ui::ScrollWidget {
+      math::Vec offset;
+      widget::ZoomWidget *zoomWidget = NULL;
+      math::Vec getGridOffset() { return math::Vec(); }
+      void setGridOffset(math::Vec) {}
+      float getZoom() { return 1.f; }
+      void setZoom(float) {}
+    };
+
+    struct LedDisplay : widget::Widget {};
+
+    struct LedDisplayTextField : ui::TextField {
+      std::shared_ptr<window::Font> font;
+      math::Vec textOffset;
+      NVGcolor color;
+      NVGcolor bgColor;
+    };
+
+    struct Scene : widget::OpaqueWidget {
+      RackWidget *rack = NULL;
+      RackScrollWidget *rackScroll = NULL;
+      math::Vec getMousePos() { return math::Vec(); }
+    };
+
+  }
+
+  using app::ParamWidget;
+  using app::Knob;
+  using app::SvgKnob;
+  using app::SvgSlider;
+  using app::SvgSwitch;
+  using app::SvgButton;
+  using app::SvgPort;
+  using app::SvgScrew;
+  using app::SvgPanel;
+  using app::PortWidget;
+  using app::LightWidget;
+  using app::MultiLightWidget;
+  using app::ModuleLightWidget;
+  using app::ModuleWidget;
+
+  namespace history {
+    struct Action {
+      std::string name;
+      virtual ~Action() {}
+      virtual void undo() {}
+      virtual void redo() {}
+    };
+    struct ModuleAction : Action {
+      int64_t moduleId = -1;
+    };
+    struct ModuleAdd : ModuleAction {
+      void setModule(app::ModuleWidget *mw) {}
+    };
+    struct ModuleChange : ModuleAction {
+      json_t *oldModuleJ = NULL;
+      json_t *newModuleJ = NULL;
+    };
+    struct ParamChange : ModuleAction {
+      int paramId = -1;
+      float oldValue = 0.f;
+      float newValue = 0.f;
+    };
+    struct ComplexAction : Action {
+      std::vector<Action *> actions;
+      void push(Action *action) { actions.push_back(action); }
+      bool isEmpty() { return actions.empty(); }
+    };
+    struct State {
+      void push(Action *action) { delete action; }
+    };
+  }
+
+  namespace plugin {
+    struct Model {
+      plugin::Plugin *plugin = NULL;
+      std::string slug;
+      std::string name;
+      virtual ~Model() {}
+      virtual engine::Module *createModule() { return NULL; }
+      virtual app::ModuleWidget *createModuleWidget(engine::Module *m) { return NULL; }
+    };
+  }
+
+  struct Context {
+    window::Window *window = NULL;
+    app::Scene *scene = NULL;
+    engine::Engine *engine = NULL;
+    history::State *history = NULL;
+  };
+
+  Context *contextGet();
+#define APP rack::contextGet()
+
+  namespace componentlibrary {
+
+    static const NVGcolor SCHEME_BLACK = nvgRGB(0x00, 0x00, 0x00);
+    static const NVGcolor SCHEME_WHITE = nvgRGB(0xff, 0xff, 0xff);
+    static const NVGcolor SCHEME_RED = nvgRGB(0xed, 0x2c, 0x24);
+    static const NVGcolor SCHEME_ORANGE = nvgRGB(0xf2, 0xb1, 0x20);
+    static const NVGcolor SCHEME_YELLOW = nvgRGB(0xf9, 0xdf, 0x1c);
+    static const NVGcolor SCHEME_GREEN = nvgRGB(0x90, 0xc7, 0x3e);
+    static const NVGcolor SCHEME_CYAN = nvgRGB(0x22, 0xe6, 0xef);
+    static const NVGcolor SCHEME_BLUE = nvgRGB(0x29, 0xb2, 0xef);
+    static const NVGcolor SCHEME_PURPLE = nvgRGB(0xd5, 0x2b, 0xed);
+
+    template <typename TBase = app::ModuleLightWidget>
+    struct TSvgLight : TBase {
+      widget::FramebufferWidget *fb = NULL;
+      widget::SvgWidget *sw = NULL;
+      void setSvg(std::shared_ptr<window::Svg> svg) {}
+    };
+    typedef TSvgLight<> SvgLight;
+
+    template <typename TBase = app::ModuleLightWidget>
+    struct TGrayModuleLightWidget : TBase {};
+    typedef TGrayModuleLightWidget<> GrayModuleLightWidget;
+
+    template <typename TBase = GrayModuleLightWidget>
+    struct TWhiteLight : TBase {};
+    typedef TWhiteLight<> WhiteLight;
+    template <typename TBase = GrayModuleLightWidget>
+    struct TRedLight : TBase {};
+    typedef TRedLight<> RedLight;
+    template <typename TBase = GrayModuleLightWidget>
+    struct TGreenLight : TBase {};
+    typedef TGreenLight<> GreenLight;
+    template <typename TBase = GrayModuleLightWidget>
+    struct TBlueLight : TBase {};
+    typedef TBlueLight<> BlueLight;
+    template <typename TBase = GrayModuleLightWidget>
+    struct TYellowLight : TBase {};
+    typedef TYellowLight<> YellowLight;
+    template <typename TBase = GrayModuleLightWidget>
+    struct TOrangeLight : TBase {};
+    typedef TOrangeLight<> OrangeLight;
+    template <typename TBase = GrayModuleLightWidget>
+    struct TPurpleLight : TBase {};
+    typedef TPurpleLight<> PurpleLight;
+    template <typename TBase = GrayModuleLightWidget>
+    struct TGreenRedLight : TBase {};
+    typedef TGreenRedLight<> GreenRedLight;
+    template <typename TBase = GrayModuleLightWidget>
+    struct TRedGreenBlueLight : TBase {};
+    typedef TRedGreenBlueLight<> RedGreenBlueLight;
+
+    template <typename TBase>
+    struct LargeLight : TSvgLight<TBase> {};
+    template <typename TBase>
+    struct MediumLight : TSvgLight<TBase> {};
+    template <typename TBase>
+    struct SmallLight : TSvgLight<TBase> {};
+    template <typename TBase>
+    struct TinyLight : TSvgLight<TBase> {};
+    template <typename TBase>
+    struct LargeSimpleLight : TBase {};
+    template <typename TBase>
+    struct MediumSimpleLight : TBase {};
+    template <typename TBase>
+    struct SmallSimpleLight : TBase {};
+    template <typename TBase>
+    struct TinySimpleLight : TBase {};
+    template <typename TBase>
+    struct RectangleLight : TBase {};
+    template <typename TBase>
+    struct VCVBezelLight : TBase {};
+    template <typename TBase>
+    struct PB61303Light : TBase {};
+
+    struct RoundKnob : app::SvgKnob {
+      widget::SvgWidget *bg = NULL;
+      RoundKnob();
+    };
+    struct RoundBlackKnob : RoundKnob {};
+    struct RoundSmallBlackKnob : RoundKnob {};
+    struct RoundLargeBlackKnob : RoundKnob {};
+    struct RoundHugeBlackKnob : RoundKnob {};
+    struct RoundBlackSnapKnob : RoundBlackKnob {};
+    struct Trimpot : app::SvgKnob {
+      widget::SvgWidget *bg = NULL;
+      Trimpot();
+    };
+    struct Rogan : app::SvgKnob {
+      widget::SvgWidget *bg = NULL;
+      widget::SvgWidget *fg = NULL;
+    };
+
+    struct PJ301MPort : app::SvgPort {};
+    struct PJ3410Port : app::SvgPort {};
+    struct CL1362Port : app::SvgPort {};
+    struct DarkPJ301MPort : app::SvgPort {};
+
+    struct ScrewSilver : app::SvgScrew {};
+    struct ScrewBlack : app::SvgScrew {};
+
+    struct CKSS : app::SvgSwitch {};
+    struct CKSSThree : app::SvgSwitch {};
+    struct CKSSThreeHorizontal : app::SvgSwitch {};
+    struct CKD6 : app::SvgSwitch {};
+    struct TL1105 : app::SvgSwitch {};
+    struct LEDButton : app::SvgSwitch {};
+    struct VCVButton : app::SvgSwitch {};
+    struct VCVLatch : VCVButton {};
+    struct BefacoPush : app::SvgSwitch {};
+    struct LEDBezel : app::SvgSwitch {};
+    struct VCVBezel : app::SvgSwitch {};
+    struct VCVBezelLatch : VCVBezel {};
+
+    template <typename TLight>
+    struct LEDLightBezel : LEDBezel {
+      app::ModuleLightWidget *light = NULL;
+      app::ModuleLightWidget *getLight() { return light; }
+    };
+    template <typename TLight>
+    struct VCVLightBezel : VCVBezel {
+      app::ModuleLightWidget *light = NULL;
+      app::ModuleLightWidget *getLight() { return light; }
+    };
+    template <typename TLight>
+    struct VCVLightBezelLatch : VCVBezelLatch {
+      app::ModuleLightWidget *light = NULL;
+      app::ModuleLightWidget *getLight() { return light; }
+    };
+    template <typename TLight>
+    struct LEDLightSlider : app::SvgSlider {
+      app::ModuleLightWidget *light = NULL;
+    };
+    template <typename TBase>
+    struct VCVLightSlider : app::SvgSlider {};
+    struct VCVSlider : app::SvgSlider {};
+    typedef LEDLightSlider<GreenLight> LEDSliderGreen;
+    typedef LEDLightSlider<RedLight> LEDSliderRed;
+    typedef LEDLightSlider<YellowLight> LEDSliderYellow;
+    typedef LEDLightSlider<BlueLight> LEDSliderBlue;
+    typedef LEDLightSlider<WhiteLight> LEDSliderWhite;
+
+  }
+
+  using namespace componentlibrary;
+
+  // helpers.hpp
+  template <typename T>
+  void constructAssign(T *o) {}
+
+  template <typename T, typename F, typename V, typename... Args>
+  void constructAssign(T *o, F f, V v, Args... args) {
+    o->*f = v;
+    constructAssign(o, args...);
+  }
+
+  template <class T, typename... Args>
+  T *construct(Args... args) {
+    T *o = new T;
+    constructAssign(o, args...);
+    return o;
+  }
+
+  template <class TModule, class TModuleWidget>
+  plugin::Model *createModel(std::string slug) {
+    struct TModel : plugin::Model {
+      engine::Module *createModule() override {
+        engine::Module *m = new TModule;
+        m->model = this;
+        return m;
+      }
+    };
+    plugin::Model *o = new TModel;
+    o->slug = slug;
+    return o;
+  }
+
+  template <typename TWidget>
+  TWidget *createWidget(math::Vec pos) {
+    TWidget *o = new TWidget;
+    o->box.pos = pos;
+    return o;
+  }
+
+  template <typename TWidget>
+  TWidget *createWidgetCentered(math::Vec pos) {
+    TWidget *o = createWidget<TWidget>(pos);
+    o->box.pos = o->box.pos.minus(o->box.size.div(2));
+    return o;
+  }
+
+  inline app::SvgPanel *createPanel(std::string svgPath) {
+    app::SvgPanel *panel = new app::SvgPanel;
+    panel->setBackground(window::Svg::load(svgPath));
+    return panel;
+  }
+
+  template <class TParamWidget>
+  TParamWidget *createParam(math::Vec pos, engine::Module *module, int paramId) {
+    TParamWidget *o = new TParamWidget;
+    o->box.pos = pos;
+    o->app::ParamWidget::module = module;
+    o->app::ParamWidget::paramId = paramId;
+    return o;
+  }
+
+  template <class TParamWidget>
+  TParamWidget *createParamCentered(math::Vec pos, engine::Module *module, int paramId) {
+    return createParam<TParamWidget>(pos, module, paramId);
+  }
+
+  template <class TPortWidget>
+  TPortWidget *createInput(math::Vec pos, engine::Module *module, int inputId) {
+    TPortWidget *o = new TPortWidget;
+    o->box.pos = pos;
+    o->app::PortWidget::module = module;
+    o->app::PortWidget::type = 0;
+    o->app::PortWidget::portId = inputId;
+    return o;
+  }
+
+  template <class TPortWidget>
+  TPortWidget *createInputCentered(math::Vec pos, engine::Module *module, int inputId) {
+    return createInput<TPortWidget>(pos, module, inputId);
+  }
+
+  template <class TPortWidget>
+  TPortWidget *createOutput(math::Vec pos, engine::Module *module, int outputId) {
+    TPortWidget *o = new TPortWidget;
+    o->box.pos = pos;
+    o->app::PortWidget::module = module;
+    o->app::PortWidget::type = 1;
+    o->app::PortWidget::portId = outputId;
+    return o;
+  }
+
+  template <class TPortWidget>
+  TPortWidget *createOutputCentered(math::Vec pos, engine::Module *module, int outputId) {
+    return createOutput<TPortWidget>(pos, module, outputId);
+  }
+
+  template <class TModuleLightWidget>
+  TModuleLightWidget *createLight(math::Vec pos, engine::Module *module, int firstLightId) {
+    TModuleLightWidget *o = new TModuleLightWidget;
+    o->box.pos = pos;
+    o->module = module;
+    o->firstLightId = firstLightId;
+    return o;
+  }
+
+  template <class TModuleLightWidget>
+  TModuleLightWidget *createLightCentered(math::Vec pos, engine::Module *module, int firstLightId) {
+    return createLight<TModuleLightWidget>(pos, module, firstLightId);
+  }
+
+  template <class TParamWidget>
+  TParamWidget *createLightParam(math::Vec pos, engine::Module *module, int paramId, int firstLightId) {
+    TParamWidget *o = createParam<TParamWidget>(pos, module, paramId);
+    o->getLight()->module = module;
+    o->getLight()->firstLightId = firstLightId;
+    return o;
+  }
+
+  template <class TParamWidget>
+  TParamWidget *createLightParamCentered(math::Vec pos, engine::Module *module, int paramId, int firstLightId) {
+    return createLightParam<TParamWidget>(pos, module, paramId, firstLightId);
+  }
+
+  template <class TMenu = ui::Menu>
+  TMenu *createMenu() {
+    return new TMenu;
+  }
+
+  template <class TMenuLabel = ui::MenuLabel>
+  TMenuLabel *createMenuLabel(std::string text) {
+    TMenuLabel *o = new TMenuLabel;
+    o->text = text;
+    return o;
+  }
+
+  template <class TMenuItem = ui::MenuItem>
+  TMenuItem *createMenuItem(std::string text, std::string rightText = "") {
+    TMenuItem *o = new TMenuItem;
+    o->text = text;
+    o->rightText = rightText;
+    return o;
+  }
+
+  template <class TMenuItem = ui::MenuItem>
+  TMenuItem *createMenuItem(std::string text, std::string rightText, std::function<void()> action, bool disabled = false, bool alwaysConsume = false) {
+    TMenuItem *o = createMenuItem<TMenuItem>(text, rightText);
+    o->disabled = disabled;
+    return o;
+  }
+
+  template <class TMenuItem = ui::MenuItem>
+  TMenuItem *createCheckMenuItem(std::string text, std::string rightText, std::function<bool()> checked, std::function<void()> action, bool disabled = false, bool alwaysConsume = false) {
+    return createMenuItem<TMenuItem>(text, rightText);
+  }
+
+  template <class TMenuItem = ui::MenuItem>
+  ui::MenuItem *createBoolMenuItem(std::string text, std::string rightText, std::function<bool()> getter, std::function<void(bool state)> setter, bool disabled = false, bool alwaysConsume = false) {
+    return createMenuItem<TMenuItem>(text, rightText);
+  }
+
+  template <typename T>
+  ui::MenuItem *createBoolPtrMenuItem(std::string text, std::string rightText, T *ptr) {
+    return createMenuItem(text, rightText);
+  }
+
+  template <class TMenuItem = ui::MenuItem>
+  ui::MenuItem *createSubmenuItem(std::string text, std::string rightText, std::function<void(ui::Menu *menu)> createMenu, bool disabled = false) {
+    return createMenuItem<TMenuItem>(text, rightText);
+  }
+
+  template <class TMenuItem = ui::MenuItem>
+  ui::MenuItem *createIndexSubmenuItem(std::string text, std::vector<std::string> labels, std::function<size_t()> getter, std::function<void(size_t val)> setter, bool disabled = false, bool alwaysConsume = false) {
+    return createMenuItem<TMenuItem>(text, "");
+  }
+
+  template <typename T>
+  ui::MenuItem *createIndexPtrSubmenuItem(std::string text, std::vector<std::string> labels, T *ptr) {
+    return createMenuItem(text, "");
+  }
+
+  using namespace math;
+  using namespace engine;
+  using namespace widget;
+  using namespace ui;
+  using namespace app;
+  using namespace plugin;
+
+}